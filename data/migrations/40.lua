@@ -0,0 +1,14 @@
+function onUpdateDatabase()
+	print("> Updating database to version 40 (player item blobs)")
+	db.query([[
+		CREATE TABLE IF NOT EXISTS `player_itemblobs` (
+		  `player_id` int NOT NULL,
+		  `section` tinyint unsigned NOT NULL,
+		  `items` int unsigned NOT NULL DEFAULT '0',
+		  `data` mediumblob NOT NULL,
+		  PRIMARY KEY (`player_id`, `section`),
+		  FOREIGN KEY (`player_id`) REFERENCES `players`(`id`) ON DELETE CASCADE
+		) ENGINE=InnoDB DEFAULT CHARACTER SET=utf8;
+	]])
+	return true
+end
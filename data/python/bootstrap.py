@@ -1,3 +1,5 @@
+import traceback
+
 print("[Python] bootstrap loaded")
 
 
@@ -23,3 +25,45 @@ def on_creature_death(killer: str, victim: str):
 
 def some_func(*args):
     print("[Python] some_func args:", args)
+
+
+_HANDLERS = {
+    "on_server_start": on_server_start,
+    "on_server_stop": on_server_stop,
+    "on_player_login": on_player_login,
+    "on_player_logout": on_player_logout,
+    "on_creature_death": on_creature_death,
+}
+
+
+def on_events(events):
+    # Called once per drain of the engine's event queue with an iterator over
+    # (handler_name, args) tuples, in the order they were raised. One failing
+    # handler must not cost the rest of the batch, so errors are caught per event.
+    for name, args in events:
+        handler = _HANDLERS.get(name)
+        if handler is None:
+            continue
+        try:
+            handler(*args)
+        except Exception:
+            traceback.print_exc()
+
+
+def world_summary():
+    # Reads the latest columnar world snapshot without copying: every column is
+    # a typed memoryview over the server's buffer, valid while `snap` is alive.
+    import nexus
+
+    snap = nexus.world_snapshot()
+    if snap is None:
+        return None
+
+    cols = snap.columns
+    levels = cols["player_level"]
+    return {
+        "sequence": snap.sequence,
+        "players": snap.players,
+        "monsters": snap.monsters,
+        "avg_level": (sum(levels) / len(levels)) if len(levels) else 0,
+    }
@@ -45,6 +45,7 @@ function onSay(player, words, param)
 		"VALUES (%s, %s, %d, %d, %d)",
 		db.escapeString(targetIp), db.escapeString(ipBanReason), currentTime, expirationTime, player:getGuid()
 	))
+	Game.clearBanCache()
 
 	player:sendTextMessage(MESSAGE_EVENT_ADVANCE, string.format("%s has been IP banned for %d days.", targetName, ipBanDuration))
 
@@ -5,24 +5,53 @@
 
 #include "ban.h"
 
+#include "configmanager.h"
 #include "connection.h"
 #include "database.h"
 #include "databasetasks.h"
 
+namespace {
+
+	constexpr size_t BAN_CACHE_SIZE = 8192;
+
+	// "not banned" is cached as well; it is by far the most common answer
+	LRUCache<uint32_t, std::optional<IOBan::BanInfo>> accountBanCache{BAN_CACHE_SIZE};
+	LRUCache<std::string, std::optional<IOBan::BanInfo>> ipBanCache{BAN_CACHE_SIZE};
+	LRUCache<uint32_t, bool> namelockCache{BAN_CACHE_SIZE};
+
+	template <typename Key, typename Value>
+	void cacheBan(LRUCache<Key, Value>& cache, const Key& key, Value value) {
+		const int64_t ttl = getNumber(ConfigManager::BAN_CACHE_TTL);
+		if (ttl > 0) {
+			cache.put(key, std::move(value), std::chrono::seconds(ttl));
+		}
+	}
+
+	bool isExpired(const std::optional<IOBan::BanInfo>& banInfo) {
+		return banInfo && banInfo->expiresAt != 0 && time(nullptr) > banInfo->expiresAt;
+	}
+
+} // namespace
+
 namespace IOBan {
-	const std::optional<BanInfo> getAccountBanInfo(uint32_t accountId) {
-		Database& db = Database::getInstance();
+	const std::optional<BanInfo> getAccountBanInfo(uint32_t accountId, Database& db) {
+		// a cached ban that ran out is looked up again, so it gets moved to the history
+		if (auto banInfo = accountBanCache.get(accountId); banInfo && !isExpired(*banInfo)) {
+			return *banInfo;
+		}
 
 		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `reason`, `expires_at`, `banned_at`, `banned_by`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `account_bans` WHERE `account_id` = {:d}", accountId));
 		if (!result) {
+			cacheBan(accountBanCache, accountId, std::optional<BanInfo>{});
 			return std::nullopt;
 		}
 
 		int64_t expiresAt = result->getNumber<int64_t>("expires_at");
 		if (expiresAt != 0 && time(nullptr) > expiresAt) {
 			// Move the ban to history if it has expired
-			g_databaseTasks.addTask(fmt::format("INSERT INTO `account_ban_history` (`account_id`, `reason`, `banned_at`, `expired_at`, `banned_by`) VALUES ({:d}, {:s}, {:d}, {:d}, {:d})", accountId, db.escapeString(result->getString("reason")), result->getNumber<time_t>("banned_at"), expiresAt, result->getNumber<uint32_t>("banned_by")));
-			g_databaseTasks.addTask(fmt::format("DELETE FROM `account_bans` WHERE `account_id` = {:d}", accountId));
+			g_databaseTasks.addTask(fmt::format("INSERT INTO `account_ban_history` (`account_id`, `reason`, `banned_at`, `expired_at`, `banned_by`) VALUES ({:d}, {:s}, {:d}, {:d}, {:d})", accountId, db.escapeString(result->getString("reason")), result->getNumber<time_t>("banned_at"), expiresAt, result->getNumber<uint32_t>("banned_by")), nullptr, false, DatabaseTasks::makeOrderKey(DatabaseOrder::ACCOUNT, accountId));
+			g_databaseTasks.addTask(fmt::format("DELETE FROM `account_bans` WHERE `account_id` = {:d}", accountId), nullptr, false, DatabaseTasks::makeOrderKey(DatabaseOrder::ACCOUNT, accountId));
+			cacheBan(accountBanCache, accountId, std::optional<BanInfo>{});
 			return std::nullopt;
 		}
 
@@ -35,6 +64,7 @@ namespace IOBan {
 		}
 	 
 		banInfo->bannedBy = result->getString("name");
+		cacheBan(accountBanCache, accountId, banInfo);
 		return banInfo;
 	}
 
@@ -43,16 +73,23 @@ namespace IOBan {
 			return std::nullopt;
 		}
 
+		const std::string ip = clientIP.to_string();
+		if (auto banInfo = ipBanCache.get(ip); banInfo && !isExpired(*banInfo)) {
+			return *banInfo;
+		}
+
 		Database& db = Database::getInstance();
 
-		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `reason`, `expires_at`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `ip_bans` WHERE `ip` = INET6_ATON('{:s}')", clientIP.to_string()));
+		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `reason`, `expires_at`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `ip_bans` WHERE `ip` = INET6_ATON('{:s}')", ip));
 		if (!result) {
+			cacheBan(ipBanCache, ip, std::optional<BanInfo>{});
 			return std::nullopt;
 		}
 
 		int64_t expiresAt = result->getNumber<int64_t>("expires_at");
 		if (expiresAt != 0 && time(nullptr) > expiresAt) {
-			g_databaseTasks.addTask(fmt::format("DELETE FROM `ip_bans` WHERE `ip` = INET6_ATON('{:s}')", clientIP.to_string()));
+			g_databaseTasks.addTask(fmt::format("DELETE FROM `ip_bans` WHERE `ip` = INET6_ATON('{:s}')", ip));
+			cacheBan(ipBanCache, ip, std::optional<BanInfo>{});
 			return std::nullopt;
 		}
 
@@ -65,11 +102,32 @@ namespace IOBan {
 		}
 	 
 		banInfo->bannedBy = result->getString("name");
+		cacheBan(ipBanCache, ip, banInfo);
 		return banInfo;
 	}
 
-	bool isPlayerNamelocked(uint32_t playerId) {
-		return Database::getInstance().storeQuery(fmt::format("SELECT 1 FROM `player_namelocks` WHERE `player_id` = {:d}", playerId)).get();
+	bool isPlayerNamelocked(uint32_t playerId, Database& db) {
+		if (auto namelocked = namelockCache.get(playerId)) {
+			return *namelocked;
+		}
+
+		const bool namelocked = db.storeQuery(fmt::format("SELECT 1 FROM `player_namelocks` WHERE `player_id` = {:d}", playerId)).get();
+		cacheBan(namelockCache, playerId, namelocked);
+		return namelocked;
+	}
+
+	void clearCache() {
+		accountBanCache.clear();
+		ipBanCache.clear();
+		namelockCache.clear();
+	}
+
+	LRUCacheStatsList getCacheStats() {
+		return {
+			{"accountBans", accountBanCache.getStats()},
+			{"ipBans", ipBanCache.getStats()},
+			{"namelocks", namelockCache.getStats()},
+		};
 	}
 
 } // namespace IOBan
\ No newline at end of file
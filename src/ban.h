@@ -5,6 +5,8 @@
 #define FS_BAN_H
 
 #include "connection.h"
+#include "database.h"
+#include "lrucache.h"
 
 namespace IOBan {
 
@@ -14,9 +16,13 @@ namespace IOBan {
 		time_t expiresAt;
 	};
 
-	const std::optional<BanInfo> getAccountBanInfo(uint32_t accountId);
+	const std::optional<BanInfo> getAccountBanInfo(uint32_t accountId, Database& db = Database::getInstance());
 	const std::optional<BanInfo> getIpBanInfo(const Connection::Address& clientIP);
-	bool isPlayerNamelocked(uint32_t playerId);
+	bool isPlayerNamelocked(uint32_t playerId, Database& db = Database::getInstance());
+
+	// Lookups are cached for banCacheTTL seconds; call after writing ban tables.
+	void clearCache();
+	LRUCacheStatsList getCacheStats();
 
 }; // namespace IOBan
 
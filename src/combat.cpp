@@ -16,49 +16,109 @@
 extern Game g_game;
 extern Weapons* g_weapons;
 
-std::vector<Tile*> getList(const MatrixArea& area, const Position& targetPos, const Direction dir) {
+namespace {
+
+// reused by every cast; a cast started from inside another one (a death or
+// target callback) finds the buffer taken and uses its own
+thread_local std::vector<Tile*> tileBuffer;
+thread_local std::vector<Creature*> creatureBuffer;
+
+template <typename T>
+std::vector<T*> takeBuffer(std::vector<T*>& buffer) {
+	std::vector<T*> vec = std::move(buffer);
+	vec.clear();
+	return vec;
+}
+
+template <typename T>
+void returnBuffer(std::vector<T*>& buffer, std::vector<T*>&& vec) {
+	if (vec.capacity() > buffer.capacity()) {
+		buffer = std::move(vec);
+	}
+}
+
+Tile* getOrCreateTile(const Position& pos) {
+	Tile* tile = g_game.map.getTile(pos);
+	if (!tile) {
+		tile = new StaticTile(pos.x, pos.y, pos.z);
+		g_game.map.setTile(pos, tile);
+	}
+	return tile;
+}
+
+void getList(std::vector<Tile*>& vec, const AreaOffsets& area, const Position& targetPos, const Direction dir) {
 	auto casterPos = getNextPosition(dir, targetPos);
 
-	std::vector<Tile*> vec;
+	// neighbouring cells mostly share a quadtree leaf, so look the leaf up
+	// once per FLOOR_SIZE x FLOOR_SIZE block instead of once per tile
+	const Floor* floor = nullptr;
+	int32_t floorX = -1;
+	int32_t floorY = -1;
 
-	auto center = area.getCenter();
+	for (const AreaOffset& offset : area.offsets) {
+		const int32_t x = targetPos.x + offset.x;
+		const int32_t y = targetPos.y + offset.y;
+		if (x < 0 || y < 0 || x > std::numeric_limits<uint16_t>::max() || y > std::numeric_limits<uint16_t>::max()) {
+			continue;
+		}
 
-	Position tmpPos(targetPos.x - center.first, targetPos.y - center.second, targetPos.z);
-	for (uint32_t row = 0; row < area.getRows(); ++row, ++tmpPos.y) {
-		for (uint32_t col = 0; col < area.getCols(); ++col, ++tmpPos.x) {
-			if (area(row, col)) {
-				if (g_game.isSightClear(casterPos, tmpPos, true)) {
-					Tile* tile = g_game.map.getTile(tmpPos);
-					if (!tile) {
-						tile = new StaticTile(tmpPos.x, tmpPos.y, tmpPos.z);
-						g_game.map.setTile(tmpPos, tile);
-					}
-					vec.push_back(tile);
-				}
-			}
+		Position tmpPos(x, y, targetPos.z);
+		if (!g_game.isSightClear(casterPos, tmpPos, true)) {
+			continue;
+		}
+
+		if ((x & ~FLOOR_MASK) != floorX || (y & ~FLOOR_MASK) != floorY) {
+			floorX = x & ~FLOOR_MASK;
+			floorY = y & ~FLOOR_MASK;
+			const QTreeLeafNode* leaf = g_game.map.getQTNode(x, y);
+			floor = leaf ? leaf->getFloor(targetPos.z) : nullptr;
 		}
-		tmpPos.x -= area.getCols();
+
+		Tile* tile = floor ? floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK] : nullptr;
+		if (!tile) {
+			tile = getOrCreateTile(tmpPos);
+			// creating the tile may have created its floor or leaf too
+			floorX = -1;
+		}
+		vec.push_back(tile);
 	}
-	return vec;
 }
 
-std::vector<Tile*> getCombatArea(const Position& centerPos, const Position& targetPos, const AreaCombat* area) {
+// fills tiles and returns the largest distance from targetPos they may reach
+std::pair<int32_t, int32_t> getCombatArea(std::vector<Tile*>& tiles, const Position& centerPos, const Position& targetPos, const AreaCombat* area) {
 	if (targetPos.z >= MAP_MAX_LAYERS) {
 		return {};
 	}
 
 	if (area) {
-		return getList(area->getArea(centerPos, targetPos), targetPos, getDirectionTo(targetPos, centerPos));
+		const AreaOffsets& offsets = area->getArea(centerPos, targetPos);
+		getList(tiles, offsets, targetPos, getDirectionTo(targetPos, centerPos));
+		return {offsets.maxX, offsets.maxY};
 	}
 
-	Tile* tile = g_game.map.getTile(targetPos);
-	if (!tile) {
-		tile = new StaticTile(targetPos.x, targetPos.y, targetPos.z);
-		g_game.map.setTile(targetPos, tile);
+	tiles.push_back(getOrCreateTile(targetPos));
+	return {};
+}
+
+AreaOffsets compileArea(const MatrixArea& area) {
+	AreaOffsets compiled;
+
+	auto center = area.getCenter();
+	for (uint32_t row = 0; row < area.getRows(); ++row) {
+		for (uint32_t col = 0; col < area.getCols(); ++col) {
+			if (area(row, col)) {
+				AreaOffset offset{static_cast<int16_t>(static_cast<int32_t>(col) - static_cast<int32_t>(center.first)), static_cast<int16_t>(static_cast<int32_t>(row) - static_cast<int32_t>(center.second))};
+				compiled.offsets.push_back(offset);
+				compiled.maxX = std::max<int32_t>(compiled.maxX, std::abs(offset.x));
+				compiled.maxY = std::max<int32_t>(compiled.maxY, std::abs(offset.y));
+			}
+		}
 	}
-	return {tile};
+	return compiled;
 }
 
+} // namespace
+
 CombatDamage Combat::getCombatDamage(Creature* creature, Creature* target) const {
 	CombatDamage damage;
 	damage.origin = params.origin;
@@ -688,20 +748,10 @@ void Combat::doCombat(Creature* caster, const Position& position) const {
 		CombatDamage damage = getCombatDamage(caster, nullptr);
 		doAreaCombat(caster, position, area.get(), damage, params);
 	} else {
-		auto tiles = caster ? getCombatArea(caster->getPosition(), position, area.get()) : getCombatArea(position, position, area.get());
+		auto tiles = takeBuffer(tileBuffer);
+		auto [maxX, maxY] = getCombatArea(tiles, caster ? caster->getPosition() : position, position, area.get());
 
 		SpectatorVec spectators;
-		int32_t maxX = 0;
-		int32_t maxY = 0;
-
-		//calculate the max viewable range
-		for (Tile* tile : tiles) {
-			const Position& tilePos = tile->getPosition();
-
-			maxX = std::max(maxX, tilePos.getDistanceX(position));
-			maxY = std::max(maxY, tilePos.getDistanceY(position));
-		}
-
 		const int32_t rangeX = maxX + Map::maxViewportX;
 		const int32_t rangeY = maxY + Map::maxViewportY;
 		g_game.map.getSpectators(spectators, position, true, true, rangeX, rangeX, rangeY, rangeY);
@@ -758,6 +808,7 @@ void Combat::doCombat(Creature* caster, const Position& position) const {
 				}
 			}
 		}
+		returnBuffer(tileBuffer, std::move(tiles));
 	}
 }
 
@@ -857,7 +908,8 @@ void Combat::doTargetCombat(Creature* caster, Creature* target, CombatDamage& da
 }
 
 void Combat::doAreaCombat(Creature* caster, const Position& position, const AreaCombat* area, CombatDamage& damage, const CombatParams& params) {
-	auto tiles = caster ? getCombatArea(caster->getPosition(), position, area) : getCombatArea(position, position, area);
+	auto tiles = takeBuffer(tileBuffer);
+	auto [maxX, maxY] = getCombatArea(tiles, caster ? caster->getPosition() : position, position, area);
 
 	Player* casterPlayer = caster ? caster->getPlayer() : nullptr;
 	int32_t criticalPrimary = 0;
@@ -872,17 +924,6 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 		}
 	}
 
-	int32_t maxX = 0;
-	int32_t maxY = 0;
-
-	//calculate the max viewable range
-	for (Tile* tile : tiles) {
-		const Position& tilePos = tile->getPosition();
-
-		maxX = std::max(maxX, tilePos.getDistanceX(position));
-		maxY = std::max(maxY, tilePos.getDistanceY(position));
-	}
-
 	const int32_t rangeX = maxX + Map::maxViewportX;
 	const int32_t rangeY = maxY + Map::maxViewportY;
 
@@ -891,8 +932,7 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 
 	postCombatEffects(caster, position, params);
 
-	std::vector<Creature*> toDamageCreatures;
-	toDamageCreatures.reserve(100);
+	auto toDamageCreatures = takeBuffer(creatureBuffer);
 
 	for (Tile* tile : tiles) {
 		if (canDoCombat(caster, tile, params.aggressive) != RETURNVALUE_NOERROR) {
@@ -924,6 +964,7 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 			}
 		}
 	}
+	returnBuffer(tileBuffer, std::move(tiles));
 
 	CombatDamage leechCombat;
 	leechCombat.origin = ORIGIN_NONE;
@@ -1009,6 +1050,7 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 			params.targetCallback->onTargetCombat(caster, creature);
 		}
 	}
+	returnBuffer(creatureBuffer, std::move(toDamageCreatures));
 }
 
 //**********************************************************//
@@ -1169,7 +1211,7 @@ void TargetCallback::onTargetCombat(Creature* creature, Creature* target) const
 
 //**********************************************************//
 
-const MatrixArea& AreaCombat::getArea(const Position& centerPos, const Position& targetPos) const {
+const AreaOffsets& AreaCombat::getArea(const Position& centerPos, const Position& targetPos) const {
 	int32_t dx = targetPos.getOffsetX(centerPos);
 	int32_t dy = targetPos.getOffsetY(centerPos);
 
@@ -1198,7 +1240,7 @@ const MatrixArea& AreaCombat::getArea(const Position& centerPos, const Position&
 
 	if (dir >= areas.size()) {
 		// this should not happen. it means we forgot to call setupArea.
-		static MatrixArea empty;
+		static AreaOffsets empty;
 		return empty;
 	}
 	return areas[dir];
@@ -1210,10 +1252,10 @@ void AreaCombat::setupArea(const std::vector<uint32_t>& vec, uint32_t rows) {
 		areas.resize(4);
 	}
 
-	areas[DIRECTION_EAST] = area.rotate90();
-	areas[DIRECTION_SOUTH] = area.rotate180();
-	areas[DIRECTION_WEST] = area.rotate270();
-	areas[DIRECTION_NORTH] = std::move(area);
+	areas[DIRECTION_EAST] = compileArea(area.rotate90());
+	areas[DIRECTION_SOUTH] = compileArea(area.rotate180());
+	areas[DIRECTION_WEST] = compileArea(area.rotate270());
+	areas[DIRECTION_NORTH] = compileArea(area);
 }
 
 void AreaCombat::setupArea(int32_t length, int32_t spread) {
@@ -1324,10 +1366,10 @@ void AreaCombat::setupExtArea(const std::vector<uint32_t>& vec, uint32_t rows) {
 	hasExtArea = true;
 	auto area = createArea(vec, rows);
 	areas.resize(8);
-	areas[DIRECTION_NORTHEAST] = area.rotate90();
-	areas[DIRECTION_SOUTHEAST] = area.rotate180();
-	areas[DIRECTION_SOUTHWEST] = area.rotate270();
-	areas[DIRECTION_NORTHWEST] = std::move(area);
+	areas[DIRECTION_NORTHEAST] = compileArea(area.rotate90());
+	areas[DIRECTION_SOUTHEAST] = compileArea(area.rotate180());
+	areas[DIRECTION_SOUTHWEST] = compileArea(area.rotate270());
+	areas[DIRECTION_NORTHWEST] = compileArea(area);
 }
 
 //**********************************************************//
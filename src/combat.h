@@ -10,7 +10,6 @@
 #include "tools.h"
 
 class Creature;
-class MatrixArea;
 class Player;
 class SpectatorVec;
 class Tile;
@@ -61,6 +60,19 @@ struct CombatParams {
 	bool ignoreResistances = false;
 };
 
+struct AreaOffset {
+	int16_t x;
+	int16_t y;
+};
+
+// The cells of one area direction as offsets from the target position, in
+// row order, with the largest distance any of them reaches on each axis.
+struct AreaOffsets {
+	std::vector<AreaOffset> offsets;
+	int32_t maxX = 0;
+	int32_t maxY = 0;
+};
+
 class AreaCombat {
 	public:
 		void setupArea(const std::vector<uint32_t>& vec, uint32_t rows);
@@ -68,10 +80,10 @@ class AreaCombat {
 		void setupArea(int32_t radius);
 		void setupAreaRing(int32_t ring);
 		void setupExtArea(const std::vector<uint32_t>& vec, uint32_t rows);
-		const MatrixArea& getArea(const Position& centerPos, const Position& targetPos) const;
+		const AreaOffsets& getArea(const Position& centerPos, const Position& targetPos) const;
 
 	private:
-		std::vector<MatrixArea> areas;
+		std::vector<AreaOffsets> areas;
 		bool hasExtArea = false;
 };
 
@@ -183,6 +183,12 @@ bool ConfigManager::load() {
 		string[MYSQL_SOCK] = getGlobalString(L, "mysqlSock", "");
 
 		integer[SQL_PORT] = getGlobalNumber(L, "mysqlPort", 3306);
+		integer[SQL_WORKERS] = getGlobalNumber(L, "mysqlWorkers", 4);
+		integer[SQL_SLOW_QUERY_THRESHOLD] = getGlobalNumber(L, "mysqlSlowQueryThreshold", 100);
+
+		string[PLAYER_JOURNAL_FILE] = getGlobalString(L, "playerJournalFile", "player.journal");
+		integer[PLAYER_JOURNAL_SIZE] = getGlobalNumber(L, "playerJournalSize", 64);
+		integer[PLAYER_JOURNAL_SYNC_INTERVAL] = getGlobalNumber(L, "playerJournalSyncInterval", 1000);
 
 		if (integer[GAME_PORT] == 0) {
 			integer[GAME_PORT] = getGlobalNumber(L, "gameProtocolPort", 7172);
@@ -195,6 +201,7 @@ bool ConfigManager::load() {
 		integer[STATUS_PORT] = getGlobalNumber(L, "statusProtocolPort", 7171);
 
 		integer[MARKET_OFFER_DURATION] = getGlobalNumber(L, "marketOfferDuration", 30 * 24 * 60 * 60);
+		integer[MARKET_HISTORY_DURATION] = getGlobalNumber(L, "marketHistoryDuration", 90 * 24 * 60 * 60);
 	}
 
 	boolean[ALLOW_CHANGEOUTFIT] = getGlobalBoolean(L, "allowChangeOutfit", true);
@@ -237,6 +244,7 @@ bool ConfigManager::load() {
         boolean[ENABLE_REPUTATION_SYSTEM] = getGlobalBoolean(L, "enableReputationSystem", true);
         boolean[ENABLE_ECONOMY_SYSTEM] = getGlobalBoolean(L, "enableEconomySystem", true);
         boolean[PYTHON_ENABLED] = getGlobalBoolean(L, "pythonEnabled", false);
+        boolean[ITEM_BLOB_COMPRESSION] = getGlobalBoolean(L, "itemBlobCompression", true);
 
         string[DEFAULT_PRIORITY] = getGlobalString(L, "defaultPriority", "high");
 	string[SERVER_NAME] = getGlobalString(L, "serverName", "");
@@ -249,6 +257,7 @@ bool ConfigManager::load() {
 	string[PYTHON_HOME] = getGlobalString(L, "pythonHome", "");
 	string[PYTHON_MODULE_PATH] = getGlobalString(L, "pythonModulePath", "data/python");
 	string[PYTHON_ENTRY] = getGlobalString(L, "pythonEntry", "bootstrap.py");
+	string[ITEM_STORAGE] = getGlobalString(L, "itemStorage", "rows");
 
 	integer[MAX_PLAYERS] = getGlobalNumber(L, "maxPlayers");
 	integer[PZ_LOCKED] = getGlobalNumber(L, "pzLocked", 60000);
@@ -277,6 +286,10 @@ bool ConfigManager::load() {
 	integer[CHECK_EXPIRED_MARKET_OFFERS_EACH_MINUTES] = getGlobalNumber(L, "checkExpiredMarketOffersEachMinutes", 60);
 	integer[MAX_MARKET_OFFERS_AT_A_TIME_PER_PLAYER] = getGlobalNumber(L, "maxMarketOffersAtATimePerPlayer", 100);
 	integer[MAX_PACKETS_PER_SECOND] = getGlobalNumber(L, "maxPacketsPerSecond", 25);
+	integer[ACCOUNT_CACHE_TTL] = getGlobalNumber(L, "accountCacheTTL", 60);
+	integer[PLAYER_CACHE_TTL] = getGlobalNumber(L, "playerCacheTTL", 300);
+	integer[BAN_CACHE_TTL] = getGlobalNumber(L, "banCacheTTL", 30);
+	integer[PLAYER_SAVE_BATCH_SIZE] = getGlobalNumber(L, "playerSaveBatchSize", 64);
 	integer[SERVER_SAVE_NOTIFY_DURATION] = getGlobalNumber(L, "serverSaveNotifyDuration", 5);
 	integer[YELL_MINIMUM_LEVEL] = getGlobalNumber(L, "yellMinimumLevel", 2);
 	integer[MINIMUM_LEVEL_TO_SEND_PRIVATE] = getGlobalNumber(L, "minimumLevelToSendPrivate", 1);
@@ -288,6 +301,8 @@ bool ConfigManager::load() {
 	integer[STAMINA_REGEN_PREMIUM] = getGlobalNumber(L, "timeToRegenMinutePremiumStamina", 10 * 60);
 	integer[PATHFINDING_INTERVAL] = getGlobalNumber(L, "pathfindingInterval", 200);
 	integer[PATHFINDING_DELAY] = getGlobalNumber(L, "pathfindingDelay", 300);
+	integer[PYTHON_SNAPSHOT_INTERVAL] = getGlobalNumber(L, "pythonSnapshotInterval", 0);
+	integer[PYTHON_SNAPSHOT_BUDGET] = getGlobalNumber(L, "pythonSnapshotBudget", 2000);
 
 	expStages = loadXMLStages();
 	if (expStages.empty()) {
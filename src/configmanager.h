@@ -49,6 +49,7 @@ namespace ConfigManager {
                 ENABLE_REPUTATION_SYSTEM,
                 ENABLE_ECONOMY_SYSTEM,
                 PYTHON_ENABLED,
+                ITEM_BLOB_COMPRESSION,
 
                 LAST_BOOLEAN_CONFIG /* this must be the last one */
         };
@@ -75,12 +76,19 @@ namespace ConfigManager {
 		PYTHON_HOME,
 		PYTHON_MODULE_PATH,
 		PYTHON_ENTRY,
+		PLAYER_JOURNAL_FILE,
+		ITEM_STORAGE,
 
 		LAST_STRING_CONFIG /* this must be the last one */
 	};
 
 	enum integer_config_t {
 		SQL_PORT,
+		SQL_WORKERS,
+		SQL_SLOW_QUERY_THRESHOLD,
+		PLAYER_SAVE_BATCH_SIZE,
+		PLAYER_JOURNAL_SIZE,
+		PLAYER_JOURNAL_SYNC_INTERVAL,
 		MAX_PLAYERS,
 		PZ_LOCKED,
 		DEFAULT_DESPAWNRANGE,
@@ -108,10 +116,14 @@ namespace ConfigManager {
 		STATUS_PORT,
 		STAIRHOP_DELAY,
 		MARKET_OFFER_DURATION,
+		MARKET_HISTORY_DURATION,
 		CHECK_EXPIRED_MARKET_OFFERS_EACH_MINUTES,
 		MAX_MARKET_OFFERS_AT_A_TIME_PER_PLAYER,
 		EXP_FROM_PLAYERS_LEVEL_RANGE,
 		MAX_PACKETS_PER_SECOND,
+		ACCOUNT_CACHE_TTL,
+		PLAYER_CACHE_TTL,
+		BAN_CACHE_TTL,
 		SERVER_SAVE_NOTIFY_DURATION,
 		YELL_MINIMUM_LEVEL,
 		MINIMUM_LEVEL_TO_SEND_PRIVATE,
@@ -123,6 +135,8 @@ namespace ConfigManager {
 		STAMINA_REGEN_PREMIUM,
 		PATHFINDING_INTERVAL,
 		PATHFINDING_DELAY,
+		PYTHON_SNAPSHOT_INTERVAL,
+		PYTHON_SNAPSHOT_BUDGET,
 
 		LAST_INTEGER_CONFIG /* this must be the last one */
 	};
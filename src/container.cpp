@@ -47,6 +47,8 @@ Container::~Container() {
 		}
 	} else {
 		for (Item* item : itemlist) {
+			// the decay heap would otherwise keep it until its deadline
+			g_game.unscheduleDecay(item);
 			item->setParent(nullptr);
 			item->decrementReferenceCounter();
 		}
@@ -154,6 +156,11 @@ void Container::updateItemWeight(int32_t diff) {
 	}
 }
 
+Player* Container::getCountingPlayer() {
+	Player* player = dynamic_cast<Player*>(getTopParent());
+	return player && player->isInInventory(this) ? player : nullptr;
+}
+
 uint32_t Container::getWeight() const {
 	return Item::getWeight() + totalWeight;
 }
@@ -518,6 +525,9 @@ void Container::addThing(int32_t index, Thing* thing) {
 	item->setParent(this);
 	itemlist.push_front(item);
 	updateItemWeight(item->getWeight());
+	if (Player* player = getCountingPlayer()) {
+		player->updateItemTypeCounts(item, true);
+	}
 
 	//send change to client
 	if (hasParent() && (getParent() != VirtualCylinder::virtualCylinder)) {
@@ -528,6 +538,9 @@ void Container::addThing(int32_t index, Thing* thing) {
 void Container::addItemBack(Item* item) {
 	addItem(item);
 	updateItemWeight(item->getWeight());
+	if (Player* player = getCountingPlayer()) {
+		player->updateItemTypeCounts(item, true);
+	}
 
 	//send change to client
 	if (hasParent() && (getParent() != VirtualCylinder::virtualCylinder)) {
@@ -546,10 +559,18 @@ void Container::updateThing(Thing* thing, uint16_t itemId, uint32_t count) {
 		return /*RETURNVALUE_NOTPOSSIBLE*/;
 	}
 
+	Player* player = getCountingPlayer();
+	if (player) {
+		player->updateItemTypeCounts(item, false);
+	}
+
 	const int32_t oldWeight = item->getWeight();
 	item->setID(itemId);
 	item->setSubType(count);
 	updateItemWeight(-oldWeight + item->getWeight());
+	if (player) {
+		player->updateItemTypeCounts(item, true);
+	}
 
 	//send change to client
 	if (hasParent()) {
@@ -575,6 +596,10 @@ void Container::replaceThing(uint32_t index, Thing* thing) {
 	itemlist[index] = item;
 	item->setParent(this);
 	updateItemWeight(-static_cast<int32_t>(replacedItem->getWeight()) + item->getWeight());
+	if (Player* player = getCountingPlayer()) {
+		player->updateItemTypeCounts(replacedItem, false);
+		player->updateItemTypeCounts(item, true);
+	}
 
 	//send change to client
 	if (hasParent()) {
@@ -599,11 +624,19 @@ void Container::removeThing(Thing* thing, uint32_t count) {
 		return /*RETURNVALUE_NOTPOSSIBLE*/;
 	}
 
+	Player* player = getCountingPlayer();
+	if (player) {
+		player->updateItemTypeCounts(item, false);
+	}
+
 	if (item->isStackable() && count != item->getItemCount()) {
 		uint8_t newCount = static_cast<uint8_t>(std::max<int32_t>(0, item->getItemCount() - count));
 		const int32_t oldWeight = item->getWeight();
 		item->setItemCount(newCount);
 		updateItemWeight(-oldWeight + item->getWeight());
+		if (player) {
+			player->updateItemTypeCounts(item, true);
+		}
 
 		//send change to client
 		if (hasParent()) {
@@ -709,6 +742,10 @@ void Container::internalRemoveThing(Thing* thing) {
 	if (cit == itemlist.end()) {
 		return;
 	}
+
+	if (Player* player = getCountingPlayer()) {
+		player->updateItemTypeCounts(*cit, false);
+	}
 	itemlist.erase(cit);
 }
 
@@ -725,6 +762,9 @@ void Container::internalAddThing(uint32_t, Thing* thing) {
 	item->setParent(this);
 	itemlist.push_front(item);
 	updateItemWeight(item->getWeight());
+	if (Player* player = getCountingPlayer()) {
+		player->updateItemTypeCounts(item, true);
+	}
 }
 
 void Container::startDecaying() {
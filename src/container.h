@@ -161,6 +161,8 @@ class Container : public Item, public Cylinder {
 
 		Container* getParentContainer();
 		void updateItemWeight(int32_t diff);
+		// the player whose item type counts include what this container holds
+		Player* getCountingPlayer();
 
 		friend class ContainerIterator;
 		friend class IOMapSerialize;
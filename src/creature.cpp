@@ -306,14 +306,12 @@ void Creature::addEventWalk(bool firstStep) {
 		g_game.checkCreatureWalk(getID());
 	}
 
-	eventWalk = g_scheduler.addEvent(createSchedulerTask(ticks, [id = getID()]() { g_game.checkCreatureWalk(id); }));
+	eventWalk = g_game.scheduleCreatureWalk(getID(), ticks);
 }
 
 void Creature::stopEventWalk() {
-	if (eventWalk != 0) {
-		g_scheduler.stopEvent(eventWalk);
-		eventWalk = 0;
-	}
+	// the queued step is skipped once it no longer matches
+	eventWalk = 0;
 }
 
 void Creature::onCreatureAppear(Creature* creature, bool isLogin) {
@@ -1029,13 +1027,10 @@ bool Creature::addCombatCondition(Condition* condition) {
 }
 
 void Creature::removeCondition(ConditionType_t type, bool force/* = false*/) {
-	auto it = conditions.begin(), end = conditions.end();
-	while (it != end) {
+	// searched again after each removal, ending a condition may change the list
+	auto it = std::find_if(conditions.begin(), conditions.end(), [type](const Condition* condition) { return condition->getType() == type; });
+	while (it != conditions.end()) {
 		Condition* condition = *it;
-		if (condition->getType() != type) {
-			++it;
-			continue;
-		}
 
 		if (!force && type == CONDITION_PARALYZE) {
 			int64_t walkDelay = getWalkDelay();
@@ -1045,23 +1040,25 @@ void Creature::removeCondition(ConditionType_t type, bool force/* = false*/) {
 			}
 		}
 
-		it = conditions.erase(it);
+		eraseCondition(it - conditions.begin());
 
 		condition->endCondition(this);
 		delete condition;
 
 		onEndCondition(type);
+
+		it = std::find_if(conditions.begin(), conditions.end(), [type](const Condition* condition) { return condition->getType() == type; });
 	}
 }
 
 void Creature::removeCondition(ConditionType_t type, ConditionId_t conditionId, bool force/* = false*/) {
-	auto it = conditions.begin(), end = conditions.end();
-	while (it != end) {
+	auto matches = [type, conditionId](const Condition* condition) {
+		return condition->getType() == type && condition->getId() == conditionId;
+	};
+
+	auto it = std::find_if(conditions.begin(), conditions.end(), matches);
+	while (it != conditions.end()) {
 		Condition* condition = *it;
-		if (condition->getType() != type || condition->getId() != conditionId) {
-			++it;
-			continue;
-		}
 
 		if (!force && type == CONDITION_PARALYZE) {
 			int64_t walkDelay = getWalkDelay();
@@ -1071,12 +1068,14 @@ void Creature::removeCondition(ConditionType_t type, ConditionId_t conditionId,
 			}
 		}
 
-		it = conditions.erase(it);
+		eraseCondition(it - conditions.begin());
 
 		condition->endCondition(this);
 		delete condition;
 
 		onEndCondition(type);
+
+		it = std::find_if(conditions.begin(), conditions.end(), matches);
 	}
 }
 
@@ -1107,13 +1106,39 @@ void Creature::removeCondition(Condition* condition, bool force/* = false*/) {
 		}
 	}
 
-	conditions.erase(it);
+	eraseCondition(it - conditions.begin());
 
 	condition->endCondition(this);
 	onEndCondition(condition->getType());
 	delete condition;
 }
 
+void Creature::removeConditionsIf(const std::function<bool(const Condition*)>& pred) {
+	auto it = std::find_if(conditions.begin(), conditions.end(), pred);
+	while (it != conditions.end()) {
+		Condition* condition = *it;
+		eraseCondition(it - conditions.begin());
+
+		condition->endCondition(this);
+		onEndCondition(condition->getType());
+		delete condition;
+
+		it = std::find_if(conditions.begin(), conditions.end(), pred);
+	}
+}
+
+void Creature::eraseCondition(size_t index) {
+	conditions.erase(conditions.begin() + index);
+
+	if (executingConditions && index < conditionEnd) {
+		--conditionEnd;
+		// wraps below zero when the first one goes, the loop increment brings it back
+		if (index <= conditionIndex) {
+			--conditionIndex;
+		}
+	}
+}
+
 Condition* Creature::getCondition(ConditionType_t type) const {
 	for (Condition* condition : conditions) {
 		if (condition->getType() == type) {
@@ -1133,23 +1158,27 @@ Condition* Creature::getCondition(ConditionType_t type, ConditionId_t conditionI
 }
 
 void Creature::executeConditions(uint32_t interval) {
-	ConditionList tempConditions{ conditions };
-	for (Condition* condition : tempConditions) {
-		auto it = std::find(conditions.begin(), conditions.end(), condition);
-		if (it == conditions.end()) {
+	// walked in place; conditions added meanwhile wait for the next pass and
+	// eraseCondition keeps the index on the one executing when others go
+	executingConditions = true;
+	conditionEnd = conditions.size();
+	for (conditionIndex = 0; conditionIndex < conditionEnd; ++conditionIndex) {
+		Condition* condition = conditions[conditionIndex];
+		if (condition->executeCondition(this, interval)) {
 			continue;
 		}
 
-		if (!condition->executeCondition(this, interval)) {
-			it = std::find(conditions.begin(), conditions.end(), condition);
-			if (it != conditions.end()) {
-				conditions.erase(it);
-				condition->endCondition(this);
-				onEndCondition(condition->getType());
-				delete condition;
-			}
+		// already removed while it was executing
+		if (conditionIndex >= conditions.size() || conditions[conditionIndex] != condition) {
+			continue;
 		}
+
+		eraseCondition(conditionIndex);
+		condition->endCondition(this);
+		onEndCondition(condition->getType());
+		delete condition;
 	}
+	executingConditions = false;
 }
 
 bool Creature::hasCondition(ConditionType_t type, uint32_t subId/* = 0*/) const {
@@ -1431,7 +1460,7 @@ bool Creature::getPathTo(const Position& targetPos, std::vector<Direction>& dirL
 void Creature::setStorageValue(uint32_t key, std::optional<int32_t> value, bool isSpawn) {
 	auto oldValue = getStorageValue(key);
 	if (value) {
-		storageMap.insert_or_assign(key, value.value());
+		storageMap.set(key, value.value());
 	} else {
 		storageMap.erase(key);
 	}
@@ -1439,9 +1468,5 @@ void Creature::setStorageValue(uint32_t key, std::optional<int32_t> value, bool
 }
 
 std::optional<int32_t> Creature::getStorageValue(uint32_t key) const {
-	auto it = storageMap.find(key);
-	if (it == storageMap.end()) {
-		return std::nullopt;
-	}
-	return std::make_optional(it->second);
+	return storageMap.get(key);
 }
\ No newline at end of file
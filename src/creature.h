@@ -9,6 +9,7 @@
 #include "enums.h"
 #include "map.h"
 #include "position.h"
+#include "storagemap.h"
 #include "tile.h"
 
 class Condition;
@@ -18,7 +19,7 @@ class Monster;
 class Npc;
 class Player;
 
-using ConditionList = std::list<Condition*>;
+using ConditionList = std::vector<Condition*>;
 using CreatureEventList = std::list<CreatureEvent*>;
 
 enum slots_t : uint8_t {
@@ -487,7 +488,7 @@ class Creature : virtual public Thing {
 
 		virtual void setStorageValue(uint32_t key, std::optional<int32_t> value, bool isSpawn = false);
 		virtual std::optional<int32_t> getStorageValue(uint32_t key) const;
-		decltype(auto) getStorageMap() const {
+		const StorageMap& getStorageMap() const {
 			return storageMap;
 		}
 
@@ -505,6 +506,9 @@ class Creature : virtual public Thing {
 		std::list<Creature*> summons;
 		CreatureEventList eventsList;
 		ConditionList conditions;
+		// position of the executeConditions pass in progress, see eraseCondition
+		size_t conditionIndex = 0;
+		size_t conditionEnd = 0;
 
 		std::vector<Direction> listWalkDir;
 
@@ -552,6 +556,13 @@ class Creature : virtual public Thing {
 		bool hiddenHealth = false;
 		bool canUseDefense = true;
 		bool movementBlocked = false;
+		bool executingConditions = false;
+
+		// Erases conditions[index] without ending it; every removal goes through here so
+		// that executeConditions can walk the list in place while conditions come and go.
+		void eraseCondition(size_t index);
+		// Ends and deletes every condition matching pred.
+		void removeConditionsIf(const std::function<bool(const Condition*)>& pred);
 
 		//creature script events
 		bool hasEventRegistered(CreatureEventType_t event) const {
@@ -578,11 +589,12 @@ class Creature : virtual public Thing {
 		virtual Item* getCorpse(Creature* lastHitCreature, Creature* mostDamageCreature);
 
 		friend class Game;
+		friend class IOLoginData;
 		friend class Map;
 		friend class LuaScriptInterface;
 
 	private:
-		std::map<uint32_t, int32_t> storageMap;
+		StorageMap storageMap;
 };
 
 #endif // FS_CREATURE_H
\ No newline at end of file
@@ -7,6 +7,7 @@
 
 #include "configmanager.h"
 #include "common/diagnostics.h"
+#include "dbstats.h"
 #include "utils/Logger.h"
 
 #include <mysql/errmsg.h>
@@ -14,6 +15,7 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <bit>
 #include <chrono>
 #include <cctype>
 #include <string>
@@ -254,6 +256,7 @@ bool Database::commit() {
 }
 
 bool Database::executeQuery(const std::string& query) {
+        DBQueryTimer timer{query};
         std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
         const bool traceThis = shouldTraceRepEco(query);
         std::chrono::steady_clock::time_point start;
@@ -282,6 +285,7 @@ bool Database::executeQuery(const std::string& query) {
 }
 
 DBResult_ptr Database::storeQuery(std::string_view query) {
+        DBQueryTimer timer{query};
         std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
 
         const bool traceThis = shouldTraceRepEco(query);
@@ -332,6 +336,111 @@ retry:
         return result;
 }
 
+MYSQL_STMT* Database::prepareStatement(std::string_view query) {
+	if (statementsHandle != handle.get()) {
+		// reconnected; statements of the old connection are gone server side
+		statements.clear();
+		statementsHandle = handle.get();
+	}
+
+	auto it = statements.find(query);
+	if (it != statements.end()) {
+		return it->second.get();
+	}
+
+	detail::MysqlStatement_ptr stmt{mysql_stmt_init(handle.get())};
+	if (!stmt) {
+		return nullptr;
+	}
+
+	if (mysql_stmt_prepare(stmt.get(), query.data(), query.length()) != 0) {
+		std::cout << "[Error - mysql_stmt_prepare] Query: " << query.substr(0, 256) << std::endl << "Message: " << mysql_stmt_error(stmt.get()) << std::endl;
+		return nullptr;
+	}
+
+	// let mysql_stmt_store_result compute column widths, so results are bound in one pass
+	std::remove_pointer_t<decltype(MYSQL_BIND::is_null)> updateMaxLength = 1;
+	mysql_stmt_attr_set(stmt.get(), STMT_ATTR_UPDATE_MAX_LENGTH, &updateMaxLength);
+
+	return statements.emplace(query, std::move(stmt)).first->second.get();
+}
+
+MYSQL_STMT* Database::runStatement(std::string_view query, const DBParams& params) {
+	std::vector<MYSQL_BIND> binds(params.size());
+	for (size_t i = 0; i < params.size(); ++i) {
+		MYSQL_BIND& bind = binds[i];
+		std::visit([&bind, binary = params[i].binary](const auto& value) {
+			using T = std::decay_t<decltype(value)>;
+			if constexpr (std::is_same_v<T, std::monostate>) {
+				bind.buffer_type = MYSQL_TYPE_NULL;
+			} else if constexpr (std::is_same_v<T, int64_t> || std::is_same_v<T, uint64_t>) {
+				bind.buffer_type = MYSQL_TYPE_LONGLONG;
+				bind.buffer = const_cast<T*>(&value);
+				bind.is_unsigned = std::is_same_v<T, uint64_t>;
+			} else if constexpr (std::is_same_v<T, double>) {
+				bind.buffer_type = MYSQL_TYPE_DOUBLE;
+				bind.buffer = const_cast<double*>(&value);
+			} else {
+				bind.buffer_type = binary ? MYSQL_TYPE_BLOB : MYSQL_TYPE_STRING;
+				bind.buffer = const_cast<char*>(value.data());
+				bind.buffer_length = value.size();
+			}
+		}, params[i].value);
+	}
+
+	while (true) {
+		MYSQL_STMT* stmt = prepareStatement(query);
+		if (stmt) {
+			if (mysql_stmt_param_count(stmt) != params.size()) {
+				std::cout << "[Error - Database::runStatement] Query: " << query.substr(0, 256) << std::endl << "Message: expected " << mysql_stmt_param_count(stmt) << " parameters, got " << params.size() << std::endl;
+				return nullptr;
+			}
+
+			if (!mysql_stmt_bind_param(stmt, binds.data()) && mysql_stmt_execute(stmt) == 0) {
+				return stmt;
+			}
+			std::cout << "[Error - mysql_stmt_execute] Query: " << query.substr(0, 256) << std::endl << "Message: " << mysql_stmt_error(stmt) << std::endl;
+		}
+
+		const unsigned error = stmt ? mysql_stmt_errno(stmt) : mysql_errno(handle.get());
+		if (!isLostConnectionError(error) || !retryQueries) {
+			return nullptr;
+		}
+		handle = connectToDatabase(true);
+	}
+}
+
+bool Database::executeStatement(std::string_view query, const DBParams& params) {
+	DBQueryTimer timer{query};
+	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
+	return runStatement(query, params) != nullptr;
+}
+
+DBStatementResult_ptr Database::storeStatement(std::string_view query, const DBParams& params) {
+	DBQueryTimer timer{query};
+	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
+
+	MYSQL_STMT* stmt = runStatement(query, params);
+	if (!stmt) {
+		return nullptr;
+	}
+
+	detail::MysqlResult_ptr metadata{mysql_stmt_result_metadata(stmt)};
+	if (!metadata || mysql_stmt_store_result(stmt) != 0) {
+		std::cout << "[Error - mysql_stmt_store_result] Query: " << query.substr(0, 256) << std::endl << "Message: " << mysql_stmt_error(stmt) << std::endl;
+		mysql_stmt_free_result(stmt);
+		return nullptr;
+	}
+
+	// rows are decoded eagerly, so the statement is free for the next caller once we return
+	auto result = std::make_shared<DBStatementResult>(stmt, metadata.get());
+	mysql_stmt_free_result(stmt);
+	if (!result->hasNext()) {
+		return nullptr;
+	}
+	return result;
+}
+
 std::string Database::escapeBlob(const char* s, uint32_t length) const {
 	// the worst case is 2n + 1
 	size_t maxLength = (length * 2) + 1;
@@ -387,6 +496,113 @@ bool DBResult::next() {
 	return row;
 }
 
+DBStatementResult::DBStatementResult(MYSQL_STMT* stmt, MYSQL_RES* metadata) {
+	columns = mysql_num_fields(metadata);
+	rows = static_cast<size_t>(mysql_stmt_num_rows(stmt));
+	const MYSQL_FIELD* fields = mysql_fetch_fields(metadata);
+
+	using flag_t = std::remove_pointer_t<decltype(MYSQL_BIND::is_null)>;
+
+	// one reusable fetch buffer per column, sized from the max_length computed by store_result
+	std::vector<MYSQL_BIND> binds(columns);
+	std::vector<Cell::Kind> kinds(columns);
+	std::vector<std::string> buffers(columns);
+	std::vector<unsigned long> lengths(columns);
+	std::unique_ptr<flag_t[]> nulls(new flag_t[columns]);
+	std::vector<Cell> values(columns);
+
+	for (size_t i = 0; i < columns; ++i) {
+		MYSQL_BIND& bind = binds[i];
+		bind.is_null = &nulls[i];
+		bind.length = &lengths[i];
+
+		switch (fields[i].type) {
+			case MYSQL_TYPE_TINY:
+			case MYSQL_TYPE_SHORT:
+			case MYSQL_TYPE_INT24:
+			case MYSQL_TYPE_LONG:
+			case MYSQL_TYPE_LONGLONG:
+			case MYSQL_TYPE_YEAR: {
+				const bool isUnsigned = (fields[i].flags & UNSIGNED_FLAG) != 0;
+				kinds[i] = isUnsigned ? Cell::UNSIGNED : Cell::SIGNED;
+				bind.buffer_type = MYSQL_TYPE_LONGLONG;
+				bind.buffer = &values[i].signedValue;
+				bind.is_unsigned = isUnsigned;
+				break;
+			}
+
+			case MYSQL_TYPE_FLOAT:
+			case MYSQL_TYPE_DOUBLE:
+				kinds[i] = Cell::REAL;
+				bind.buffer_type = MYSQL_TYPE_DOUBLE;
+				bind.buffer = &values[i].realValue;
+				break;
+
+			default:
+				kinds[i] = Cell::TEXT;
+				buffers[i].resize(std::max<unsigned long>(fields[i].max_length, 1));
+				bind.buffer_type = MYSQL_TYPE_BLOB;
+				bind.buffer = buffers[i].data();
+				bind.buffer_length = buffers[i].size();
+				break;
+		}
+	}
+
+	if (mysql_stmt_bind_result(stmt, binds.data())) {
+		std::cout << "[Error - DBStatementResult] Message: " << mysql_stmt_error(stmt) << std::endl;
+		rows = 0;
+		return;
+	}
+
+	cells.reserve(rows * columns);
+	size_t fetched = 0;
+	for (int status = mysql_stmt_fetch(stmt); status == 0 || status == MYSQL_DATA_TRUNCATED; status = mysql_stmt_fetch(stmt)) {
+		for (size_t i = 0; i < columns; ++i) {
+			Cell& cell = cells.emplace_back(values[i]);
+			if (nulls[i]) {
+				cell.kind = Cell::NUL;
+				continue;
+			}
+
+			cell.kind = kinds[i];
+			if (cell.kind == Cell::TEXT) {
+				cell.offset = static_cast<uint32_t>(data.size());
+				cell.length = static_cast<uint32_t>(std::min<size_t>(lengths[i], buffers[i].size()));
+				data.append(buffers[i].data(), cell.length);
+				data.push_back('\0');
+			}
+		}
+		++fetched;
+	}
+	rows = fetched;
+}
+
+const DBStatementResult::Cell* DBStatementResult::getCell(size_t column) const {
+	if (column >= columns) {
+		std::cout << "[Error - DBStatementResult::getCell] Column " << column << " doesn't exist in the result set" << std::endl;
+		return nullptr;
+	}
+
+	const Cell& cell = cells[row * columns + column];
+	if (cell.kind == Cell::NUL) {
+		return nullptr;
+	}
+	return &cell;
+}
+
+std::string_view DBStatementResult::getString(size_t column) const {
+	const Cell* cell = getCell(column);
+	if (!cell) {
+		return {};
+	}
+
+	if (cell->kind != Cell::TEXT) {
+		std::cout << "[Error - DBStatementResult::getString] Column " << column << " is not a string column" << std::endl;
+		return {};
+	}
+	return {data.data() + cell->offset, cell->length};
+}
+
 DBInsert::DBInsert(std::string query) : query(std::move(query)) {
 	this->length = this->query.length();
 }
@@ -430,4 +646,79 @@ bool DBInsert::execute() {
 	values.clear();
 	length = query.length();
 	return res;
-}
\ No newline at end of file
+}
+
+DBStatementInsert::DBStatementInsert(Database& db, std::string query, size_t columns, std::string suffix) : db(db), query(std::move(query)), suffix(std::move(suffix)), columns(columns) {
+	placeholders.push_back('(');
+	for (size_t i = 0; i < columns; ++i) {
+		if (i != 0) {
+			placeholders.push_back(',');
+		}
+		placeholders.push_back('?');
+	}
+	placeholders.push_back(')');
+	values.reserve(ROWS_PER_STATEMENT * columns);
+}
+
+bool DBStatementInsert::addRow(DBParams&& row) {
+	if (row.size() != columns) {
+		std::cout << "[Error - DBStatementInsert::addRow] Expected " << columns << " values, got " << row.size() << std::endl;
+		return false;
+	}
+
+	for (DBParam& value : row) {
+		if (const auto* text = std::get_if<std::string>(&value.value)) {
+			length += text->size();
+		} else if (const auto* view = std::get_if<std::string_view>(&value.value)) {
+			// the row outlives the caller's string, so keep a copy
+			length += view->size();
+			value.value = std::string{*view};
+		} else {
+			length += sizeof(uint64_t);
+		}
+		values.push_back(std::move(value));
+	}
+
+	const size_t rows = values.size() / columns;
+	if (rows == ROWS_PER_STATEMENT || length > db.getMaxPacketSize() / 2) {
+		return execute();
+	}
+	return true;
+}
+
+bool DBStatementInsert::execute() {
+	// flush as power-of-two chunks so each table needs at most log2(ROWS_PER_STATEMENT) + 1 statements
+	size_t rows = values.size() / columns;
+	size_t first = 0;
+	while (rows != 0) {
+		size_t count = std::bit_floor(rows);
+		if (!executeRows(first, count)) {
+			values.clear();
+			length = 0;
+			return false;
+		}
+		first += count;
+		rows -= count;
+	}
+
+	values.clear();
+	length = 0;
+	return true;
+}
+
+bool DBStatementInsert::executeRows(size_t first, size_t count) {
+	std::string statement;
+	statement.reserve(query.size() + count * (placeholders.size() + 1) + suffix.size());
+	statement.append(query);
+	for (size_t i = 0; i < count; ++i) {
+		if (i != 0) {
+			statement.push_back(',');
+		}
+		statement.append(placeholders);
+	}
+	statement.append(suffix);
+
+	auto begin = values.begin() + first * columns;
+	DBParams params(std::make_move_iterator(begin), std::make_move_iterator(begin + count * columns));
+	return db.executeStatement(statement, params);
+}
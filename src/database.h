@@ -7,21 +7,70 @@
 #include "pugicast.h"
 
 class DBResult;
+class DBStatementResult;
 
 using DBResult_ptr = std::shared_ptr<DBResult>;
+using DBStatementResult_ptr = std::shared_ptr<DBStatementResult>;
 
 namespace detail {
 
 	struct MysqlDeleter{
 		void operator()(MYSQL* handle) const { mysql_close(handle); }
 		void operator()(MYSQL_RES* handle) const { mysql_free_result(handle); }
+		void operator()(MYSQL_STMT* handle) const { mysql_stmt_close(handle); }
 	};
 
 	using Mysql_ptr = std::unique_ptr<MYSQL, MysqlDeleter>;
 	using MysqlResult_ptr = std::unique_ptr<MYSQL_RES, MysqlDeleter>;
+	using MysqlStatement_ptr = std::unique_ptr<MYSQL_STMT, MysqlDeleter>;
 
 } // namespace detail
 
+/**
+ * Value bound to a prepared statement placeholder.
+ *
+ * Strings passed as lvalues or views are referenced, not copied, and must
+ * outlive the statement call; temporaries are moved into the parameter.
+ */
+class DBParam {
+	public:
+		DBParam(std::nullptr_t) {}
+		DBParam(bool value) : value{static_cast<uint64_t>(value)} {}
+		template<std::signed_integral T>
+		DBParam(T value) : value{static_cast<int64_t>(value)} {}
+		template<std::unsigned_integral T>
+		DBParam(T value) : value{static_cast<uint64_t>(value)} {}
+		DBParam(double value) : value{value} {}
+		DBParam(const char* value) : value{std::string_view{value}} {}
+		DBParam(std::string_view value) : value{value} {}
+		DBParam(const std::string& value) : value{std::string_view{value}} {}
+		DBParam(std::string&& value) : value{std::move(value)} {}
+
+		/**
+		 * Binary parameter (BLOB columns); bypasses character set conversion.
+		 */
+		static DBParam blob(std::string_view data) {
+			DBParam param{data};
+			param.binary = true;
+			return param;
+		}
+
+		static DBParam blob(std::string&& data) {
+			DBParam param{std::move(data)};
+			param.binary = true;
+			return param;
+		}
+
+	private:
+		std::variant<std::monostate, int64_t, uint64_t, double, std::string_view, std::string> value;
+		bool binary = false;
+
+	friend class Database;
+	friend class DBStatementInsert;
+};
+
+using DBParams = std::vector<DBParam>;
+
 class Database {
 	public:
 		/**
@@ -60,6 +109,28 @@ class Database {
 		 */
 		DBResult_ptr storeQuery(std::string_view query);
 
+		/**
+		 * Executes prepared statement.
+		 *
+		 * Statements are prepared once per query text and kept for the lifetime of
+		 * the connection; placeholders (?) are bound from params in order.
+		 *
+		 * @param query statement with placeholders
+		 * @param params values bound to the placeholders
+		 * @return true on success, false on error
+		 */
+		bool executeStatement(std::string_view query, const DBParams& params);
+
+		/**
+		 * Queries database through a prepared statement.
+		 *
+		 * Rows are transferred in the binary protocol and decoded once into typed
+		 * columns, which are read back by index.
+		 *
+		 * @return results object (nullptr on error or if there are no rows)
+		 */
+		DBStatementResult_ptr storeStatement(std::string_view query, const DBParams& params);
+
 		/**
 		 * Escapes string for query.
 		 *
@@ -117,7 +188,13 @@ class Database {
 		bool rollback();
 		bool commit();
 
+		MYSQL_STMT* prepareStatement(std::string_view query);
+		MYSQL_STMT* runStatement(std::string_view query, const DBParams& params);
+
 		detail::Mysql_ptr handle = nullptr;
+		// prepared statements belong to the connection they were prepared on
+		std::map<std::string, detail::MysqlStatement_ptr, std::less<>> statements;
+		const MYSQL* statementsHandle = nullptr;
 		std::recursive_mutex databaseLock;
 		uint64_t maxPacketSize = 1048576;
 		// Do not retry queries if we are in the middle of a transaction
@@ -163,6 +240,79 @@ class DBResult {
 	friend class Database;
 };
 
+class DBStatementResult {
+	public:
+		DBStatementResult(MYSQL_STMT* stmt, MYSQL_RES* metadata);
+
+		// non-copyable
+		DBStatementResult(const DBStatementResult&) = delete;
+		DBStatementResult& operator=(const DBStatementResult&) = delete;
+
+		template<typename T>
+		T getNumber(size_t column) const {
+			const Cell* cell = getCell(column);
+			if (!cell) {
+				return {};
+			}
+
+			switch (cell->kind) {
+				case Cell::SIGNED:
+					return static_cast<T>(cell->signedValue);
+				case Cell::UNSIGNED:
+					return static_cast<T>(cell->unsignedValue);
+				case Cell::REAL:
+					return static_cast<T>(cell->realValue);
+				case Cell::TEXT:
+					return pugi::cast<T>(data.data() + cell->offset);
+				default:
+					return {};
+			}
+		}
+
+		std::string_view getString(size_t column) const;
+
+		size_t getRowCount() const {
+			return rows;
+		}
+
+		bool hasNext() const {
+			return row < rows;
+		}
+
+		bool next() {
+			return ++row < rows;
+		}
+
+	private:
+		struct Cell {
+			enum Kind : uint8_t {
+				NUL,
+				SIGNED,
+				UNSIGNED,
+				REAL,
+				TEXT,
+			};
+
+			union {
+				int64_t signedValue;
+				uint64_t unsignedValue;
+				double realValue;
+			};
+			uint32_t offset = 0;
+			uint32_t length = 0;
+			Kind kind = NUL;
+		};
+
+		const Cell* getCell(size_t column) const;
+
+		// row-major, columns cells per row; TEXT cells point into data (null-terminated)
+		std::vector<Cell> cells;
+		std::string data;
+		size_t columns = 0;
+		size_t rows = 0;
+		size_t row = 0;
+};
+
 /**
 * INSERT statement.
 */
@@ -179,6 +329,34 @@ class DBInsert {
 		size_t length;
 };
 
+/**
+ * INSERT through prepared statements.
+ *
+ * Rows are sent in multi-row statements of power-of-two sizes, so every table
+ * needs at most a handful of distinct prepared statements. Rows are buffered
+ * until flushed, so referenced strings are copied when the row is added.
+ * A suffix (e.g. ON DUPLICATE KEY UPDATE ...) is appended after the rows.
+ */
+class DBStatementInsert {
+	public:
+		DBStatementInsert(Database& db, std::string query, size_t columns, std::string suffix = {});
+		bool addRow(DBParams&& row);
+		bool execute();
+
+	private:
+		static constexpr size_t ROWS_PER_STATEMENT = 128;
+
+		bool executeRows(size_t first, size_t count);
+
+		Database& db;
+		std::string query;
+		std::string suffix;
+		std::string placeholders;
+		DBParams values;
+		size_t columns;
+		size_t length = 0;
+};
+
 class DBTransaction {
 	public:
 		constexpr DBTransaction() = default;
@@ -5,52 +5,126 @@
 
 #include "databasetasks.h"
 
+#include "configmanager.h"
+#include "dbstats.h"
 #include "tasks.h"
 
 extern Dispatcher g_dispatcher;
 
 void DatabaseTasks::start() {
-	db.connect();
-	ThreadHolder::start();
+	const size_t workers = std::max<int64_t>(1, getNumber(ConfigManager::SQL_WORKERS));
+	for (size_t i = 0; i < workers; ++i) {
+		auto db = std::make_unique<Database>();
+		if (!db->connect()) {
+			std::cout << "[Warning - DatabaseTasks::start] Failed to open worker connection " << i << std::endl;
+			if (!connections.empty()) {
+				break;
+			}
+		}
+		connections.push_back(std::move(db));
+	}
+
+	threadState.store(THREAD_STATE_RUNNING, std::memory_order_relaxed);
+	for (auto& db : connections) {
+		threads.emplace_back(&DatabaseTasks::threadMain, this, std::ref(*db));
+	}
 }
 
-void DatabaseTasks::threadMain() {
-	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
-	while (getState() != THREAD_STATE_TERMINATED) {
-		taskLockUnique.lock();
-		if (tasks.empty()) {
+void DatabaseTasks::stop() {
+	threadState.store(THREAD_STATE_CLOSING, std::memory_order_relaxed);
+}
+
+void DatabaseTasks::join() {
+	for (std::thread& thread : threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+}
+
+std::list<DatabaseTask>::iterator DatabaseTasks::findRunnableTask() {
+	// the first queued task of a key is always its oldest, so skipping busy keys keeps per-key order
+	return std::find_if(tasks.begin(), tasks.end(), [this](const DatabaseTask& task) {
+		return task.orderKey == 0 || !runningKeys.contains(task.orderKey);
+	});
+}
+
+void DatabaseTasks::threadMain(Database& db) {
+	DBQueryStats::setThreadRole(DBThreadRole::WORKER);
+
+	std::unique_lock<std::mutex> taskLockUnique(taskLock);
+	while (threadState.load(std::memory_order_relaxed) != THREAD_STATE_TERMINATED) {
+		auto it = findRunnableTask();
+		if (it == tasks.end()) {
 			taskSignal.wait(taskLockUnique);
+			continue;
+		}
+
+		DatabaseTask task = std::move(*it);
+		tasks.erase(it);
+		if (task.orderKey != 0) {
+			runningKeys.insert(task.orderKey);
 		}
+		++runningTasks;
+		taskLockUnique.unlock();
 
-		if (!tasks.empty()) {
-			DatabaseTask task = std::move(tasks.front());
-			tasks.pop_front();
-			taskLockUnique.unlock();
-			runTask(task);
-		} else {
-			taskLockUnique.unlock();
+		runTask(db, task);
+
+		taskLockUnique.lock();
+		--runningTasks;
+		if (task.orderKey != 0) {
+			// this worker picks up the next task of the key itself when it loops
+			runningKeys.erase(task.orderKey);
 		}
+
+		// flush() after shutdown waits for running tasks alone, with the
+		// queue still full, so this can't also wait for an empty queue
+		if (runningTasks == 0) {
+			idleSignal.notify_all();
+		}
+	}
+}
+
+void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback/* = nullptr*/, bool store/* = false*/, uint64_t orderKey/* = 0*/) {
+	bool signal = false;
+	taskLock.lock();
+	if (threadState.load(std::memory_order_relaxed) == THREAD_STATE_RUNNING) {
+		signal = true;
+		tasks.emplace_back(std::move(query), std::move(callback), store, orderKey);
+		highWater = std::max<uint32_t>(highWater, tasks.size());
+	}
+	taskLock.unlock();
+
+	if (signal) {
+		taskSignal.notify_one();
 	}
 }
 
-void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback/* = nullptr*/, bool store/* = false*/) {
+bool DatabaseTasks::addJob(std::function<void(Database&)> job, uint64_t orderKey/* = 0*/) {
 	bool signal = false;
 	taskLock.lock();
-	if (getState() == THREAD_STATE_RUNNING) {
-		signal = tasks.empty();
-		tasks.emplace_back(std::move(query), std::move(callback), store);
+	if (threadState.load(std::memory_order_relaxed) == THREAD_STATE_RUNNING) {
+		signal = true;
+		tasks.emplace_back(std::move(job), orderKey);
+		highWater = std::max<uint32_t>(highWater, tasks.size());
 	}
 	taskLock.unlock();
 
 	if (signal) {
 		taskSignal.notify_one();
 	}
+	return signal;
 }
 
-void DatabaseTasks::runTask(const DatabaseTask& task) {
+void DatabaseTasks::runTask(Database& db, const DatabaseTask& task) {
+	const auto start = std::chrono::steady_clock::now();
+
 	bool success;
 	DBResult_ptr result;
-	if (task.store) {
+	if (task.job) {
+		task.job(db);
+		success = true;
+	} else if (task.store) {
 		result = db.storeQuery(task.query);
 		success = true;
 	} else {
@@ -58,6 +132,18 @@ void DatabaseTasks::runTask(const DatabaseTask& task) {
 		success = db.executeQuery(task.query);
 	}
 
+	const auto end = std::chrono::steady_clock::now();
+	const uint64_t waitMicros = std::chrono::duration_cast<std::chrono::microseconds>(start - task.enqueuedAt).count();
+	const uint64_t runMicros = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+	{
+		std::lock_guard<std::mutex> lockGuard(statsLock);
+		++stats.executed;
+		stats.totalWaitMicros += waitMicros;
+		stats.maxWaitMicros = std::max(stats.maxWaitMicros, waitMicros);
+		stats.totalRunMicros += runMicros;
+		stats.maxRunMicros = std::max(stats.maxRunMicros, runMicros);
+	}
+
 	if (task.callback) {
 		g_dispatcher.addTask([=, callback = task.callback]() {
 			callback(result, success);
@@ -67,19 +153,43 @@ void DatabaseTasks::runTask(const DatabaseTask& task) {
 
 void DatabaseTasks::flush() {
 	std::unique_lock<std::mutex> guard{ taskLock };
+	if (threadState.load(std::memory_order_relaxed) != THREAD_STATE_TERMINATED && !connections.empty()) {
+		idleSignal.wait(guard, [this]() { return tasks.empty() && runningTasks == 0; });
+		return;
+	}
+
+	// workers are gone: let in-flight tasks finish so keyed order holds, then run the rest here
+	idleSignal.wait(guard, [this]() { return runningTasks == 0; });
+
+	Database& db = connections.empty() ? Database::getInstance() : *connections.front();
 	while (!tasks.empty()) {
 		auto task = std::move(tasks.front());
 		tasks.pop_front();
 		guard.unlock();
-		runTask(task);
+		runTask(db, task);
 		guard.lock();
 	}
 }
 
 void DatabaseTasks::shutdown() {
 	taskLock.lock();
-	setState(THREAD_STATE_TERMINATED);
+	threadState.store(THREAD_STATE_TERMINATED, std::memory_order_relaxed);
 	taskLock.unlock();
+	taskSignal.notify_all();
 	flush();
-	taskSignal.notify_one();
-}
\ No newline at end of file
+}
+
+DatabaseTaskStats DatabaseTasks::getStats() {
+	DatabaseTaskStats result;
+	{
+		std::lock_guard<std::mutex> lockGuard(statsLock);
+		result = stats;
+	}
+
+	std::lock_guard<std::mutex> lockGuard(taskLock);
+	result.pending = tasks.size();
+	result.running = runningTasks;
+	result.highWater = highWater;
+	result.workers = connections.size();
+	return result;
+}
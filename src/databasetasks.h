@@ -6,37 +6,97 @@
 
 #include "database.h"
 
-#include "thread_holder_base.h"
+#include "enums.h"
+
+// Scope of an ordering key, so ids of different entities never share a lane.
+enum class DatabaseOrder : uint8_t {
+	NONE,
+	PLAYER,
+	ACCOUNT,
+	SCRIPT,
+};
 
 struct DatabaseTask {
-	DatabaseTask(std::string&& query, std::function<void(DBResult_ptr, bool)>&& callback, bool store) :
-		query(std::move(query)), callback(std::move(callback)), store(store) {}
+	DatabaseTask(std::string&& query, std::function<void(DBResult_ptr, bool)>&& callback, bool store, uint64_t orderKey) :
+		query(std::move(query)), callback(std::move(callback)), store(store), orderKey(orderKey),
+		enqueuedAt(std::chrono::steady_clock::now()) {}
+	DatabaseTask(std::function<void(Database&)>&& job, uint64_t orderKey) :
+		job(std::move(job)), store(false), orderKey(orderKey), enqueuedAt(std::chrono::steady_clock::now()) {}
 
 	std::string query;
 	std::function<void(DBResult_ptr, bool)> callback;
+	// runs instead of query; results go back to the dispatcher through the job itself
+	std::function<void(Database&)> job;
 	bool store;
+	uint64_t orderKey;
+	std::chrono::steady_clock::time_point enqueuedAt;
 };
 
-class DatabaseTasks : public ThreadHolder<DatabaseTasks> {
+struct DatabaseTaskStats {
+	uint64_t executed = 0;
+	uint32_t pending = 0;
+	uint32_t running = 0;
+	uint32_t highWater = 0;
+	uint32_t workers = 0;
+	uint64_t totalWaitMicros = 0;
+	uint64_t maxWaitMicros = 0;
+	uint64_t totalRunMicros = 0;
+	uint64_t maxRunMicros = 0;
+};
+
+class DatabaseTasks {
 	public:
 		DatabaseTasks() = default;
 		void start();
+		void stop();
+		void join();
 		void flush();
 		void shutdown();
 
-		void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false);
+		/**
+		 * Queues a query for one of the worker connections.
+		 *
+		 * Tasks with the same non-zero orderKey run one at a time in the order they were
+		 * added; tasks without a key may run in parallel with anything else.
+		 */
+		void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false, uint64_t orderKey = 0);
+
+		/**
+		 * Queues a function that runs its own queries on a worker connection.
+		 *
+		 * @return false if the workers are shutting down and the job was not queued
+		 */
+		bool addJob(std::function<void(Database&)> job, uint64_t orderKey = 0);
+
+		static constexpr uint64_t makeOrderKey(DatabaseOrder scope, uint32_t id) {
+			return (static_cast<uint64_t>(scope) << 32) | id;
+		}
+
+		DatabaseTaskStats getStats();
 
-		void threadMain();
 	private:
-		void runTask(const DatabaseTask& task);
+		void threadMain(Database& db);
+		std::list<DatabaseTask>::iterator findRunnableTask();
+		void runTask(Database& db, const DatabaseTask& task);
+
+		std::vector<std::unique_ptr<Database>> connections;
+		std::vector<std::thread> threads;
 
-		Database db;
-		std::thread thread;
 		std::list<DatabaseTask> tasks;
+		// order keys of tasks currently running on a worker
+		std::unordered_set<uint64_t> runningKeys;
+		uint32_t runningTasks = 0;
 		std::mutex taskLock;
 		std::condition_variable taskSignal;
+		std::condition_variable idleSignal;
+		uint32_t highWater = 0;
+		std::atomic<ThreadState> threadState{THREAD_STATE_TERMINATED};
+
+		// latency counters; pending, running and highWater are filled in from the queue state
+		DatabaseTaskStats stats;
+		std::mutex statsLock;
 };
 
 extern DatabaseTasks g_databaseTasks;
 
-#endif // FS_DATABASETASKS_H
\ No newline at end of file
+#endif // FS_DATABASETASKS_H
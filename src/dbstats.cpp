@@ -0,0 +1,231 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "dbstats.h"
+
+#include "configmanager.h"
+#include "tools.h"
+#include "utils/Logger.h"
+
+#include <bit>
+
+namespace {
+
+thread_local DBThreadRole threadRole = DBThreadRole::OTHER;
+
+const char* getRoleName(DBThreadRole role) {
+	switch (role) {
+		case DBThreadRole::DISPATCHER:
+			return "dispatcher";
+		case DBThreadRole::WORKER:
+			return "worker";
+		default:
+			return "other";
+	}
+}
+
+bool isIdentifierChar(char ch) {
+	return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_';
+}
+
+// "?, ?" folds into a single "?", so IN lists and rows of any width share a fingerprint
+void addPlaceholder(std::string& out) {
+	size_t pos = out.find_last_not_of(' ');
+	if (pos != std::string::npos && pos > 0 && out[pos] == ',') {
+		size_t prev = out.find_last_not_of(' ', pos - 1);
+		if (prev != std::string::npos && out[prev] == '?') {
+			out.resize(prev + 1);
+			return;
+		}
+	}
+	out.push_back('?');
+}
+
+// multi-row INSERT: "(?, NOW()), (?, NOW())" -> "(?, NOW())"; only tuples holding a placeholder fold
+void foldRepeatedTuples(std::string& out) {
+	for (size_t open = out.find('('); open != std::string::npos; open = out.find('(', open + 1)) {
+		size_t close = open + 1;
+		for (size_t depth = 1; close < out.size(); ++close) {
+			if (out[close] == '(') {
+				++depth;
+			} else if (out[close] == ')' && --depth == 0) {
+				break;
+			}
+		}
+
+		if (close >= out.size() || out.find('?', open) > close) {
+			continue;
+		}
+
+		const size_t length = close - open + 1;
+		size_t next = close + 1;
+		while (true) {
+			size_t pos = next;
+			if (pos < out.size() && out[pos] == ',') {
+				++pos;
+			}
+			if (pos < out.size() && out[pos] == ' ') {
+				++pos;
+			}
+
+			if (pos == next || out.compare(pos, length, out, open, length) != 0) {
+				break;
+			}
+			next = pos + length;
+		}
+		out.erase(close + 1, next - close - 1);
+	}
+}
+
+void addHistogram(DBQueryHistogram& to, const DBQueryHistogram& from) {
+	for (size_t i = 0; i < DBQueryHistogram::BUCKETS; ++i) {
+		to.buckets[i] += from.buckets[i];
+	}
+	to.count += from.count;
+	to.totalMicros += from.totalMicros;
+	to.maxMicros = std::max(to.maxMicros, from.maxMicros);
+}
+
+} // namespace
+
+void DBQueryStats::setThreadRole(DBThreadRole role) {
+	threadRole = role;
+}
+
+DBThreadRole DBQueryStats::getThreadRole() {
+	return threadRole;
+}
+
+std::string DBQueryStats::fingerprint(std::string_view query) {
+	std::string out;
+	out.reserve(std::min<size_t>(query.size(), 256));
+
+	size_t i = 0;
+	while (i < query.size()) {
+		const char ch = query[i];
+		if (std::isspace(static_cast<unsigned char>(ch))) {
+			if (!out.empty() && out.back() != ' ') {
+				out.push_back(' ');
+			}
+			++i;
+		} else if (ch == '\'' || ch == '"') {
+			// string literal; escaped and doubled quotes stay inside it
+			for (++i; i < query.size(); ++i) {
+				if (query[i] == '\\') {
+					++i;
+				} else if (query[i] == ch) {
+					if (i + 1 < query.size() && query[i + 1] == ch) {
+						++i;
+					} else {
+						break;
+					}
+				}
+			}
+			++i;
+			addPlaceholder(out);
+		} else if (ch == '`') {
+			const size_t end = query.find('`', i + 1);
+			const size_t length = (end == std::string_view::npos ? query.size() : end + 1) - i;
+			out.append(query.substr(i, length));
+			i += length;
+		} else if (std::isdigit(static_cast<unsigned char>(ch)) && (out.empty() || !isIdentifierChar(out.back()))) {
+			// numbers, including 0x blobs and decimals
+			while (i < query.size() && (std::isxdigit(static_cast<unsigned char>(query[i])) || query[i] == 'x' || query[i] == 'X' || query[i] == '.')) {
+				++i;
+			}
+			addPlaceholder(out);
+		} else if (ch == '?') {
+			// prepared statement placeholders fold like literals
+			addPlaceholder(out);
+			++i;
+		} else {
+			out.push_back(ch);
+			++i;
+		}
+	}
+
+	if (!out.empty() && out.back() == ' ') {
+		out.pop_back();
+	}
+
+	foldRepeatedTuples(out);
+	return out;
+}
+
+void DBQueryStats::record(std::string_view query, uint64_t micros) {
+	const DBThreadRole role = threadRole;
+	std::string key = fingerprint(query);
+
+	{
+		Shard& shard = shards[std::hash<std::string>{}(key) % SHARDS];
+		std::lock_guard<std::mutex> lockGuard(shard.lock);
+		auto it = shard.fingerprints.find(key);
+		if (it == shard.fingerprints.end()) {
+			// each shard keeps its own overflow entry; getFingerprints merges them
+			it = shard.fingerprints.try_emplace(shard.fingerprints.size() >= MAX_FINGERPRINTS / SHARDS ? "<other>" : key).first;
+			it->second.fingerprint = it->first;
+		}
+
+		DBQueryHistogram& histogram = it->second.roles[static_cast<size_t>(role)];
+		++histogram.buckets[std::min<size_t>(std::bit_width(micros >> 4), DBQueryHistogram::BUCKETS - 1)];
+		++histogram.count;
+		histogram.totalMicros += micros;
+		histogram.maxMicros = std::max(histogram.maxMicros, micros);
+	}
+
+	const int64_t threshold = getNumber(ConfigManager::SQL_SLOW_QUERY_THRESHOLD);
+	if (threshold <= 0 || micros < static_cast<uint64_t>(threshold) * 1000) {
+		return;
+	}
+
+	// the fingerprint, not the query, so values written by players never reach the log
+	Logger::instance().warn(fmt::format("SQL[slow] {} us on {} thread{}: {}", micros, getRoleName(role), role == DBThreadRole::DISPATCHER ? " (blocked the dispatcher)" : "", key));
+
+	std::lock_guard<std::mutex> lockGuard(slowLock);
+	if (slowQueries.size() >= MAX_SLOW_QUERIES) {
+		slowQueries.pop_front();
+	}
+	slowQueries.push_back({std::move(key), OTSYS_TIME(), micros, role});
+}
+
+std::vector<DBQueryFingerprintStats> DBQueryStats::getFingerprints() {
+	std::vector<DBQueryFingerprintStats> result;
+	DBQueryFingerprintStats other;
+	other.fingerprint = "<other>";
+
+	for (Shard& shard : shards) {
+		std::lock_guard<std::mutex> lockGuard(shard.lock);
+		for (const auto& it : shard.fingerprints) {
+			if (it.first != other.fingerprint) {
+				result.push_back(it.second);
+				continue;
+			}
+
+			for (size_t role = 0; role < other.roles.size(); ++role) {
+				addHistogram(other.roles[role], it.second.roles[role]);
+			}
+		}
+	}
+
+	if (std::any_of(other.roles.begin(), other.roles.end(), [](const DBQueryHistogram& histogram) { return histogram.count != 0; })) {
+		result.push_back(std::move(other));
+	}
+	return result;
+}
+
+std::vector<DBSlowQuery> DBQueryStats::getSlowQueries() {
+	std::lock_guard<std::mutex> lockGuard(slowLock);
+	return {slowQueries.begin(), slowQueries.end()};
+}
+
+void DBQueryStats::reset() {
+	for (Shard& shard : shards) {
+		std::lock_guard<std::mutex> lockGuard(shard.lock);
+		shard.fingerprints.clear();
+	}
+
+	std::lock_guard<std::mutex> lockGuard(slowLock);
+	slowQueries.clear();
+}
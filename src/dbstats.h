@@ -0,0 +1,103 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_DBSTATS_H
+#define FS_DBSTATS_H
+
+// Thread a query was issued from; set once by each thread's main loop.
+enum class DBThreadRole : uint8_t {
+	OTHER,
+	DISPATCHER,
+	WORKER,
+
+	COUNT
+};
+
+// Latency histogram with power-of-two microsecond buckets: bucket i counts
+// queries that took less than 2^(i + 4) us, the last bucket everything slower.
+struct DBQueryHistogram {
+	static constexpr size_t BUCKETS = 20;
+
+	std::array<uint64_t, BUCKETS> buckets{};
+	uint64_t count = 0;
+	uint64_t totalMicros = 0;
+	uint64_t maxMicros = 0;
+};
+
+struct DBQueryFingerprintStats {
+	std::string fingerprint;
+	std::array<DBQueryHistogram, static_cast<size_t>(DBThreadRole::COUNT)> roles;
+};
+
+struct DBSlowQuery {
+	std::string fingerprint;
+	int64_t timestamp;
+	uint64_t micros;
+	DBThreadRole role;
+};
+
+/**
+ * Per-fingerprint latency accounting for every query passing through
+ * Database, split by the thread that issued it, plus a bounded log of the
+ * queries that exceeded mysqlSlowQueryThreshold.
+ *
+ * A fingerprint is the query text with literals replaced by '?' and repeated
+ * value lists folded, so "WHERE `id` = 12" and "WHERE `id` = 13" share one.
+ * Fingerprints are spread over independently locked shards, so threads
+ * recording different queries do not wait on each other.
+ */
+class DBQueryStats {
+	public:
+		static constexpr size_t MAX_FINGERPRINTS = 2048;
+		static constexpr size_t MAX_SLOW_QUERIES = 256;
+		static constexpr size_t SHARDS = 16;
+
+		static DBQueryStats& getInstance() {
+			static DBQueryStats instance;
+			return instance;
+		}
+
+		static void setThreadRole(DBThreadRole role);
+		static DBThreadRole getThreadRole();
+
+		static std::string fingerprint(std::string_view query);
+
+		void record(std::string_view query, uint64_t micros);
+
+		std::vector<DBQueryFingerprintStats> getFingerprints();
+		std::vector<DBSlowQuery> getSlowQueries();
+		void reset();
+
+	private:
+		DBQueryStats() = default;
+
+		struct Shard {
+			std::mutex lock;
+			std::unordered_map<std::string, DBQueryFingerprintStats> fingerprints;
+		};
+
+		std::array<Shard, SHARDS> shards;
+
+		std::mutex slowLock;
+		std::deque<DBSlowQuery> slowQueries;
+};
+
+// Times one query from construction to destruction and records it.
+class DBQueryTimer {
+	public:
+		explicit DBQueryTimer(std::string_view query) : query{query}, start{std::chrono::steady_clock::now()} {}
+		~DBQueryTimer() {
+			const auto elapsed = std::chrono::steady_clock::now() - start;
+			DBQueryStats::getInstance().record(query, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+		}
+
+		// non-copyable
+		DBQueryTimer(const DBQueryTimer&) = delete;
+		DBQueryTimer& operator=(const DBQueryTimer&) = delete;
+
+	private:
+		std::string_view query;
+		std::chrono::steady_clock::time_point start;
+};
+
+#endif // FS_DBSTATS_H
@@ -542,6 +542,7 @@ struct HistoryMarketOffer {
 	uint16_t itemId;
 	uint16_t amount;
 	MarketOfferState_t state;
+	uint32_t inserted = 0;
 };
 
 struct MarketStatistics {
@@ -21,6 +21,7 @@
 #include "inbox.h"
 #include "iologindata.h"
 #include "iomarket.h"
+#include "playerjournal.h"
 #include "items.h"
 #include "monster.h"
 #include "movement.h"
@@ -51,6 +52,7 @@ extern Monsters g_monsters;
 extern MoveEvents* g_moveEvents;
 extern Weapons* g_weapons;
 extern Scripts* g_scripts;
+extern Npcs* g_npcs;
 
 Game::Game() {
 	offlineTrainingWindow.defaultEnterButton = 0;
@@ -66,7 +68,12 @@ Game::Game() {
 }
 
 Game::~Game() {
-
+	// the map is destroyed after this and its containers take their items
+	// out of the decay heap, which must not point at a destroyed vector
+	for (Item* item : decayHeap) {
+		item->decayIndex = Item::DECAY_INDEX_NONE;
+	}
+	decayHeap.clear();
 }
 
 void Game::start(ServiceManager* manager) {
@@ -192,20 +199,33 @@ void Game::saveGameState() {
 	}
 
 	std::cout << "Saving server..." << std::endl;
+	const auto start = std::chrono::steady_clock::now();
 
 	if (!saveAccountStorageValues()) {
 		std::cout << "[Error - Game::saveGameState] Failed to save account-level storage values." << std::endl;
 	}
 
+	std::vector<Player*> savePlayers;
+	savePlayers.reserve(players.size());
 	for (const auto& it : players) {
 		it.second->loginPosition = it.second->getPosition();
-		IOLoginData::savePlayer(it.second);
+		savePlayers.push_back(it.second);
+	}
+
+	if (IOLoginData::savePlayers(savePlayers)) {
+		g_playerJournal.truncate();
+	} else {
+		std::cout << "[Error - Game::saveGameState] Failed to save some players." << std::endl;
 	}
 
 	Map::save();
 
 	g_databaseTasks.flush();
 
+	const PlayerSaveStats saveStats = IOLoginData::getPlayerSaveStats();
+	const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "> Saved server in " << elapsed << " ms (" << saveStats.lastPlayers << " players in " << saveStats.lastMicros / 1000 << " ms)." << std::endl;
+
 	if (gameState == GAME_STATE_MAINTAIN) {
 		setGameState(GAME_STATE_NORMAL);
 	}
@@ -1266,9 +1286,7 @@ ReturnValue Game::internalMoveItem(Cylinder* fromCylinder, Cylinder* toCylinder,
 
 	if (moveItem && moveItem->getDuration() > 0) {
 		if (moveItem->getDecaying() != DECAYING_TRUE) {
-			moveItem->incrementReferenceCounter();
-			moveItem->setDecaying(DECAYING_TRUE);
-			toDecayItems.push_front(moveItem);
+			scheduleDecay(moveItem);
 		}
 	}
 
@@ -1366,9 +1384,7 @@ ReturnValue Game::internalAddItem(Cylinder* toCylinder, Item* item, int32_t inde
 
 	if (item->getDuration() > 0) {
 		if (item->getDecaying() != DECAYING_TRUE) {
-			item->incrementReferenceCounter();
-			item->setDecaying(DECAYING_TRUE);
-			toDecayItems.push_front(item);
+			scheduleDecay(item);
 		}
 	}
 
@@ -1411,9 +1427,7 @@ ReturnValue Game::internalRemoveItem(Item* item, int32_t count /*= -1*/, bool te
 
 		if (item->isRemoved()) {
 			item->onRemoved();
-			if (item->canDecay()) {
-				decayItems->remove(item);
-			}
+			unscheduleDecay(item);
 			ReleaseItem(item);
 		}
 
@@ -1447,6 +1461,14 @@ Item* Game::findItemOfType(Cylinder* cylinder, uint16_t itemId,
 		return nullptr;
 	}
 
+	// players know what they carry without searching
+	if (depthSearch && subType == -1) {
+		const Creature* creature = cylinder->getCreature();
+		if (creature && creature->getPlayer() && cylinder->getItemTypeCount(itemId) == 0) {
+			return nullptr;
+		}
+	}
+
 	std::vector<Container*> containers;
 	for (size_t i = cylinder->getFirstIndex(), j = cylinder->getLastIndex(); i < j; ++i) {
 		Thing* thing = cylinder->getThing(i);
@@ -1647,6 +1669,9 @@ Item* Game::transformItem(Item* item, uint16_t newId, int32_t newCount /*= -1*/)
 		}
 
 		newParent->postAddNotification(item, cylinder, newParent->getThingIndex(item));
+		if (!item->canDecay()) {
+			unscheduleDecay(item);
+		}
 		return item;
 	}
 
@@ -1702,6 +1727,12 @@ Item* Game::transformItem(Item* item, uint16_t newId, int32_t newCount /*= -1*/)
 
 			cylinder->updateThing(item, itemId, count);
 			cylinder->postAddNotification(item, cylinder, itemIndex);
+
+			// e.g. a ring taken off or a lamp switched off: its stopduration
+			// type pauses the countdown with the time left kept
+			if (!item->canDecay()) {
+				unscheduleDecay(item);
+			}
 			return item;
 		}
 	}
@@ -1727,9 +1758,7 @@ Item* Game::transformItem(Item* item, uint16_t newId, int32_t newCount /*= -1*/)
 
 	if (newItem->getDuration() > 0) {
 		if (newItem->getDecaying() != DECAYING_TRUE) {
-			newItem->incrementReferenceCounter();
-			newItem->setDecaying(DECAYING_TRUE);
-			toDecayItems.push_front(newItem);
+			scheduleDecay(newItem);
 		}
 	}
 
@@ -3655,6 +3684,60 @@ void Game::checkCreatureWalk(uint32_t creatureId) {
 	}
 }
 
+uint32_t Game::scheduleCreatureWalk(uint32_t creatureId, int64_t delay) {
+	if (++lastWalkId == 0) {
+		lastWalkId = 1;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	const auto due = now + std::chrono::milliseconds(delay);
+	pendingWalks.push({due, creatureId, lastWalkId});
+
+	// checkCreatureWalks arms the event itself once the batch is done
+	if (!checkingWalks && (walkEvent == 0 || due < walkEventDue)) {
+		armWalkEvent(due, now);
+	}
+	return lastWalkId;
+}
+
+void Game::armWalkEvent(std::chrono::steady_clock::time_point due, std::chrono::steady_clock::time_point now) {
+	// a stopped event may already be waiting on the dispatcher, the
+	// generation tells it apart from the one armed now
+	g_scheduler.stopEvent(walkEvent);
+	walkEventDue = due;
+
+	const auto delay = std::chrono::ceil<std::chrono::milliseconds>(due - now).count();
+	walkEvent = g_scheduler.addEvent(createSchedulerTask(std::max<int64_t>(0, delay), [this, generation = ++walkEventGeneration]() {
+		if (generation == walkEventGeneration) {
+			checkCreatureWalks();
+		}
+	}));
+}
+
+void Game::checkCreatureWalks() {
+	walkEvent = 0;
+	checkingWalks = true;
+
+	const auto now = std::chrono::steady_clock::now();
+	while (!pendingWalks.empty() && pendingWalks.top().due <= now) {
+		const PendingWalk walk = pendingWalks.top();
+		pendingWalks.pop();
+
+		// stopped or rescheduled since, as a cancelled scheduler event would be
+		Creature* creature = getCreatureByID(walk.creatureId);
+		if (creature && creature->eventWalk == walk.walkId && !creature->isDead()) {
+			creature->onWalk();
+		}
+	}
+
+	checkingWalks = false;
+	cleanup();
+
+	if (!pendingWalks.empty()) {
+		armWalkEvent(pendingWalks.top().due, now);
+	}
+}
+
 void Game::updateCreatureWalk(uint32_t creatureId) {
 	Creature* creature = getCreatureByID(creatureId);
 	if (creature && !creature->isDead()) {
@@ -3688,6 +3771,26 @@ void Game::removeCreatureCheck(Creature* creature) {
 	}
 }
 
+CreatureCheckStats Game::getCreatureCheckStats() const {
+	CreatureCheckStats stats;
+	for (const auto& checkCreatureList : checkCreatureLists) {
+		for (const Creature* creature : checkCreatureList) {
+			if (creature->creatureCheck) {
+				++stats.active;
+			}
+		}
+	}
+
+	for (const auto& it : monsters) {
+		if (it.second->getIdleStatus()) {
+			++stats.idleMonsters;
+		} else {
+			++stats.activeMonsters;
+		}
+	}
+	return stats;
+}
+
 void Game::checkCreatures(size_t index) {
 	g_scheduler.addEvent(createSchedulerTask(EVENT_CHECK_CREATURE_INTERVAL, [=, this]() {
 		checkCreatures((index + 1) % EVENT_CREATURECOUNT);
@@ -3714,6 +3817,134 @@ void Game::checkCreatures(size_t index) {
 	cleanup();
 }
 
+namespace {
+
+// Off-map creature for Game::benchmarkConditions.
+class BenchmarkCreature final : public Creature {
+	public:
+		const std::string& getName() const override {
+			return name;
+		}
+		const std::string& getNameDescription() const override {
+			return name;
+		}
+		std::string getDescription(int32_t) const override {
+			return name;
+		}
+		CreatureType_t getType() const override {
+			return CREATURETYPE_MONSTER;
+		}
+		void setID() override {}
+		void removeList() override {}
+		void addList() override {}
+		void goToFollowCreature() override {}
+
+	private:
+		const std::string name = "benchmark";
+};
+
+} // namespace
+
+ConditionBenchmark Game::benchmarkConditions(size_t creatureCount, size_t rounds) {
+	ConditionBenchmark result;
+	result.creatures = creatureCount;
+	result.rounds = rounds;
+
+	// Generic conditions of each type: the speed, healing and damage they apply
+	// need a creature on the map, and both loops run the same condition code.
+	const int32_t ticks = static_cast<int32_t>(std::min<size_t>(rounds * 2 + 1, 1000000)) * EVENT_CREATURE_THINK_INTERVAL;
+	std::vector<std::unique_ptr<BenchmarkCreature>> creatures;
+	creatures.reserve(creatureCount);
+	for (size_t i = 0; i < creatureCount; ++i) {
+		Creature& creature = *creatures.emplace_back(std::make_unique<BenchmarkCreature>());
+		for (ConditionType_t type : {CONDITION_HASTE, CONDITION_REGENERATION, CONDITION_POISON}) {
+			Condition* condition = new ConditionGeneric(CONDITIONID_COMBAT, type, ticks);
+			condition->setTicks(ticks);
+			creature.conditions.push_back(condition);
+		}
+		result.conditions += creature.conditions.size();
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t round = 0; round < rounds; ++round) {
+		for (const auto& creature : creatures) {
+			creature->executeConditions(EVENT_CREATURE_THINK_INTERVAL);
+		}
+	}
+	result.micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+	// the copy of the list and the lookups around every condition that executeConditions used to make
+	start = std::chrono::steady_clock::now();
+	for (size_t round = 0; round < rounds; ++round) {
+		for (const auto& benchmarkCreature : creatures) {
+			Creature& creature = *benchmarkCreature;
+			std::list<Condition*> tempConditions{creature.conditions.begin(), creature.conditions.end()};
+			for (Condition* condition : tempConditions) {
+				if (std::find(creature.conditions.begin(), creature.conditions.end(), condition) == creature.conditions.end()) {
+					continue;
+				}
+
+				if (!condition->executeCondition(&creature, EVENT_CREATURE_THINK_INTERVAL)) {
+					creature.removeCondition(condition, true);
+				}
+			}
+		}
+	}
+	result.legacyMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+	// deleted without ending them, they never started
+	for (const auto& creature : creatures) {
+		for (Condition* condition : creature->conditions) {
+			delete condition;
+		}
+		creature->conditions.clear();
+	}
+	return result;
+}
+
+MonsterThinkBenchmark Game::benchmarkMonsterThink(const Position& center, const std::string& monsterName, size_t monsterCount, size_t rounds) {
+	MonsterThinkBenchmark result;
+	result.rounds = rounds;
+
+	std::vector<Monster*> monsters;
+	monsters.reserve(monsterCount);
+	for (size_t i = 0; i < monsterCount; ++i) {
+		Monster* monster = Monster::createMonster(monsterName);
+		if (!monster) {
+			break;
+		}
+
+		if (!placeCreature(monster, center, true, true, CONST_ME_NONE)) {
+			delete monster;
+			break;
+		}
+
+		// held so a monster removed while thinking stays valid until the end
+		monster->incrementReferenceCounter();
+		monsters.push_back(monster);
+	}
+	result.monsters = monsters.size();
+
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t round = 0; round < rounds; ++round) {
+		for (Monster* monster : monsters) {
+			if (!monster->isRemoved()) {
+				monster->onThink(EVENT_CREATURE_THINK_INTERVAL);
+				++result.thinks;
+			}
+		}
+	}
+	result.micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+	for (Monster* monster : monsters) {
+		if (!monster->isRemoved()) {
+			removeCreature(monster, false);
+		}
+		monster->decrementReferenceCounter();
+	}
+	return result;
+}
+
 void Game::updateCreaturesPath(size_t index) {
 	g_scheduler.addEvent(createSchedulerTask(getNumber(ConfigManager::PATHFINDING_INTERVAL), [=, this]() {
 		updateCreaturesPath((index + 1) % EVENT_CREATURECOUNT);
@@ -4459,16 +4690,13 @@ void Game::setAccountStorageValue(const uint32_t accountId, const uint32_t key,
 		return;
 	}
 
-	accountStorageMap[accountId][key] = value;
+	accountStorageMap[accountId].set(key, value);
 }
 
 int32_t Game::getAccountStorageValue(const uint32_t accountId, const uint32_t key) const {
 	const auto& accountMapIt = accountStorageMap.find(accountId);
 	if (accountMapIt != accountStorageMap.end()) {
-		const auto& storageMapIt = accountMapIt->second.find(key);
-		if (storageMapIt != accountMapIt->second.end()) {
-			return storageMapIt->second;
-		}
+		return accountMapIt->second.get(key).value_or(-1);
 	}
 	return -1;
 }
@@ -4479,41 +4707,39 @@ void Game::loadAccountStorageValues() {
 	DBResult_ptr result;
 	if ((result = db.storeQuery("SELECT `account_id`, `key`, `value` FROM `account_storage`"))) {
 		do {
-			g_game.setAccountStorageValue(result->getNumber<uint32_t>("account_id"), result->getNumber<uint32_t>("key"), result->getNumber<int32_t>("value"));
+			StorageMap& storage = accountStorageMap[result->getNumber<uint32_t>("account_id")];
+			const uint32_t key = result->getNumber<uint32_t>("key");
+			const int32_t value = result->getNumber<int32_t>("value");
+			storage.set(key, value);
+			storage.setSaved(key, value);
 		} while (result->next());
 	}
 }
 
-bool Game::saveAccountStorageValues() const {
-	DBTransaction transaction;
-	Database& db = Database::getInstance();
-
-	if (!transaction.begin()) {
-		return false;
+bool Game::saveAccountStorageValues() {
+	if (std::none_of(accountStorageMap.begin(), accountStorageMap.end(), [](const auto& it) { return it.second.isDirty(); })) {
+		return true;
 	}
 
-	if (!db.executeQuery("DELETE FROM `account_storage`")) {
+	DBTransaction transaction;
+	if (!transaction.begin()) {
 		return false;
 	}
 
-	for (const auto& accountIt : g_game.accountStorageMap) {
-		if (accountIt.second.empty()) {
-			continue;
-		}
-
-		DBInsert accountStorageQuery("INSERT INTO `account_storage` (`account_id`, `key`, `value`) VALUES");
-		for (const auto& storageIt : accountIt.second) {
-			if (!accountStorageQuery.addRow(fmt::format("{:d}, {:d}, {:d}", accountIt.first, storageIt.first, storageIt.second))) {
-				return false;
-			}
-		}
-
-		if (!accountStorageQuery.execute()) {
+	for (const auto& [accountId, storage] : accountStorageMap) {
+		if (!IOLoginData::saveStorage(storage, "account_storage", "account_id", accountId)) {
 			return false;
 		}
 	}
 
-	return transaction.commit();
+	if (!transaction.commit()) {
+		return false;
+	}
+
+	for (auto& it : accountStorageMap) {
+		it.second.markSaved();
+	}
+	return true;
 }
 
 void Game::startDecay(Item* item) {
@@ -4527,9 +4753,7 @@ void Game::startDecay(Item* item) {
 	}
 
 	if (item->getDuration() > 0) {
-		item->incrementReferenceCounter();
-		item->setDecaying(DECAYING_TRUE);
-		toDecayItems.push_front(item);
+		scheduleDecay(item);
 	} else {
 		internalDecayItem(item);
 	}
@@ -4547,48 +4771,125 @@ void Game::internalDecayItem(Item* item) {
 	}
 }
 
+void Game::scheduleDecay(Item* item) {
+	item->setDecaying(DECAYING_TRUE);
+
+	const int64_t deadline = OTSYS_TIME() + item->getDuration();
+	if (item->decayIndex != Item::DECAY_INDEX_NONE) {
+		setDecayDeadline(item, deadline);
+		return;
+	}
+
+	item->incrementReferenceCounter();
+	item->decayDeadline = deadline;
+	item->decayIndex = decayHeap.size();
+	decayHeap.push_back(item);
+	siftDecayUp(item->decayIndex);
+}
+
+void Game::setDecayDeadline(Item* item, int64_t deadline) {
+	const int64_t previous = item->decayDeadline;
+	item->decayDeadline = deadline;
+	if (deadline < previous) {
+		siftDecayUp(item->decayIndex);
+	} else {
+		siftDecayDown(item->decayIndex);
+	}
+}
+
+void Game::unscheduleDecay(Item* item) {
+	const size_t index = item->decayIndex;
+	if (index == Item::DECAY_INDEX_NONE) {
+		return;
+	}
+
+	// keep what was left so a saved or re-added item resumes from there
+	if (item->hasAttribute(ITEM_ATTRIBUTE_DURATION)) {
+		item->setIntAttr(ITEM_ATTRIBUTE_DURATION, item->getDuration());
+	}
+	item->setDecaying(DECAYING_FALSE);
+	item->decayIndex = Item::DECAY_INDEX_NONE;
+
+	Item* last = decayHeap.back();
+	decayHeap.pop_back();
+	if (last != item) {
+		decayHeap[index] = last;
+		last->decayIndex = index;
+		siftDecayUp(index);
+		siftDecayDown(last->decayIndex);
+	}
+	ReleaseItem(item);
+}
+
+void Game::siftDecayUp(size_t index) {
+	Item* item = decayHeap[index];
+	while (index > 0) {
+		const size_t parent = (index - 1) / 2;
+		if (decayHeap[parent]->decayDeadline <= item->decayDeadline) {
+			break;
+		}
+
+		decayHeap[index] = decayHeap[parent];
+		decayHeap[index]->decayIndex = index;
+		index = parent;
+	}
+	decayHeap[index] = item;
+	item->decayIndex = index;
+}
+
+void Game::siftDecayDown(size_t index) {
+	Item* item = decayHeap[index];
+	const size_t size = decayHeap.size();
+	while (true) {
+		size_t child = index * 2 + 1;
+		if (child >= size) {
+			break;
+		}
+
+		if (child + 1 < size && decayHeap[child + 1]->decayDeadline < decayHeap[child]->decayDeadline) {
+			++child;
+		}
+
+		if (item->decayDeadline <= decayHeap[child]->decayDeadline) {
+			break;
+		}
+
+		decayHeap[index] = decayHeap[child];
+		decayHeap[index]->decayIndex = index;
+		index = child;
+	}
+	decayHeap[index] = item;
+	item->decayIndex = index;
+}
+
 void Game::checkDecay() {
         g_scheduler.addEvent(createSchedulerTask(EVENT_DECAYINTERVAL, [this]() {
                 checkDecay();
         }));
 
-	size_t bucket = (lastBucket + 1) % EVENT_DECAY_BUCKETS;
+	// only items whose deadline passed are touched, the rest of the heap
+	// is not even read
+	const int64_t now = OTSYS_TIME();
+	while (!decayHeap.empty() && decayHeap.front()->decayDeadline <= now) {
+		Item* item = decayHeap.front();
+		item->decayIndex = Item::DECAY_INDEX_NONE;
 
-	auto it = decayItems[bucket].begin(), end = decayItems[bucket].end();
-	while (it != end) {
-		Item* item = *it;
-		if (!item->canDecay()) {
-			item->setDecaying(DECAYING_FALSE);
-			ReleaseItem(item);
-			it = decayItems[bucket].erase(it);
-			continue;
+		Item* last = decayHeap.back();
+		decayHeap.pop_back();
+		if (last != item) {
+			decayHeap.front() = last;
+			siftDecayDown(0);
 		}
 
-		int32_t duration = item->getDuration();
-		int32_t decreaseTime = std::min<int32_t>(EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS, duration);
-
-		duration -= decreaseTime;
-		item->decreaseDuration(decreaseTime);
-
-		if (duration <= 0) {
-			it = decayItems[bucket].erase(it);
-			internalDecayItem(item);
-			ReleaseItem(item);
-		} else if (duration < EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS) {
-			it = decayItems[bucket].erase(it);
-			size_t newBucket = (bucket + ((duration + EVENT_DECAYINTERVAL / 2) / 1000)) % EVENT_DECAY_BUCKETS;
-			if (newBucket == bucket) {
-				internalDecayItem(item);
-				ReleaseItem(item);
-			} else {
-				decayItems[newBucket].push_back(item);
-			}
+		if (!item->canDecay()) {
+			item->setDecaying(DECAYING_FALSE);
 		} else {
-			++it;
+			item->setIntAttr(ITEM_ATTRIBUTE_DURATION, 0);
+			internalDecayItem(item);
 		}
+		ReleaseItem(item);
 	}
 
-	lastBucket = bucket;
         cleanup();
 }
 
@@ -4654,6 +4955,7 @@ void Game::shutdown() {
 
         g_scheduler.shutdown();
         g_databaseTasks.shutdown();
+        g_playerJournal.shutdown();
         g_dispatcher.shutdown();
 	map.spawns.clear();
 
@@ -4679,16 +4981,6 @@ void Game::cleanup() {
 		item->decrementReferenceCounter();
 	}
 	ToReleaseItems.clear();
-
-	for (Item* item : toDecayItems) {
-		const uint32_t dur = item->getDuration();
-		if (dur >= EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS) {
-			decayItems[lastBucket].push_back(item);
-		} else {
-			decayItems[(lastBucket + 1 + dur / 1000) % EVENT_DECAY_BUCKETS].push_back(item);
-		}
-	}
-	toDecayItems.clear();
 }
 
 void Game::ReleaseCreature(Creature* creature) {
@@ -5190,7 +5482,7 @@ void Game::playerCreateMarketOffer(uint32_t playerId, uint8_t type, uint16_t spr
 		const auto debitCash = std::min(playerMoney, fee);
 		const auto debitBank = fee - debitCash;
 		removeMoney(player, debitCash);
-		player->bankBalance -= debitBank;
+		player->setBankBalance(player->getBankBalance() - debitBank);
 	} else {
 		uint64_t totalPrice = static_cast<uint64_t>(price) * amount;
 		totalPrice += fee;
@@ -5201,10 +5493,10 @@ void Game::playerCreateMarketOffer(uint32_t playerId, uint8_t type, uint16_t spr
 		const auto debitCash = std::min(playerMoney, totalPrice);
 		const auto debitBank = totalPrice - debitCash;
 		removeMoney(player, debitCash);
-		player->bankBalance -= debitBank;
+		player->setBankBalance(player->getBankBalance() - debitBank);
 	}
 
-	IOMarket::createOffer(player->getGUID(), static_cast<MarketAction_t>(type), it.id, amount, price, anonymous);
+	IOMarket::createOffer(player->getGUID(), player->getName(), static_cast<MarketAction_t>(type), it.id, amount, price, anonymous);
 
 	player->sendMarketEnter(player->getLastDepotId());
 	const MarketOfferList& buyOffers = IOMarket::getActiveOffers(MARKETACTION_BUY, it.id);
@@ -5228,7 +5520,7 @@ void Game::playerCancelMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 	}
 
 	if (offer.type == MARKETACTION_BUY) {
-		player->bankBalance += static_cast<uint64_t>(offer.price) * offer.amount;
+		player->setBankBalance(player->getBankBalance() + static_cast<uint64_t>(offer.price) * offer.amount);
 		player->sendMarketEnter(player->getLastDepotId());
 	} else {
 		const ItemType& it = Item::items[offer.itemId];
@@ -5347,7 +5639,7 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 			}
 		}
 
-		player->bankBalance += totalPrice;
+		player->setBankBalance(player->getBankBalance() + totalPrice);
 
 		if (it.stackable) {
 			uint16_t tmpAmount = amount;
@@ -5393,7 +5685,7 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 		const auto debitCash = std::min(playerMoney, totalPrice);
 		const auto debitBank = totalPrice - debitCash;
 		removeMoney(player, debitCash);
-		player->bankBalance -= debitBank;
+		player->setBankBalance(player->getBankBalance() - debitBank);
 
 		if (it.stackable) {
 			uint16_t tmpAmount = amount;
@@ -5426,7 +5718,7 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 
 		Player* sellerPlayer = getPlayerByGUID(offer.playerId);
 		if (sellerPlayer) {
-			sellerPlayer->bankBalance += totalPrice;
+			sellerPlayer->setBankBalance(sellerPlayer->getBankBalance() + totalPrice);
 		} else {
 			IOLoginData::increaseBankBalance(offer.playerId, totalPrice);
 		}
@@ -5718,7 +6010,7 @@ bool Game::reload(ReloadTypes_t reloadType) {
 		case RELOAD_TYPE_MOUNTS: return mounts.reload();
 		case RELOAD_TYPE_MOVEMENTS: return g_moveEvents->reload();
 		case RELOAD_TYPE_NPCS: {
-			Npcs::reload();
+			g_npcs->reload();
 			return true;
 		}
 
@@ -5756,7 +6048,7 @@ bool Game::reload(ReloadTypes_t reloadType) {
 			g_scripts->loadScripts("scripts", false, true);
 			g_creatureEvents->removeInvalidEvents();
 			/*
-			Npcs::reload();
+			g_npcs->reload();
 			Item::items.reload();
 			quests.reload();
 			mounts.reload();
@@ -5781,7 +6073,7 @@ bool Game::reload(ReloadTypes_t reloadType) {
 			g_creatureEvents->reload();
 			g_monsters.reload();
 			g_moveEvents->reload();
-			Npcs::reload();
+			g_npcs->reload();
 			g_talkActions->reload();
 			Item::items.reload();
 			g_weapons->reload();
@@ -45,7 +45,6 @@ static constexpr int32_t PLAYER_NAME_LENGTH = 25;
 static constexpr int32_t EVENT_LIGHTINTERVAL = 10000;
 static constexpr int32_t EVENT_WORLDTIMEINTERVAL = 2500;
 static constexpr int32_t EVENT_DECAYINTERVAL = 250;
-static constexpr int32_t EVENT_DECAY_BUCKETS = 4;
 
 static constexpr int32_t MOVE_CREATURE_INTERVAL = 1000;
 
@@ -62,6 +61,30 @@ static constexpr int32_t RANGE_REQUEST_TRADE_INTERVAL = 400;
 static constexpr uint8_t ITEM_STACK_SIZE = 100;
 static constexpr int32_t MAX_STACKPOS = 10;
 
+// Game::benchmarkConditions: condition passes over creatures carrying haste,
+// regeneration and poison, timed for executeConditions and the loop it replaced.
+struct ConditionBenchmark {
+	uint64_t creatures = 0;
+	uint64_t conditions = 0;
+	uint64_t rounds = 0;
+	uint64_t micros = 0;
+	uint64_t legacyMicros = 0;
+};
+
+struct CreatureCheckStats {
+	uint64_t active = 0; // in the check lists, thinking every cycle
+	uint64_t activeMonsters = 0;
+	uint64_t idleMonsters = 0;
+};
+
+// Game::benchmarkMonsterThink: think cycles of monsters packed around a spot.
+struct MonsterThinkBenchmark {
+	uint64_t monsters = 0;
+	uint64_t rounds = 0;
+	uint64_t thinks = 0;
+	uint64_t micros = 0;
+};
+
 /**
  * Main Game class.
  * This class is responsible to control everything that happens
@@ -214,6 +237,7 @@ class Game {
 		size_t getNpcsOnline() const {
 			return npcs.size();
 		}
+		CreatureCheckStats getCreatureCheckStats() const;
 		uint32_t getPlayersRecord() const {
 			return playersRecord;
 		}
@@ -432,10 +456,16 @@ class Game {
 
 		//Events
 		void checkCreatureWalk(uint32_t creatureId);
+		// Creature::addEventWalk: steps falling due together are taken in one
+		// dispatcher task instead of a scheduler event each
+		uint32_t scheduleCreatureWalk(uint32_t creatureId, int64_t delay);
+		void checkCreatureWalks();
 		void updateCreatureWalk(uint32_t creatureId);
 		void checkCreatureAttack(uint32_t creatureId);
                 void checkCreatures(size_t index);
                 void updateCreaturesPath(size_t index);
+                static ConditionBenchmark benchmarkConditions(size_t creatureCount, size_t rounds);
+                MonsterThinkBenchmark benchmarkMonsterThink(const Position& center, const std::string& monsterName, size_t monsterCount, size_t rounds);
                 void checkLight();
                 void checkPressure();
 
@@ -457,9 +487,15 @@ class Game {
 		void setAccountStorageValue(const uint32_t accountId, const uint32_t key, const int32_t value);
 		int32_t getAccountStorageValue(const uint32_t accountId, const uint32_t key) const;
 		void loadAccountStorageValues();
-		bool saveAccountStorageValues() const;
+		bool saveAccountStorageValues();
 
 		void startDecay(Item* item);
+		// queues an item with a duration for decay without checking canDecay,
+		// which is only checked once its deadline passes
+		void scheduleDecay(Item* item);
+		void setDecayDeadline(Item* item, int64_t deadline);
+		// takes an item out of the decay heap, keeping the time it had left
+		void unscheduleDecay(Item* item);
 
 		int16_t getWorldTime() { return worldTime; }
 		void updateWorldTime();
@@ -509,8 +545,6 @@ class Game {
 		Mounts mounts;
 		Quests quests;
 
-		std::forward_list<Item*> toDecayItems;
-
 		bool isTileInCleanList(Tile* tile) { return tilesToClean.find(tile) != tilesToClean.end(); }
 		std::unordered_set<Tile*> getTilesToClean() const {
 			return tilesToClean;
@@ -532,23 +566,41 @@ class Game {
 		bool playerSpeakTo(Player* player, SpeakClasses type, const std::string& receiver, const std::string& text);
 		void playerSpeakToNpc(Player* player, const std::string& text);
 
+		void armWalkEvent(std::chrono::steady_clock::time_point due, std::chrono::steady_clock::time_point now);
 		void checkDecay();
 		void internalDecayItem(Item* item);
+		void siftDecayUp(size_t index);
+		void siftDecayDown(size_t index);
 
 		std::unordered_map<uint32_t, Player*> players;
 		std::unordered_map<std::string, Player*> mappedPlayerNames;
 		std::unordered_map<uint32_t, Player*> mappedPlayerGuids;
 		std::unordered_map<uint32_t, Guild_ptr> guilds;
 		std::unordered_map<uint16_t, Item*> uniqueItems;
-		std::unordered_map<uint32_t, std::unordered_map<uint32_t, int32_t>> accountStorageMap;
+		std::unordered_map<uint32_t, StorageMap> accountStorageMap;
 
-		std::list<Item*> decayItems[EVENT_DECAY_BUCKETS];
+		// min-heap on Item::decayDeadline, each item knows its own index
+		std::vector<Item*> decayHeap;
 		std::list<Creature*> checkCreatureLists[EVENT_CREATURECOUNT];
 
 		std::vector<Creature*> ToReleaseCreatures;
 		std::vector<Item*> ToReleaseItems;
 
-		size_t lastBucket = 0;
+		struct PendingWalk {
+			std::chrono::steady_clock::time_point due;
+			uint32_t creatureId;
+			uint32_t walkId; // Creature::eventWalk, the step is dropped if it changed
+
+			bool operator>(const PendingWalk& other) const {
+				return due > other.due;
+			}
+		};
+		std::priority_queue<PendingWalk, std::vector<PendingWalk>, std::greater<>> pendingWalks;
+		std::chrono::steady_clock::time_point walkEventDue;
+		uint32_t walkEvent = 0;
+		uint32_t walkEventGeneration = 0;
+		uint32_t lastWalkId = 0;
+		bool checkingWalks = false;
 
 		WildcardTreeNode wildcardTree { false };
 
@@ -11,10 +11,283 @@
 #include "game/game.h"
 
 #include "inbox.h"
+#include "playerjournal.h"
 #include "storeinbox.h"
 
+#include <bit>
+
 extern Game g_game;
 
+namespace {
+
+// Order of the columns selected by PLAYER_QUERY; results are read by index.
+enum PlayerColumn : size_t {
+	PLAYER_ID,
+	PLAYER_NAME,
+	PLAYER_ACCOUNT_ID,
+	PLAYER_GROUP_ID,
+	PLAYER_SEX,
+	PLAYER_VOCATION,
+	PLAYER_EXPERIENCE,
+	PLAYER_LEVEL,
+	PLAYER_MAGLEVEL,
+	PLAYER_HEALTH,
+	PLAYER_HEALTHMAX,
+	PLAYER_BLESSINGS,
+	PLAYER_MANA,
+	PLAYER_MANAMAX,
+	PLAYER_MANASPENT,
+	PLAYER_SOUL,
+	PLAYER_LOOKBODY,
+	PLAYER_LOOKFEET,
+	PLAYER_LOOKHEAD,
+	PLAYER_LOOKLEGS,
+	PLAYER_LOOKTYPE,
+	PLAYER_LOOKADDONS,
+	PLAYER_CURRENTMOUNT,
+	PLAYER_POSX,
+	PLAYER_POSY,
+	PLAYER_POSZ,
+	PLAYER_CAP,
+	PLAYER_LASTLOGIN,
+	PLAYER_LASTLOGOUT,
+	PLAYER_LASTIP,
+	PLAYER_CONDITIONS,
+	PLAYER_SKULLTIME,
+	PLAYER_SKULL,
+	PLAYER_TOWN_ID,
+	PLAYER_BALANCE,
+	PLAYER_OFFLINETRAINING_TIME,
+	PLAYER_OFFLINETRAINING_SKILL,
+	PLAYER_STAMINA,
+	PLAYER_SKILL_FIST, // level and tries of each skill follow in SKILL_FIST..SKILL_FISHING order
+	PLAYER_DIRECTION = PLAYER_SKILL_FIST + 2 * (SKILL_FISHING + 1),
+};
+
+constexpr std::string_view PLAYER_QUERY = "SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `currentmount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE ";
+
+// Order of the columns of the item tables: `pid`, `sid`, `itemtype`, `count`, `attributes`.
+enum ItemColumn : size_t {
+	ITEM_PID,
+	ITEM_SID,
+	ITEM_ITEMTYPE,
+	ITEM_COUNT,
+	ITEM_ATTRIBUTES,
+};
+
+std::atomic<uint64_t> itemRowsLoaded{0};
+std::atomic<uint64_t> itemLoadMicros{0};
+std::atomic<uint64_t> itemRowsSaved{0};
+std::atomic<uint64_t> itemSaveMicros{0};
+std::atomic<uint64_t> itemBlobsLoaded{0};
+std::atomic<uint64_t> itemBlobsSaved{0};
+std::atomic<uint64_t> itemBlobBytesSaved{0};
+
+uint64_t elapsedMicros(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// dispatcher thread only, like every save
+PlayerSaveStats playerSaveStats;
+
+// Calls fn(first, count) over [0, size) in power-of-two chunks of at most 128,
+// so IN lists only take a handful of shapes and their prepared statements get reused.
+template <typename Function>
+bool forEachInChunk(size_t size, Function&& fn) {
+	for (size_t first = 0; first < size;) {
+		const size_t count = std::bit_floor(std::min<size_t>(size - first, 128));
+		if (!fn(first, count)) {
+			return false;
+		}
+		first += count;
+	}
+	return true;
+}
+
+std::string makeInList(size_t count) {
+	std::string list = "(?";
+	for (size_t i = 1; i < count; ++i) {
+		list.append(",?");
+	}
+	list.push_back(')');
+	return list;
+}
+
+bool deletePlayerRows(Database& db, std::string_view table, const std::vector<uint32_t>& guids) {
+	return forEachInChunk(guids.size(), [&](size_t first, size_t count) {
+		return db.executeStatement(fmt::format("DELETE FROM `{:s}` WHERE `player_id` IN {:s}", table, makeInList(count)), DBParams(guids.begin() + first, guids.begin() + first + count));
+	});
+}
+
+constexpr std::string_view STORAGE_INSERT_SUFFIX = " ON DUPLICATE KEY UPDATE `value` = VALUES(`value`)";
+
+std::string makeStorageInsert(std::string_view table, std::string_view ownerColumn) {
+	return fmt::format("INSERT INTO `{:s}` (`{:s}`, `key`, `value`) VALUES ", table, ownerColumn);
+}
+
+bool deleteStorage(const StorageMap& storage, std::string_view table, std::string_view ownerColumn, uint32_t ownerId) {
+	std::vector<uint32_t> removed;
+	storage.forEachRemoved([&removed](uint32_t key) { removed.push_back(key); });
+
+	Database& db = Database::getInstance();
+	return forEachInChunk(removed.size(), [&](size_t first, size_t count) {
+		DBParams params;
+		params.reserve(count + 1);
+		params.emplace_back(ownerId);
+		params.insert(params.end(), removed.begin() + first, removed.begin() + first + count);
+		return db.executeStatement(fmt::format("DELETE FROM `{:s}` WHERE `{:s}` = ? AND `key` IN {:s}", table, ownerColumn, makeInList(count)), params);
+	});
+}
+
+bool addStorageRows(const StorageMap& storage, uint32_t ownerId, DBStatementInsert& storageQuery) {
+	bool success = true;
+	storage.forEachChanged([&](uint32_t key, int32_t value) {
+		success = success && storageQuery.addRow({ownerId, key, value});
+	});
+	return success;
+}
+
+std::string makeItemInsert(std::string_view table) {
+	return fmt::format("INSERT INTO `{:s}` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ", table);
+}
+
+constexpr std::string_view ITEM_BLOB_INSERT = "INSERT INTO `player_itemblobs` (`player_id`, `section`, `items`, `data`) VALUES ";
+
+bool deleteItemBlobs(Database& db, PlayerItemTable table, const std::vector<uint32_t>& guids) {
+	return forEachInChunk(guids.size(), [&](size_t first, size_t count) {
+		DBParams params;
+		params.reserve(count + 1);
+		params.emplace_back(static_cast<uint8_t>(table));
+		params.insert(params.end(), guids.begin() + first, guids.begin() + first + count);
+		return db.executeStatement(fmt::format("DELETE FROM `player_itemblobs` WHERE `section` = ? AND `player_id` IN {:s}", makeInList(count)), params);
+	});
+}
+
+bool addItemBlob(DBStatementInsert& blobQuery, uint32_t guid, PlayerItemTable table, const ItemBlob& blob) {
+	std::string data = blob.encode(getBoolean(ConfigManager::ITEM_BLOB_COMPRESSION));
+	if (data.empty()) {
+		std::cout << "[Error - addItemBlob] Items of player " << guid << " exceed the item blob size limit" << std::endl;
+		return false;
+	}
+
+	itemBlobsSaved.fetch_add(1, std::memory_order_relaxed);
+	itemBlobBytesSaved.fetch_add(data.size(), std::memory_order_relaxed);
+	return blobQuery.addRow({guid, static_cast<uint8_t>(table), blob.getRowCount(), DBParam::blob(std::move(data))});
+}
+
+// blob of each section that has one; the views point into the result
+ItemBlobSections getItemBlobSections(const DBStatementResult_ptr& result) {
+	ItemBlobSections blobs;
+	if (result) {
+		do {
+			const uint8_t section = result->getNumber<uint8_t>(0);
+			if (section <= PLAYER_ITEMS_LAST) {
+				blobs[section] = result->getString(1);
+			}
+		} while (result->next());
+	}
+	return blobs;
+}
+
+void readItemRows(const DBStatementResult_ptr& result, ItemRowList& rows) {
+	rows.clear();
+	if (!result) {
+		return;
+	}
+
+	rows.reserve(result->getRowCount());
+	do {
+		ItemRow& row = rows.emplace_back();
+		row.pid = result->getNumber<int32_t>(ITEM_PID);
+		row.sid = result->getNumber<int32_t>(ITEM_SID);
+		row.itemType = result->getNumber<uint16_t>(ITEM_ITEMTYPE);
+		row.count = result->getNumber<uint16_t>(ITEM_COUNT);
+		row.attributes = result->getString(ITEM_ATTRIBUTES);
+	} while (result->next());
+}
+
+// Rows of one section from its blob if it has one, otherwise from its row table.
+bool readItemSection(std::string_view blob, const DBStatementResult_ptr& result, std::string& buffer, ItemRowList& rows) {
+	if (blob.empty()) {
+		readItemRows(result, rows);
+		return true;
+	}
+
+	itemBlobsLoaded.fetch_add(1, std::memory_order_relaxed);
+	return ItemBlob::decode(blob, buffer, rows);
+}
+
+DBStatementResult_ptr selectItemRows(Database& db, PlayerItemTable table, uint32_t guid) {
+	return db.storeStatement(fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `{:s}` WHERE `player_id` = ? ORDER BY `sid` DESC", IOLoginData::getItemTableName(table)), {guid});
+}
+
+constexpr size_t ACCOUNT_CACHE_SIZE = 4096;
+constexpr size_t PLAYER_CACHE_SIZE = 16384;
+
+// Identity of a character as needed by name/guid lookups (VIP lists, house lists, market).
+struct CachedPlayer {
+	std::string name;
+	uint32_t guid;
+	uint32_t accountId;
+	uint16_t groupId;
+};
+
+using CachedPlayer_ptr = std::shared_ptr<const CachedPlayer>;
+
+// account and character names compare case-insensitively in the database, so the keys do too
+LRUCache<std::string, std::shared_ptr<const LoginAccount>> accountCache{ACCOUNT_CACHE_SIZE};
+LRUCache<uint32_t, CachedPlayer_ptr> playerByIdCache{PLAYER_CACHE_SIZE};
+LRUCache<std::string, CachedPlayer_ptr> playerByNameCache{PLAYER_CACHE_SIZE};
+
+void cachePlayer(CachedPlayer_ptr player) {
+	const int64_t ttl = getNumber(ConfigManager::PLAYER_CACHE_TTL);
+	if (ttl <= 0) {
+		return;
+	}
+
+	std::string name = boost::algorithm::to_lower_copy(player->name);
+	if (auto previous = playerByIdCache.peek(player->guid)) {
+		// renamed; the old name must not keep resolving to this character
+		std::string previousName = boost::algorithm::to_lower_copy((*previous)->name);
+		if (previousName != name) {
+			playerByNameCache.erase(previousName);
+		}
+	}
+
+	playerByNameCache.put(std::move(name), player, std::chrono::seconds(ttl));
+	playerByIdCache.put(player->guid, std::move(player), std::chrono::seconds(ttl));
+}
+
+CachedPlayer_ptr loadCachedPlayer(const DBStatementResult_ptr& result) {
+	if (!result) {
+		return nullptr;
+	}
+
+	auto player = std::make_shared<CachedPlayer>();
+	player->guid = result->getNumber<uint32_t>(0);
+	player->name = result->getString(1);
+	player->accountId = result->getNumber<uint32_t>(2);
+	player->groupId = result->getNumber<uint16_t>(3);
+	cachePlayer(player);
+	return player;
+}
+
+CachedPlayer_ptr getCachedPlayer(uint32_t guid) {
+	if (auto player = playerByIdCache.get(guid)) {
+		return *player;
+	}
+	return loadCachedPlayer(Database::getInstance().storeStatement("SELECT `id`, `name`, `account_id`, `group_id` FROM `players` WHERE `id` = ?", {guid}));
+}
+
+CachedPlayer_ptr getCachedPlayer(const std::string& name) {
+	if (auto player = playerByNameCache.get(boost::algorithm::to_lower_copy(name))) {
+		return *player;
+	}
+	return loadCachedPlayer(Database::getInstance().storeStatement("SELECT `id`, `name`, `account_id`, `group_id` FROM `players` WHERE `name` = ?", {name}));
+}
+
+} // namespace
+
 std::string decodeSecret(std::string_view secret) {
 	// simple base32 decoding
 	std::string key;
@@ -43,15 +316,46 @@ std::string decodeSecret(std::string_view secret) {
 	return key;
 }
 
-std::pair<uint32_t, std::string> IOLoginData::gameworldAuthentication(std::string_view accountName, std::string_view password, std::string_view characterName, std::string_view token, uint32_t tokenTime) {
+std::shared_ptr<const LoginAccount> IOLoginData::getLoginAccount(std::string_view accountName) {
+	std::string key = boost::algorithm::to_lower_copy(std::string{accountName});
+	if (auto account = accountCache.get(key)) {
+		return *account;
+	}
+
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id`, UNHEX(`password`) AS `password`, `secret` FROM `accounts` WHERE `name` = {:s}", db.escapeString(accountName)));
+	DBStatementResult_ptr result = db.storeStatement("SELECT `id`, UNHEX(`password`), `secret`, `premium_ends_at` FROM `accounts` WHERE `name` = ?", {accountName});
 	if (!result) {
+		return nullptr;
+	}
+
+	auto account = std::make_shared<LoginAccount>();
+	account->id = result->getNumber<uint32_t>(0);
+	account->password = result->getString(1);
+	account->secret = decodeSecret(result->getString(2));
+	account->premiumEndsAt = result->getNumber<time_t>(3);
+
+	if ((result = db.storeStatement("SELECT `name` FROM `players` WHERE `account_id` = ? AND `deletion` = 0 ORDER BY `name` ASC", {account->id}))) {
+		account->characters.reserve(result->getRowCount());
+		do {
+			account->characters.emplace_back(result->getString(0));
+		} while (result->next());
+	}
+
+	const int64_t ttl = getNumber(ConfigManager::ACCOUNT_CACHE_TTL);
+	if (ttl > 0) {
+		accountCache.put(std::move(key), account, std::chrono::seconds(ttl));
+	}
+	return account;
+}
+
+std::pair<uint32_t, std::string> IOLoginData::gameworldAuthentication(std::string_view accountName, std::string_view password, std::string_view characterName, std::string_view token, uint32_t tokenTime) {
+	auto account = getLoginAccount(accountName);
+	if (!account) {
 		return std::make_pair(0, std::string{characterName});
 	}
 
-	std::string secret = decodeSecret(result->getString("secret"));
+	const std::string& secret = account->secret;
 	if (!secret.empty()) {
 		if (token.empty()) {
 			return std::make_pair(0, std::string{characterName});
@@ -63,38 +367,26 @@ std::pair<uint32_t, std::string> IOLoginData::gameworldAuthentication(std::strin
 		}
 	}
 
-	if (transformToSHA1(password) != result->getString("password")) {
+	if (transformToSHA1(password) != account->password) {
 		return std::make_pair(0, std::string{characterName});
 	}
 
-	uint32_t accountId = result->getNumber<uint32_t>("id");
-
-	result = db.storeQuery(fmt::format("SELECT `name` FROM `players` WHERE `name` = {:s} AND `account_id` = {:d} AND `deletion` = 0", db.escapeString(characterName), accountId));
-	if (!result) {
-		return std::make_pair(0, std::string{characterName});
+	for (const std::string& name : account->characters) {
+		if (caseInsensitiveEqual(name, characterName)) {
+			return std::make_pair(account->id, name);
+		}
 	}
-
-	return std::make_pair(accountId, std::string{result->getString("name")});
+	return std::make_pair(0, std::string{characterName});
 }
 
 uint32_t IOLoginData::getAccountIdByPlayerName(const std::string& playerName) {
-	Database& db = Database::getInstance();
-
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `account_id` FROM `players` WHERE `name` = {:s}", db.escapeString(playerName)));
-	if (!result) {
-		return 0;
-	}
-	return result->getNumber<uint32_t>("account_id");
+	auto player = getCachedPlayer(playerName);
+	return player ? player->accountId : 0;
 }
 
 uint32_t IOLoginData::getAccountIdByPlayerId(uint32_t playerId) {
-	Database& db = Database::getInstance();
-
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `account_id` FROM `players` WHERE `id` = {:d}", playerId));
-	if (!result) {
-		return 0;
-	}
-	return result->getNumber<uint32_t>("account_id");
+	auto player = getCachedPlayer(playerId);
+	return player ? player->accountId : 0;
 }
 
 AccountType_t IOLoginData::getAccountType(uint32_t accountId) {
@@ -121,91 +413,132 @@ void IOLoginData::updateOnlineStatus(uint32_t guid, bool login) {
 	}
 }
 
-bool IOLoginData::preloadPlayer(Player* player, const std::string& name) {
-	Database& db = Database::getInstance();
+DBStatementResult_ptr IOLoginData::loadPreloadData(Database& db, const std::string& name) {
+	return db.storeStatement("SELECT `p`.`id`, `p`.`account_id`, `p`.`group_id`, `a`.`type`, `a`.`premium_ends_at` FROM `players` as `p` JOIN `accounts` as `a` ON `a`.`id` = `p`.`account_id` WHERE `p`.`name` = ? AND `p`.`deletion` = 0", {name});
+}
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `p`.`id`, `p`.`account_id`, `p`.`group_id`, `a`.`type`, `a`.`premium_ends_at` FROM `players` as `p` JOIN `accounts` as `a` ON `a`.`id` = `p`.`account_id` WHERE `p`.`name` = {:s} AND `p`.`deletion` = 0", db.escapeString(name)));
+bool IOLoginData::preloadPlayer(Player* player, const DBStatementResult_ptr& result) {
 	if (!result) {
 		return false;
 	}
 
-	player->setGUID(result->getNumber<uint32_t>("id"));
-	Group* group = g_game.groups.getGroup(result->getNumber<uint16_t>("group_id"));
+	player->setGUID(result->getNumber<uint32_t>(0));
+	Group* group = g_game.groups.getGroup(result->getNumber<uint16_t>(2));
 	if (!group) {
-		std::cout << "[Error - IOLoginData::preloadPlayer] " << player->name << " has Group ID " << result->getNumber<uint16_t>("group_id") << " which doesn't exist." << std::endl;
+		std::cout << "[Error - IOLoginData::preloadPlayer] " << player->name << " has Group ID " << result->getNumber<uint16_t>(2) << " which doesn't exist." << std::endl;
 		return false;
 	}
 	player->setGroup(group);
-	player->accountNumber = result->getNumber<uint32_t>("account_id");
-	player->accountType = static_cast<AccountType_t>(result->getNumber<uint16_t>("type"));
-	player->premiumEndsAt = result->getNumber<time_t>("premium_ends_at");
+	player->accountNumber = result->getNumber<uint32_t>(1);
+	player->accountType = static_cast<AccountType_t>(result->getNumber<uint16_t>(3));
+	player->premiumEndsAt = result->getNumber<time_t>(4);
 	return true;
 }
 
 bool IOLoginData::loadPlayerById(Player* player, uint32_t id) {
-	Database& db = Database::getInstance();
-	return loadPlayer(player, db.storeQuery(fmt::format("SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `currentmount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `id` = {:d}", id)));
+	PlayerLoadData data;
+	return loadPlayerById(Database::getInstance(), id, data) && loadPlayer(player, data);
 }
 
 bool IOLoginData::loadPlayerByName(Player* player, const std::string& name) {
 	Database& db = Database::getInstance();
-	return loadPlayer(player, db.storeQuery(fmt::format("SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `currentmount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `name` = {:s}", db.escapeString(name))));
+
+	PlayerLoadData data;
+	return loadPlayerData(db, db.storeStatement(fmt::format("{:s}`name` = ?", PLAYER_QUERY), {name}), data) && loadPlayer(player, data);
+}
+
+bool IOLoginData::loadPlayerById(Database& db, uint32_t id, PlayerLoadData& data) {
+	return loadPlayerData(db, db.storeStatement(fmt::format("{:s}`id` = ?", PLAYER_QUERY), {id}), data);
 }
 
-static GuildWarVector getWarList(uint32_t guildId) {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `guild1`, `guild2` FROM `guild_wars` WHERE (`guild1` = {:d} OR `guild2` = {:d}) AND `ended` = 0 AND `status` = 1", guildId, guildId));
+bool IOLoginData::loadPlayerData(Database& db, DBStatementResult_ptr result, PlayerLoadData& data) {
+	if (!result) {
+		return false;
+	}
+
+	const uint32_t guid = result->getNumber<uint32_t>(PLAYER_ID);
+	const uint32_t accountId = result->getNumber<uint32_t>(PLAYER_ACCOUNT_ID);
+
+	data.account = db.storeStatement("SELECT `type`, `premium_ends_at` FROM `accounts` WHERE `id` = ?", {accountId});
+	if (!data.account) {
+		return false;
+	}
+	data.player = std::move(result);
+
+	if ((data.guildMembership = db.storeStatement("SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = ?", {guid}))) {
+		const uint32_t guildId = data.guildMembership->getNumber<uint32_t>(0);
+		data.guildWars = db.storeStatement("SELECT `guild1`, `guild2` FROM `guild_wars` WHERE (`guild1` = ? OR `guild2` = ?) AND `ended` = 0 AND `status` = 1", {guildId, guildId});
+		data.guildMembers = db.storeStatement("SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = ?", {guildId});
+	}
+
+	data.spells = db.storeStatement("SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = ?", {guid});
+
+	const auto start = std::chrono::steady_clock::now();
+	data.itemBlobs = db.storeStatement("SELECT `section`, `data` FROM `player_itemblobs` WHERE `player_id` = ?", {guid});
+	data.itemBlobSections = getItemBlobSections(data.itemBlobs);
+	for (uint8_t table = PLAYER_ITEMS_FIRST; table <= PLAYER_ITEMS_LAST; ++table) {
+		if (data.itemBlobSections[table].empty()) {
+			data.items[table] = selectItemRows(db, static_cast<PlayerItemTable>(table), guid);
+		}
+	}
+	itemLoadMicros.fetch_add(elapsedMicros(start), std::memory_order_relaxed);
+
+	data.storage = db.storeStatement("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = ?", {guid});
+	data.vips = db.storeStatement("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = ?", {accountId});
+	data.outfits = db.storeStatement("SELECT `outfit_id`, `addons` FROM `player_outfits` WHERE `player_id` = ?", {guid});
+	data.mounts = db.storeStatement("SELECT `mount_id` FROM `player_mounts` WHERE `player_id` = ?", {guid});
+	return true;
+}
+
+static GuildWarVector getWarList(uint32_t guildId, const DBStatementResult_ptr& result) {
 	if (!result) {
 		return {};
 	}
 
 	GuildWarVector guildWarVector;
 	do {
-		uint32_t guild1 = result->getNumber<uint32_t>("guild1");
+		uint32_t guild1 = result->getNumber<uint32_t>(0);
 		if (guildId != guild1) {
 			guildWarVector.push_back(guild1);
 		} else {
-			guildWarVector.push_back(result->getNumber<uint32_t>("guild2"));
+			guildWarVector.push_back(result->getNumber<uint32_t>(1));
 		}
 	} while (result->next());
 
 	return guildWarVector;
 }
 
-bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
-	if (!result) {
+bool IOLoginData::loadPlayer(Player* player, PlayerLoadData& data) {
+	if (!data.player || !data.account) {
 		return false;
 	}
 
 	Database& db = Database::getInstance();
 
-	uint32_t accountId = result->getNumber<uint32_t>("account_id");
-
-	auto account =
-	    db.storeQuery(fmt::format("SELECT `type`, `premium_ends_at` FROM `accounts` WHERE `id` = {:d}", accountId));
-	if (!account) {
-		return false;
-	}
+	DBStatementResult_ptr result = data.player;
+	const DBStatementResult_ptr& account = data.account;
+	uint32_t accountId = result->getNumber<uint32_t>(PLAYER_ACCOUNT_ID);
 
-	player->setGUID(result->getNumber<uint32_t>("id"));
-	player->name = result->getString("name");
+	player->setGUID(result->getNumber<uint32_t>(PLAYER_ID));
+	player->name = result->getString(PLAYER_NAME);
 	player->accountNumber = accountId;
 
-	player->accountType = static_cast<AccountType_t>(account->getNumber<int32_t>("type"));
-	player->premiumEndsAt = account->getNumber<time_t>("premium_ends_at");
+	player->accountType = static_cast<AccountType_t>(account->getNumber<int32_t>(0));
+	player->premiumEndsAt = account->getNumber<time_t>(1);
 
-	Group* group = g_game.groups.getGroup(result->getNumber<uint16_t>("group_id"));
+	Group* group = g_game.groups.getGroup(result->getNumber<uint16_t>(PLAYER_GROUP_ID));
 	if (!group) {
-		std::cout << "[Error - IOLoginData::loadPlayer] " << player->name << " has Group ID " << result->getNumber<uint16_t>("group_id") << " which doesn't exist" << std::endl;
+		std::cout << "[Error - IOLoginData::loadPlayer] " << player->name << " has Group ID " << result->getNumber<uint16_t>(PLAYER_GROUP_ID) << " which doesn't exist" << std::endl;
 		return false;
 	}
 	player->setGroup(group);
 
-	player->bankBalance = result->getNumber<uint64_t>("balance");
+	player->bankBalance = result->getNumber<uint64_t>(PLAYER_BALANCE);
 
-	player->setSex(static_cast<PlayerSex_t>(result->getNumber<uint16_t>("sex")));
-	player->level = std::max<uint32_t>(1, result->getNumber<uint32_t>("level"));
+	player->setSex(static_cast<PlayerSex_t>(result->getNumber<uint16_t>(PLAYER_SEX)));
+	player->level = std::max<uint32_t>(1, result->getNumber<uint32_t>(PLAYER_LEVEL));
 
-	uint64_t experience = result->getNumber<uint64_t>("experience");
+	uint64_t experience = result->getNumber<uint64_t>(PLAYER_EXPERIENCE);
 
 	uint64_t currExpCount = Player::getExpForLevel(player->level);
 	uint64_t nextExpCount = Player::getExpForLevel(player->level + 1);
@@ -221,11 +554,11 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 		player->levelPercent = 0;
 	}
 
-	player->soul = result->getNumber<uint16_t>("soul");
-	player->capacity = result->getNumber<uint32_t>("cap") * 100;
-	player->blessings = result->getNumber<uint16_t>("blessings");
+	player->soul = result->getNumber<uint16_t>(PLAYER_SOUL);
+	player->capacity = result->getNumber<uint32_t>(PLAYER_CAP) * 100;
+	player->blessings = result->getNumber<uint16_t>(PLAYER_BLESSINGS);
 
-	auto conditions = result->getString("conditions");
+	auto conditions = result->getString(PLAYER_CONDITIONS);
 	PropStream propStream;
 	propStream.init(conditions.data(), conditions.size());
 
@@ -239,17 +572,17 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 		condition = Condition::createCondition(propStream);
 	}
 
-	if (!player->setVocation(result->getNumber<uint16_t>("vocation"))) {
-		std::cout << "[Error - IOLoginData::loadPlayer] " << player->name << " has Vocation ID " << result->getNumber<uint16_t>("vocation") << " which doesn't exist" << std::endl;
+	if (!player->setVocation(result->getNumber<uint16_t>(PLAYER_VOCATION))) {
+		std::cout << "[Error - IOLoginData::loadPlayer] " << player->name << " has Vocation ID " << result->getNumber<uint16_t>(PLAYER_VOCATION) << " which doesn't exist" << std::endl;
 		return false;
 	}
 
-	player->mana = result->getNumber<uint32_t>("mana");
-	player->manaMax = result->getNumber<uint32_t>("manamax");
-	player->magLevel = result->getNumber<uint32_t>("maglevel");
+	player->mana = result->getNumber<uint32_t>(PLAYER_MANA);
+	player->manaMax = result->getNumber<uint32_t>(PLAYER_MANAMAX);
+	player->magLevel = result->getNumber<uint32_t>(PLAYER_MAGLEVEL);
 
 	uint64_t nextManaCount = player->vocation->getReqMana(player->magLevel + 1);
-	uint64_t manaSpent = result->getNumber<uint64_t>("manaspent");
+	uint64_t manaSpent = result->getNumber<uint64_t>(PLAYER_MANASPENT);
 	if (manaSpent > nextManaCount) {
 		manaSpent = 0;
 	}
@@ -257,26 +590,26 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 	player->manaSpent = manaSpent;
 	player->magLevelPercent = Player::getPercentLevel(player->manaSpent, nextManaCount);
 
-	player->health = result->getNumber<int32_t>("health");
-	player->healthMax = result->getNumber<int32_t>("healthmax");
+	player->health = result->getNumber<int32_t>(PLAYER_HEALTH);
+	player->healthMax = result->getNumber<int32_t>(PLAYER_HEALTHMAX);
 
-	player->defaultOutfit.lookType = result->getNumber<uint16_t>("looktype");
-	player->defaultOutfit.lookHead = result->getNumber<uint16_t>("lookhead");
-	player->defaultOutfit.lookBody = result->getNumber<uint16_t>("lookbody");
-	player->defaultOutfit.lookLegs = result->getNumber<uint16_t>("looklegs");
-	player->defaultOutfit.lookFeet = result->getNumber<uint16_t>("lookfeet");
-	player->defaultOutfit.lookAddons = result->getNumber<uint16_t>("lookaddons");
+	player->defaultOutfit.lookType = result->getNumber<uint16_t>(PLAYER_LOOKTYPE);
+	player->defaultOutfit.lookHead = result->getNumber<uint16_t>(PLAYER_LOOKHEAD);
+	player->defaultOutfit.lookBody = result->getNumber<uint16_t>(PLAYER_LOOKBODY);
+	player->defaultOutfit.lookLegs = result->getNumber<uint16_t>(PLAYER_LOOKLEGS);
+	player->defaultOutfit.lookFeet = result->getNumber<uint16_t>(PLAYER_LOOKFEET);
+	player->defaultOutfit.lookAddons = result->getNumber<uint16_t>(PLAYER_LOOKADDONS);
 	player->currentOutfit = player->defaultOutfit;
-	player->currentMount = result->getNumber<uint16_t>("currentmount");
-	player->direction = static_cast<Direction> (result->getNumber<uint16_t>("direction"));
+	player->currentMount = result->getNumber<uint16_t>(PLAYER_CURRENTMOUNT);
+	player->direction = static_cast<Direction> (result->getNumber<uint16_t>(PLAYER_DIRECTION));
 
 	if (g_game.getWorldType() != WORLD_TYPE_PVP_ENFORCED) {
-		const time_t skullSeconds = result->getNumber<time_t>("skulltime") - time(nullptr);
+		const time_t skullSeconds = result->getNumber<time_t>(PLAYER_SKULLTIME) - time(nullptr);
 		if (skullSeconds > 0) {
 			//ensure that we round up the number of ticks
 			player->skullTicks = (skullSeconds + 2);
 
-			uint16_t skull = result->getNumber<uint16_t>("skull");
+			uint16_t skull = result->getNumber<uint16_t>(PLAYER_SKULL);
 			if (skull == SKULL_RED) {
 				player->skull = SKULL_RED;
 			} else if (skull == SKULL_BLACK) {
@@ -285,19 +618,19 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 		}
 	}
 
-	player->loginPosition.x = result->getNumber<uint16_t>("posx");
-	player->loginPosition.y = result->getNumber<uint16_t>("posy");
-	player->loginPosition.z = result->getNumber<uint16_t>("posz");
+	player->loginPosition.x = result->getNumber<uint16_t>(PLAYER_POSX);
+	player->loginPosition.y = result->getNumber<uint16_t>(PLAYER_POSY);
+	player->loginPosition.z = result->getNumber<uint16_t>(PLAYER_POSZ);
 
-	player->lastLoginSaved = result->getNumber<time_t>("lastlogin");
-	player->lastLogout = result->getNumber<time_t>("lastlogout");
+	player->lastLoginSaved = result->getNumber<time_t>(PLAYER_LASTLOGIN);
+	player->lastLogout = result->getNumber<time_t>(PLAYER_LASTLOGOUT);
 
-	player->offlineTrainingTime = result->getNumber<int32_t>("offlinetraining_time") * 1000;
-	player->offlineTrainingSkill = result->getNumber<int32_t>("offlinetraining_skill");
+	player->offlineTrainingTime = result->getNumber<int32_t>(PLAYER_OFFLINETRAINING_TIME) * 1000;
+	player->offlineTrainingSkill = result->getNumber<int32_t>(PLAYER_OFFLINETRAINING_SKILL);
 
-	Town* town = g_game.map.towns.getTown(result->getNumber<uint32_t>("town_id"));
+	Town* town = g_game.map.towns.getTown(result->getNumber<uint32_t>(PLAYER_TOWN_ID));
 	if (!town) {
-		std::cout << "[Error - IOLoginData::loadPlayer] " << player->name << " has Town ID " << result->getNumber<uint32_t>("town_id") << " which doesn't exist" << std::endl;
+		std::cout << "[Error - IOLoginData::loadPlayer] " << player->name << " has Town ID " << result->getNumber<uint32_t>(PLAYER_TOWN_ID) << " which doesn't exist" << std::endl;
 		return false;
 	}
 
@@ -308,14 +641,11 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 		player->loginPosition = player->getTemplePosition();
 	}
 
-	player->staminaMinutes = result->getNumber<uint16_t>("stamina");
+	player->staminaMinutes = result->getNumber<uint16_t>(PLAYER_STAMINA);
 
-	static const std::string skillNames[] = {"skill_fist", "skill_club", "skill_sword", "skill_axe", "skill_dist", "skill_shielding", "skill_fishing"};
-	static const std::string skillNameTries[] = {"skill_fist_tries", "skill_club_tries", "skill_sword_tries", "skill_axe_tries", "skill_dist_tries", "skill_shielding_tries", "skill_fishing_tries"};
-	static constexpr size_t size = sizeof(skillNames) / sizeof(std::string);
-	for (uint8_t i = 0; i < size; ++i) {
-		uint16_t skillLevel = result->getNumber<uint16_t>(skillNames[i]);
-		uint64_t skillTries = result->getNumber<uint64_t>(skillNameTries[i]);
+	for (uint8_t i = SKILL_FIRST; i <= SKILL_LAST; ++i) {
+		uint16_t skillLevel = result->getNumber<uint16_t>(PLAYER_SKILL_FIST + 2 * i);
+		uint64_t skillTries = result->getNumber<uint64_t>(PLAYER_SKILL_FIST + 2 * i + 1);
 		uint64_t nextSkillTries = player->vocation->getReqSkillTries(i, skillLevel + 1);
 		if (skillTries > nextSkillTries) {
 			skillTries = 0;
@@ -326,10 +656,10 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 		player->skills[i].percent = Player::getPercentLevel(skillTries, nextSkillTries);
 	}
 
-	if ((result = db.storeQuery(fmt::format("SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = {:d}", player->getGUID())))) {
-		uint32_t guildId = result->getNumber<uint32_t>("guild_id");
-		uint32_t playerRankId = result->getNumber<uint32_t>("rank_id");
-		player->guildNick = result->getString("nick");
+	if ((result = data.guildMembership)) {
+		uint32_t guildId = result->getNumber<uint32_t>(0);
+		uint32_t playerRankId = result->getNumber<uint32_t>(1);
+		player->guildNick = result->getString(2);
 
 		auto guild = g_game.getGuild(guildId);
 		if (!guild) {
@@ -345,8 +675,8 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 			player->guild = guild;
 			auto rank = guild->getRankById(playerRankId);
 			if (!rank) {
-				if ((result = db.storeQuery(fmt::format("SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `id` = {:d}", playerRankId)))) {
-					guild->addRank(result->getNumber<uint32_t>("id"), result->getString("name"), result->getNumber<uint16_t>("level"));
+				if ((result = db.storeStatement("SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `id` = ?", {playerRankId}))) {
+					guild->addRank(result->getNumber<uint32_t>(0), result->getString(1), result->getNumber<uint16_t>(2));
 				}
 
 				rank = guild->getRankById(playerRankId);
@@ -356,176 +686,291 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 			}
 
 			player->guildRank = rank;
-			player->guildWarVector = getWarList(guildId);
+			player->guildWarVector = getWarList(guildId, data.guildWars);
 
-			if ((result = db.storeQuery(fmt::format("SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = {:d}", guildId)))) {
-				guild->setMemberCount(result->getNumber<uint32_t>("members"));
+			if ((result = data.guildMembers)) {
+				guild->setMemberCount(result->getNumber<uint32_t>(0));
 			}
 		}
 	}
 
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = {:d}", player->getGUID())))) {
+	if ((result = data.spells)) {
 		do {
-			player->learnedInstantSpellList.emplace_front(result->getString("name"));
+			player->learnedInstantSpellList.emplace_front(result->getString(1));
 		} while (result->next());
 	}
 
-	//load inventory items
+	//load items, each section from its blob or its row table
 	ItemMap itemMap;
+	ItemRowList itemRows;
+	std::string blobBuffer;
+	for (uint8_t table = PLAYER_ITEMS_FIRST; table <= PLAYER_ITEMS_LAST; ++table) {
+		const auto itemTable = static_cast<PlayerItemTable>(table);
+		if (!readItemSection(data.itemBlobSections[table], data.items[table], blobBuffer, itemRows)) {
+			std::cout << "[Error - IOLoginData::loadPlayer] " << player->name << " has a corrupt " << getItemTableName(itemTable) << " blob" << std::endl;
+			return false;
+		}
 
-	if ((result = db.storeQuery(fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_items` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
+		itemMap.clear();
+		if (loadItems(itemMap, itemRows)) {
+			placeItems(player, itemTable, itemMap);
+		}
+	}
 
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<Item*, int32_t>& pair = it->second;
-			Item* item = pair.first;
-			int32_t pid = pair.second;
-			if (pid >= CONST_SLOT_FIRST && pid <= CONST_SLOT_LAST) {
-				player->internalAddThing(pid, item);
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
-				if (it2 == itemMap.end()) {
-					continue;
-				}
+	//load storage map
+	if ((result = data.storage)) {
+		do {
+			const uint32_t key = result->getNumber<uint32_t>(0);
+			const int32_t value = result->getNumber<int32_t>(1);
+			player->setStorageValue(key, value, true);
+			player->storageMap.setSaved(key, value);
+		} while (result->next());
+	}
 
-				Container* container = it2->second.first->getContainer();
-				if (container) {
-					container->internalAddThing(item);
-				}
-			}
-		}
+	//load vip list
+	if ((result = data.vips)) {
+		do {
+			player->addVIPInternal(result->getNumber<uint32_t>(0));
+		} while (result->next());
 	}
 
-	//load depot items
-	itemMap.clear();
+	// load outfits & addons
+	if ((result = data.outfits)) {
+		do {
+			player->addOutfit(result->getNumber<uint16_t>(0), result->getNumber<uint8_t>(1));
+		} while (result->next());
+	}
 
-	if ((result = db.storeQuery(fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_depotitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
+	// load mounts
+	if ((result = data.mounts)) {
+		do {
+			player->tameMount(result->getNumber<uint16_t>(0));
+		} while (result->next());
+	}
 
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<Item*, int32_t>& pair = it->second;
-			Item* item = pair.first;
+	player->updateBaseSpeed();
+	player->updateInventoryWeight();
+	player->updateItemsLight(true);
+	return true;
+}
 
-			int32_t pid = pair.second;
-			if (pid >= 0 && pid < 100) {
-				const auto& depotChest = player->getDepotChest(pid, true);
-				if (depotChest) {
-					depotChest->internalAddThing(item);
+void IOLoginData::collectItems(const Player* player, PlayerItemTable table, ItemBlockList& itemList) {
+	itemList.clear();
+	switch (table) {
+		case PLAYER_ITEMS_INVENTORY:
+			for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
+				Item* item = player->inventory[slotId];
+				if (item) {
+					itemList.emplace_back(slotId, item);
 				}
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
-				if (it2 == itemMap.end()) {
-					continue;
+			}
+			break;
+
+		case PLAYER_ITEMS_DEPOT:
+			for (const auto& it : player->depotChests) {
+				for (Item* item : it.second->getItemList()) {
+					itemList.emplace_back(it.first, item);
 				}
+			}
+			break;
 
-				Container* container = it2->second.first->getContainer();
-				if (container) {
-					container->internalAddThing(item);
+		case PLAYER_ITEMS_INBOX:
+			// an inbox that was never opened is empty
+			if (player->inbox) {
+				for (Item* item : player->inbox->getItemList()) {
+					itemList.emplace_back(0, item);
 				}
 			}
-		}
+			break;
+
+		case PLAYER_ITEMS_STORE_INBOX:
+			for (Item* item : player->getStoreInbox()->getItemList()) {
+				itemList.emplace_back(0, item);
+			}
+			break;
 	}
+}
 
-	//load inbox items
-	itemMap.clear();
+bool IOLoginData::hasItemTable(const Player* player, PlayerItemTable table) {
+	// the depot is only written once it has been loaded
+	return table != PLAYER_ITEMS_DEPOT || player->lastDepotId != -1;
+}
 
-	if ((result = db.storeQuery(fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_inboxitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
+std::string_view IOLoginData::getItemTableName(PlayerItemTable table) {
+	switch (table) {
+		case PLAYER_ITEMS_INVENTORY:
+			return "player_items";
+		case PLAYER_ITEMS_DEPOT:
+			return "player_depotitems";
+		case PLAYER_ITEMS_INBOX:
+			return "player_inboxitems";
+		case PLAYER_ITEMS_STORE_INBOX:
+			return "player_storeinboxitems";
+	}
+	return {};
+}
 
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<Item*, int32_t>& pair = it->second;
-			Item* item = pair.first;
-			int32_t pid = pair.second;
+bool IOLoginData::isItemBlobStorage() {
+	return getString(ConfigManager::ITEM_STORAGE) == "blob";
+}
 
-			if (pid >= 0 && pid < 100) {
-				player->getInbox()->internalAddThing(item);
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
+bool IOLoginData::saveItemRows(Database& db, uint32_t guid, PlayerItemTable table, const ItemRowList& rows) {
+	const std::string_view tableName = getItemTableName(table);
+	if (!deletePlayerRows(db, tableName, {guid}) || !deleteItemBlobs(db, table, {guid})) {
+		return false;
+	}
 
-				if (it2 == itemMap.end()) {
-					continue;
-				}
+	if (rows.empty()) {
+		return true;
+	}
 
-				Container* container = it2->second.first->getContainer();
-				if (container) {
-					container->internalAddThing(item);
-				}
-			}
+	if (isItemBlobStorage()) {
+		ItemBlob blob;
+		for (const ItemRow& row : rows) {
+			blob.addRow(row.pid, row.sid, row.itemType, row.count, row.attributes);
 		}
+
+		DBStatementInsert blobQuery(db, std::string{ITEM_BLOB_INSERT}, 4);
+		return addItemBlob(blobQuery, guid, table, blob) && blobQuery.execute();
 	}
 
-	//load store inbox items
-	itemMap.clear();
+	DBStatementInsert itemsQuery(db, makeItemInsert(tableName), 6);
+	for (const ItemRow& row : rows) {
+		if (!itemsQuery.addRow({guid, row.pid, row.sid, row.itemType, row.count, DBParam::blob(std::string{row.attributes})})) {
+			return false;
+		}
+	}
+	return itemsQuery.execute();
+}
 
-	if ((result = db.storeQuery(fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_storeinboxitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
+size_t IOLoginData::convertItemStorage(size_t limit) {
+	Database& db = Database::getInstance();
+	const bool toBlobs = isItemBlobStorage();
+
+	size_t converted = 0;
+	std::vector<uint32_t> guids;
+	ItemRowList rows;
+	std::string buffer;
+	for (uint8_t table = PLAYER_ITEMS_FIRST; table <= PLAYER_ITEMS_LAST && converted < limit; ++table) {
+		const auto itemTable = static_cast<PlayerItemTable>(table);
+
+		// players with this section still in the other format
+		DBStatementResult_ptr result;
+		if (toBlobs) {
+			result = db.storeStatement(fmt::format("SELECT DISTINCT `player_id` FROM `{:s}` LIMIT ?", getItemTableName(itemTable)), {limit - converted});
+		} else {
+			result = db.storeStatement("SELECT `player_id` FROM `player_itemblobs` WHERE `section` = ? LIMIT ?", {table, limit - converted});
+		}
 
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<Item*, int32_t>& pair = it->second;
-			Item* item = pair.first;
-			int32_t pid = pair.second;
+		if (!result) {
+			continue;
+		}
 
-			if (pid >= 0 && pid < 100) {
-				player->getStoreInbox()->internalAddThing(item);
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
+		guids.clear();
+		do {
+			guids.push_back(result->getNumber<uint32_t>(0));
+		} while (result->next());
 
-				if (it2 == itemMap.end()) {
-					continue;
-				}
+		for (uint32_t guid : guids) {
+			DBStatementResult_ptr rowResult;
+			DBStatementResult_ptr blobResult;
+			if (toBlobs) {
+				rowResult = selectItemRows(db, itemTable, guid);
+			} else if (!(blobResult = db.storeStatement("SELECT `data` FROM `player_itemblobs` WHERE `player_id` = ? AND `section` = ?", {guid, table}))) {
+				continue;
+			}
 
-				Container* container = it2->second.first->getContainer();
-				if (container) {
-					container->internalAddThing(item);
-				}
+			if (!readItemSection(blobResult ? blobResult->getString(0) : std::string_view{}, rowResult, buffer, rows)) {
+				std::cout << "[Error - IOLoginData::convertItemStorage] Player " << guid << " has a corrupt " << getItemTableName(itemTable) << " blob" << std::endl;
+				return converted;
+			}
+
+			DBTransaction transaction;
+			if (!transaction.begin() || !saveItemRows(db, guid, itemTable, rows) || !transaction.commit()) {
+				std::cout << "[Error - IOLoginData::convertItemStorage] Failed to convert " << getItemTableName(itemTable) << " of player " << guid << std::endl;
+				return converted;
 			}
+			++converted;
 		}
 	}
+	return converted;
+}
 
-	//load storage map
-	if ((result = db.storeQuery(fmt::format("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = {:d}", player->getGUID())))) {
-		do {
-			player->setStorageValue(result->getNumber<uint32_t>("key"), result->getNumber<int32_t>("value"), true);
-		} while (result->next());
-	}
+std::optional<ItemStorageBenchmark> IOLoginData::benchmarkItemStorage(const Player* player) {
+	Database& db = Database::getInstance();
 
-	//load vip list
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = {:d}", player->getAccount())))) {
-		do {
-			player->addVIPInternal(result->getNumber<uint32_t>("player_id"));
-		} while (result->next());
+	// nothing is committed, the destructor rolls every write back
+	DBTransaction transaction;
+	if (!transaction.begin()) {
+		return std::nullopt;
 	}
 
-	// load outfits & addons
-	if ((result = db.storeQuery(fmt::format(
-	         "SELECT `outfit_id`, `addons` FROM `player_outfits` WHERE `player_id` = {:d}", player->getGUID())))) {
-		do {
-			player->addOutfit(result->getNumber<uint16_t>("outfit_id"), result->getNumber<uint8_t>("addons"));
-		} while (result->next());
-	}
+	ItemStorageBenchmark benchmark;
+	const uint32_t guid = player->getGUID();
 
-	// load mounts
-	if ((result = db.storeQuery(
-	         fmt::format("SELECT `mount_id` FROM `player_mounts` WHERE `player_id` = {:d}", player->getGUID())))) {
-		do {
-			player->tameMount(result->getNumber<uint16_t>("mount_id"));
-		} while (result->next());
-	}
+	PropWriteStream propWriteStream;
+	ItemBlockList itemList;
+	ItemBlob blob;
+	ItemRowList rows;
+	std::string buffer;
+	for (uint8_t table = PLAYER_ITEMS_FIRST; table <= PLAYER_ITEMS_LAST; ++table) {
+		const auto itemTable = static_cast<PlayerItemTable>(table);
+		if (!hasItemTable(player, itemTable)) {
+			continue;
+		}
 
-	player->updateBaseSpeed();
-	player->updateInventoryWeight();
-	player->updateItemsLight(true);
-	return true;
+		const std::string_view tableName = getItemTableName(itemTable);
+		if (!deletePlayerRows(db, tableName, {guid}) || !deleteItemBlobs(db, itemTable, {guid})) {
+			return std::nullopt;
+		}
+
+		collectItems(player, itemTable, itemList);
+
+		auto start = std::chrono::steady_clock::now();
+		DBStatementInsert itemsQuery(db, makeItemInsert(tableName), 6);
+		if (!saveItems(player, itemList, itemsQuery, propWriteStream) || !itemsQuery.execute()) {
+			return std::nullopt;
+		}
+		benchmark.rowSaveMicros += elapsedMicros(start);
+
+		start = std::chrono::steady_clock::now();
+		readItemRows(selectItemRows(db, itemTable, guid), rows);
+		benchmark.rowLoadMicros += elapsedMicros(start);
+
+		benchmark.rows += rows.size();
+		for (const ItemRow& row : rows) {
+			benchmark.rowBytes += sizeof(guid) + sizeof(row.pid) + sizeof(row.sid) + sizeof(row.itemType) + sizeof(row.count) + row.attributes.size();
+		}
+
+		start = std::chrono::steady_clock::now();
+		DBStatementInsert blobQuery(db, std::string{ITEM_BLOB_INSERT}, 4);
+		if (!saveItemBlob(itemList, blob, propWriteStream) || (blob.getRowCount() != 0 && !addItemBlob(blobQuery, guid, itemTable, blob)) || !blobQuery.execute()) {
+			return std::nullopt;
+		}
+		benchmark.blobSaveMicros += elapsedMicros(start);
+
+		start = std::chrono::steady_clock::now();
+		if (DBStatementResult_ptr result = db.storeStatement("SELECT `data` FROM `player_itemblobs` WHERE `player_id` = ? AND `section` = ?", {guid, table})) {
+			const std::string_view data = result->getString(0);
+			if (!ItemBlob::decode(data, buffer, rows)) {
+				return std::nullopt;
+			}
+
+			++benchmark.blobs;
+			benchmark.blobBytes += data.size();
+		}
+		benchmark.blobLoadMicros += elapsedMicros(start);
+	}
+	return benchmark;
 }
 
-bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert, PropWriteStream& propWriteStream) {
+bool IOLoginData::forEachItemRow(const ItemBlockList& itemList, PropWriteStream& propWriteStream, const ItemRowVisitor& visit) {
 	using ContainerBlock = std::pair<Container*, int32_t>;
 	std::vector<ContainerBlock> containers;
 	containers.reserve(32);
 
 	int32_t runningId = 100;
 
-	Database& db = Database::getInstance();
 	for (const auto& it : itemList) {
 		int32_t pid = it.first;
 		Item* item = it.second;
@@ -534,7 +979,7 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
 		propWriteStream.clear();
 		item->serializeAttr(propWriteStream);
 
-		if (!query_insert.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), pid, runningId, item->getID(), item->getSubType(), db.escapeString(propWriteStream.getStream())))) {
+		if (!visit(pid, runningId, item, propWriteStream.getStream())) {
 			return false;
 		}
 
@@ -559,32 +1004,39 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
 			propWriteStream.clear();
 			item->serializeAttr(propWriteStream);
 
-			if (!query_insert.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), parentId, runningId, item->getID(), item->getSubType(), db.escapeString(propWriteStream.getStream())))) {
+			if (!visit(parentId, runningId, item, propWriteStream.getStream())) {
 				return false;
 			}
 		}
 	}
-	return query_insert.execute();
+	return true;
 }
 
-bool IOLoginData::savePlayer(Player* player) {
-	if (player->isDead()) {
-		player->changeHealth(1);
-	}
+bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList, DBStatementInsert& query_insert, PropWriteStream& propWriteStream) {
+	uint64_t rows = 0;
+	const bool success = forEachItemRow(itemList, propWriteStream, [&](int32_t pid, int32_t sid, const Item* item, std::string_view attributes) {
+		++rows;
+		return query_insert.addRow({player->getGUID(), pid, sid, item->getID(), item->getSubType(), DBParam::blob(std::string{attributes})});
+	});
 
-	Database& db = Database::getInstance();
+	itemRowsSaved.fetch_add(rows, std::memory_order_relaxed);
+	return success;
+}
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `save` FROM `players` WHERE `id` = {:d}", player->getGUID()));
-	if (!result) {
-		return false;
-	}
+bool IOLoginData::saveItemBlob(const ItemBlockList& itemList, ItemBlob& blob, PropWriteStream& propWriteStream) {
+	blob.clear();
+	const bool success = forEachItemRow(itemList, propWriteStream, [&blob](int32_t pid, int32_t sid, const Item* item, std::string_view attributes) {
+		blob.addRow(pid, sid, item->getID(), item->getSubType(), attributes);
+		return true;
+	});
 
-	if (result->getNumber<uint16_t>("save") == 0) {
-		return db.executeQuery(fmt::format("UPDATE `players` SET `lastlogin` = {:d}, `lastip` = INET6_ATON('{:s}') WHERE `id` = {:d}",player->lastLoginSaved, player->lastIP.to_string(), player->getGUID()));
-	}
+	itemRowsSaved.fetch_add(blob.getRowCount(), std::memory_order_relaxed);
+	return success;
+}
 
+bool IOLoginData::savePlayerRow(Player* player, PropWriteStream& propWriteStream) {
 	//serialize conditions
-	PropWriteStream propWriteStream;
+	propWriteStream.clear();
 	for (Condition* condition : player->conditions) {
 		if (condition->isPersistent()) {
 			condition->serialize(propWriteStream);
@@ -592,46 +1044,52 @@ bool IOLoginData::savePlayer(Player* player) {
 		}
 	}
 
-	//First, an UPDATE query to write the player itself
-	std::ostringstream query;
-	query << "UPDATE `players` SET ";
-	query << "`level` = " << player->level << ',';
-	query << "`group_id` = " << player->group->id << ',';
-	query << "`vocation` = " << player->getVocationId() << ',';
-	query << "`health` = " << player->health << ',';
-	query << "`healthmax` = " << player->healthMax << ',';
-	query << "`experience` = " << player->experience << ',';
-	query << "`lookbody` = " << static_cast<uint32_t>(player->defaultOutfit.lookBody) << ',';
-	query << "`lookfeet` = " << static_cast<uint32_t>(player->defaultOutfit.lookFeet) << ',';
-	query << "`lookhead` = " << static_cast<uint32_t>(player->defaultOutfit.lookHead) << ',';
-	query << "`looklegs` = " << static_cast<uint32_t>(player->defaultOutfit.lookLegs) << ',';
-	query << "`looktype` = " << player->defaultOutfit.lookType << ',';
-	query << "`lookaddons` = " << static_cast<uint32_t>(player->defaultOutfit.lookAddons) << ',';
-	query << "`currentmount` = " << static_cast<uint16_t>(player->currentMount) << ',';
-	query << "`maglevel` = " << player->magLevel << ',';
-	query << "`mana` = " << player->mana << ',';
-	query << "`manamax` = " << player->manaMax << ',';
-	query << "`manaspent` = " << player->manaSpent << ',';
-	query << "`soul` = " << static_cast<uint16_t>(player->soul) << ',';
-	query << "`town_id` = " << player->town->getID() << ',';
+	std::string query = "UPDATE `players` SET ";
+	DBParams params;
+	params.reserve(64);
+
+	auto set = [&query, &params](std::string_view column, DBParam value, std::string_view placeholder = "?") {
+		query += fmt::format("`{:s}` = {:s},", column, placeholder);
+		params.push_back(std::move(value));
+	};
+
+	set("level", player->level);
+	set("group_id", player->group->id);
+	set("vocation", player->getVocationId());
+	set("health", player->health);
+	set("healthmax", player->healthMax);
+	set("experience", player->experience);
+	set("lookbody", player->defaultOutfit.lookBody);
+	set("lookfeet", player->defaultOutfit.lookFeet);
+	set("lookhead", player->defaultOutfit.lookHead);
+	set("looklegs", player->defaultOutfit.lookLegs);
+	set("looktype", player->defaultOutfit.lookType);
+	set("lookaddons", player->defaultOutfit.lookAddons);
+	set("currentmount", static_cast<uint16_t>(player->currentMount));
+	set("maglevel", player->magLevel);
+	set("mana", player->mana);
+	set("manamax", player->manaMax);
+	set("manaspent", player->manaSpent);
+	set("soul", player->soul);
+	set("town_id", player->town->getID());
 
 	const Position& loginPosition = player->getLoginPosition();
-	query << "`posx` = " << loginPosition.getX() << ',';
-	query << "`posy` = " << loginPosition.getY() << ',';
-	query << "`posz` = " << loginPosition.getZ() << ',';
+	set("posx", loginPosition.getX());
+	set("posy", loginPosition.getY());
+	set("posz", loginPosition.getZ());
 
-	query << "`cap` = " << (player->capacity / 100) << ',';
-	query << "`sex` = " << static_cast<uint16_t>(player->sex) << ',';
+	set("cap", player->capacity / 100);
+	set("sex", static_cast<uint16_t>(player->sex));
 
 	if (player->lastLoginSaved != 0) {
-		query << "`lastlogin` = " << player->lastLoginSaved << ',';
+		set("lastlogin", player->lastLoginSaved);
 	}
 
 	if (!player->lastIP.is_unspecified()) {
-		query << "`lastip` = INET6_ATON('" << player->lastIP.to_string() << "'),";
+		set("lastip", player->lastIP.to_string(), "INET6_ATON(?)");
 	}
 
-	query << "`conditions` = " << db.escapeString(propWriteStream.getStream()) << ',';
+	set("conditions", DBParam::blob(propWriteStream.getStream()));
 
 	if (g_game.getWorldType() != WORLD_TYPE_PVP_ENFORCED) {
 		int64_t skullTime = 0;
@@ -639,7 +1097,7 @@ bool IOLoginData::savePlayer(Player* player) {
 		if (player->skullTicks > 0) {
 			skullTime = time(nullptr) + player->skullTicks;
 		}
-		query << "`skulltime` = " << skullTime << ',';
+		set("skulltime", skullTime);
 
 		Skulls_t skull = SKULL_NONE;
 		if (player->skull == SKULL_RED) {
@@ -647,141 +1105,231 @@ bool IOLoginData::savePlayer(Player* player) {
 		} else if (player->skull == SKULL_BLACK) {
 			skull = SKULL_BLACK;
 		}
-		query << "`skull` = " << static_cast<int64_t>(skull) << ',';
-	}
-
-	query << "`lastlogout` = " << player->getLastLogout() << ',';
-	query << "`balance` = " << player->bankBalance << ',';
-	query << "`offlinetraining_time` = " << player->getOfflineTrainingTime() / 1000 << ',';
-	query << "`offlinetraining_skill` = " << player->getOfflineTrainingSkill() << ',';
-	query << "`stamina` = " << player->getStaminaMinutes() << ',';
-
-	query << "`skill_fist` = " << player->skills[SKILL_FIST].level << ',';
-	query << "`skill_fist_tries` = " << player->skills[SKILL_FIST].tries << ',';
-	query << "`skill_club` = " << player->skills[SKILL_CLUB].level << ',';
-	query << "`skill_club_tries` = " << player->skills[SKILL_CLUB].tries << ',';
-	query << "`skill_sword` = " << player->skills[SKILL_SWORD].level << ',';
-	query << "`skill_sword_tries` = " << player->skills[SKILL_SWORD].tries << ',';
-	query << "`skill_axe` = " << player->skills[SKILL_AXE].level << ',';
-	query << "`skill_axe_tries` = " << player->skills[SKILL_AXE].tries << ',';
-	query << "`skill_dist` = " << player->skills[SKILL_DISTANCE].level << ',';
-	query << "`skill_dist_tries` = " << player->skills[SKILL_DISTANCE].tries << ',';
-	query << "`skill_shielding` = " << player->skills[SKILL_SHIELD].level << ',';
-	query << "`skill_shielding_tries` = " << player->skills[SKILL_SHIELD].tries << ',';
-	query << "`skill_fishing` = " << player->skills[SKILL_FISHING].level << ',';
-	query << "`skill_fishing_tries` = " << player->skills[SKILL_FISHING].tries << ',';
-	query << "`direction` = " << static_cast<uint16_t> (player->getDirection()) << ',';
+		set("skull", static_cast<int64_t>(skull));
+	}
+
+	set("lastlogout", player->getLastLogout());
+	set("balance", player->bankBalance);
+	set("offlinetraining_time", player->getOfflineTrainingTime() / 1000);
+	set("offlinetraining_skill", player->getOfflineTrainingSkill());
+	set("stamina", player->getStaminaMinutes());
+
+	set("skill_fist", player->skills[SKILL_FIST].level);
+	set("skill_fist_tries", player->skills[SKILL_FIST].tries);
+	set("skill_club", player->skills[SKILL_CLUB].level);
+	set("skill_club_tries", player->skills[SKILL_CLUB].tries);
+	set("skill_sword", player->skills[SKILL_SWORD].level);
+	set("skill_sword_tries", player->skills[SKILL_SWORD].tries);
+	set("skill_axe", player->skills[SKILL_AXE].level);
+	set("skill_axe_tries", player->skills[SKILL_AXE].tries);
+	set("skill_dist", player->skills[SKILL_DISTANCE].level);
+	set("skill_dist_tries", player->skills[SKILL_DISTANCE].tries);
+	set("skill_shielding", player->skills[SKILL_SHIELD].level);
+	set("skill_shielding_tries", player->skills[SKILL_SHIELD].tries);
+	set("skill_fishing", player->skills[SKILL_FISHING].level);
+	set("skill_fishing_tries", player->skills[SKILL_FISHING].tries);
+	set("direction", static_cast<uint16_t>(player->getDirection()));
 
 	if (!player->isOffline()) {
-		query << "`onlinetime` = `onlinetime` + " << (time(nullptr) - player->lastLoginSaved) << ',';
+		set("onlinetime", static_cast<int64_t>(time(nullptr) - player->lastLoginSaved), "`onlinetime` + ?");
 	}
-	query << "`blessings` = " << player->blessings.to_ulong();
-	query << " WHERE `id` = " << player->getGUID();
+	query += "`blessings` = ? WHERE `id` = ?";
+	params.emplace_back(player->blessings.to_ulong());
+	params.emplace_back(player->getGUID());
+	return Database::getInstance().executeStatement(query, params);
+}
 
-	DBTransaction transaction;
-	if (!transaction.begin()) {
-		return false;
-	}
+bool IOLoginData::savePlayer(Player* player) {
+	return savePlayerBatch({player});
+}
 
-	if (!db.executeQuery(query.str())) {
-		return false;
-	}
+bool IOLoginData::savePlayers(const std::vector<Player*>& players) {
+	const auto start = std::chrono::steady_clock::now();
+	const size_t batchSize = std::max<int64_t>(getNumber(ConfigManager::PLAYER_SAVE_BATCH_SIZE), 1);
 
-	// learned spells
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_spells` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	size_t failures = 0;
+	for (size_t first = 0; first < players.size(); first += batchSize) {
+		std::vector<Player*> batch{players.begin() + first, players.begin() + std::min(first + batchSize, players.size())};
+		++playerSaveStats.batches;
+		if (savePlayerBatch(batch)) {
+			continue;
+		}
 
-	DBInsert spellsQuery("INSERT INTO `player_spells` (`player_id`, `name`) VALUES ");
-	for (const std::string& spellName : player->learnedInstantSpellList) {
-		if (!spellsQuery.addRow(fmt::format("{:d}, {:s}", player->getGUID(), db.escapeString(spellName)))) {
-			return false;
+		// the batch was rolled back as a whole; save its players one by one so a
+		// single broken character does not cost everyone else their save
+		if (batch.size() > 1) {
+			++playerSaveStats.fallbacks;
+			for (Player* player : batch) {
+				if (!savePlayerBatch({player})) {
+					std::cout << "[Error - IOLoginData::savePlayers] Failed to save player " << player->getName() << '.' << std::endl;
+					++failures;
+				}
+			}
+		} else {
+			std::cout << "[Error - IOLoginData::savePlayers] Failed to save player " << batch.front()->getName() << '.' << std::endl;
+			++failures;
 		}
 	}
 
-	if (!spellsQuery.execute()) {
-		return false;
-	}
+	const uint64_t micros = elapsedMicros(start);
+	++playerSaveStats.saves;
+	playerSaveStats.players += players.size();
+	playerSaveStats.failures += failures;
+	playerSaveStats.lastPlayers = players.size();
+	playerSaveStats.lastMicros = micros;
+	playerSaveStats.totalMicros += micros;
+	playerSaveStats.maxMicros = std::max(playerSaveStats.maxMicros, micros);
+	return failures == 0;
+}
 
-	//item saving
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_items` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+bool IOLoginData::savePlayerBatch(const std::vector<Player*>& players) {
+	Database& db = Database::getInstance();
 
-	DBInsert itemsQuery("INSERT INTO `player_items` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
+	std::vector<uint32_t> guids;
+	guids.reserve(players.size());
+	for (Player* player : players) {
+		if (player->isDead()) {
+			player->changeHealth(1);
+		}
+		guids.push_back(player->getGUID());
+	}
 
-	ItemBlockList itemList;
-	for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
-		Item* item = player->inventory[slotId];
-		if (item) {
-			itemList.emplace_back(slotId, item);
+	std::unordered_map<uint32_t, bool> saveFlags;
+	bool success = forEachInChunk(guids.size(), [&](size_t first, size_t count) {
+		DBStatementResult_ptr result = db.storeStatement("SELECT `id`, `save` FROM `players` WHERE `id` IN " + makeInList(count), DBParams(guids.begin() + first, guids.begin() + first + count));
+		if (!result) {
+			return false;
 		}
+
+		do {
+			saveFlags[result->getNumber<uint32_t>(0)] = result->getNumber<uint16_t>(1) != 0;
+		} while (result->next());
+		return true;
+	});
+
+	if (!success) {
+		return false;
 	}
 
-	if (!saveItems(player, itemList, itemsQuery, propWriteStream)) {
+	DBTransaction transaction;
+	if (!transaction.begin()) {
 		return false;
 	}
 
-	if (player->lastDepotId != -1) {
-		//save depot items
-		if (!db.executeQuery(fmt::format("DELETE FROM `player_depotitems` WHERE `player_id` = {:d}", player->getGUID()))) {
+	// the players rows are written one statement each, every other table once per batch
+	std::vector<Player*> saved;
+	std::vector<uint32_t> savedGuids;
+	saved.reserve(players.size());
+	savedGuids.reserve(players.size());
+
+	PropWriteStream propWriteStream;
+	for (Player* player : players) {
+		auto it = saveFlags.find(player->getGUID());
+		if (it == saveFlags.end()) {
 			return false;
 		}
 
-		DBInsert depotQuery("INSERT INTO `player_depotitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-		itemList.clear();
-
-		for (const auto& it : player->depotChests) {
-			for (Item* item : it.second->getItemList()) {
-				itemList.emplace_back(it.first, item);
+		if (!it->second) {
+			// save = 0 characters only get their last login recorded
+			if (!db.executeStatement("UPDATE `players` SET `lastlogin` = ?, `lastip` = INET6_ATON(?) WHERE `id` = ?", {player->lastLoginSaved, player->lastIP.to_string(), player->getGUID()})) {
+				return false;
 			}
+			continue;
 		}
 
-		if (!saveItems(player, itemList, depotQuery, propWriteStream)) {
+		if (!savePlayerRow(player, propWriteStream)) {
 			return false;
 		}
+
+		saved.push_back(player);
+		savedGuids.push_back(player->getGUID());
 	}
 
-	//save inbox items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_inboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
+	// learned spells
+	if (!deletePlayerRows(db, "player_spells", savedGuids)) {
 		return false;
 	}
 
-	DBInsert inboxQuery("INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-	itemList.clear();
-
-	for (Item* item : player->getInbox()->getItemList()) {
-		itemList.emplace_back(0, item);
+	DBStatementInsert spellsQuery(db, "INSERT INTO `player_spells` (`player_id`, `name`) VALUES ", 2);
+	for (const Player* player : saved) {
+		for (const std::string& spellName : player->learnedInstantSpellList) {
+			if (!spellsQuery.addRow({player->getGUID(), std::string{spellName}})) {
+				return false;
+			}
+		}
 	}
 
-	if (!saveItems(player, itemList, inboxQuery, propWriteStream)) {
+	if (!spellsQuery.execute()) {
 		return false;
 	}
 
-	//save store inbox items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_storeinboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	//item saving
+	const auto itemStart = std::chrono::steady_clock::now();
 
-	DBInsert storeInboxQuery("INSERT INTO `player_storeinboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-	itemList.clear();
+	const bool useBlobs = isItemBlobStorage();
+	ItemBlob itemBlob;
+	ItemBlockList itemList;
+	std::vector<const Player*> owners;
+	std::vector<uint32_t> ownerGuids;
+	for (uint8_t table = PLAYER_ITEMS_FIRST; table <= PLAYER_ITEMS_LAST; ++table) {
+		const auto itemTable = static_cast<PlayerItemTable>(table);
+
+		owners.clear();
+		ownerGuids.clear();
+		for (const Player* player : saved) {
+			if (hasItemTable(player, itemTable)) {
+				owners.push_back(player);
+				ownerGuids.push_back(player->getGUID());
+			}
+		}
 
-	for (Item* item : player->getStoreInbox()->getItemList()) {
-		itemList.emplace_back(0, item);
-	}
+		// clearing both formats moves the section over when itemStorage changed
+		const std::string_view tableName = getItemTableName(itemTable);
+		if (!deletePlayerRows(db, tableName, ownerGuids) || !deleteItemBlobs(db, itemTable, ownerGuids)) {
+			return false;
+		}
 
-	if (!saveItems(player, itemList, storeInboxQuery, propWriteStream)) {
-		return false;
-	}
+		if (useBlobs) {
+			DBStatementInsert blobQuery(db, std::string{ITEM_BLOB_INSERT}, 4);
+			for (const Player* player : owners) {
+				collectItems(player, itemTable, itemList);
+				if (!saveItemBlob(itemList, itemBlob, propWriteStream)) {
+					return false;
+				}
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_storage` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
+				if (itemBlob.getRowCount() != 0 && !addItemBlob(blobQuery, player->getGUID(), itemTable, itemBlob)) {
+					return false;
+				}
+			}
+
+			if (!blobQuery.execute()) {
+				return false;
+			}
+			continue;
+		}
+
+		DBStatementInsert itemsQuery(db, makeItemInsert(tableName), 6);
+		for (const Player* player : owners) {
+			collectItems(player, itemTable, itemList);
+			if (!saveItems(player, itemList, itemsQuery, propWriteStream)) {
+				return false;
+			}
+		}
+
+		if (!itemsQuery.execute()) {
+			return false;
+		}
 	}
+	itemSaveMicros.fetch_add(elapsedMicros(itemStart), std::memory_order_relaxed);
 
-	DBInsert storageQuery("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ");
+	// storage, only the keys that changed since the last save
+	DBStatementInsert storageQuery(db, makeStorageInsert("player_storage", "player_id"), 3, std::string{STORAGE_INSERT_SUFFIX});
+	for (const Player* player : saved) {
+		if (!player->storageMap.isDirty()) {
+			continue;
+		}
 
-	for (const auto& [key, value] : player->getStorageMap()) {
-		if (!storageQuery.addRow(fmt::format("{:d}, {:d}, {:d}", player->getGUID(), key, value))) {
+		if (!deleteStorage(player->storageMap, "player_storage", "player_id", player->getGUID()) || !addStorageRows(player->storageMap, player->getGUID(), storageQuery)) {
 			return false;
 		}
 	}
@@ -791,15 +1339,16 @@ bool IOLoginData::savePlayer(Player* player) {
 	}
 
 	// save outfits & addons
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_outfits` WHERE `player_id` = {:d}", player->getGUID()))) {
+	if (!deletePlayerRows(db, "player_outfits", savedGuids)) {
 		return false;
 	}
 
-	DBInsert outfitQuery("INSERT INTO `player_outfits` (`player_id`, `outfit_id`, `addons`) VALUES ");
-
-	for (const auto& it : player->outfits) {
-		if (!outfitQuery.addRow(fmt::format("{:d}, {:d}, {:d}", player->getGUID(), it.first, it.second))) {
-			return false;
+	DBStatementInsert outfitQuery(db, "INSERT INTO `player_outfits` (`player_id`, `outfit_id`, `addons`) VALUES ", 3);
+	for (const Player* player : saved) {
+		for (const auto& it : player->outfits) {
+			if (!outfitQuery.addRow({player->getGUID(), it.first, it.second})) {
+				return false;
+			}
 		}
 	}
 
@@ -808,15 +1357,16 @@ bool IOLoginData::savePlayer(Player* player) {
 	}
 
 	// save mounts
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_mounts` WHERE `player_id` = {:d}", player->getGUID()))) {
+	if (!deletePlayerRows(db, "player_mounts", savedGuids)) {
 		return false;
 	}
 
-	DBInsert mountQuery("INSERT INTO `player_mounts` (`player_id`, `mount_id`) VALUES ");
-
-	for (const auto& it : player->mounts) {
-		if (!mountQuery.addRow(fmt::format("{:d}, {:d}", player->getGUID(), it))) {
-			return false;
+	DBStatementInsert mountQuery(db, "INSERT INTO `player_mounts` (`player_id`, `mount_id`) VALUES ", 2);
+	for (const Player* player : saved) {
+		for (const auto& it : player->mounts) {
+			if (!mountQuery.addRow({player->getGUID(), it})) {
+				return false;
+			}
 		}
 	}
 
@@ -825,40 +1375,91 @@ bool IOLoginData::savePlayer(Player* player) {
 	}
 
 	//End the transaction
-	return transaction.commit();
+	if (!transaction.commit()) {
+		return false;
+	}
+
+	for (Player* player : saved) {
+		player->storageMap.markSaved();
+
+		// the group may have changed; keep name lookups in step with what was just written
+		cachePlayer(std::make_shared<CachedPlayer>(CachedPlayer{player->getName(), player->getGUID(), player->getAccount(), static_cast<uint16_t>(player->getGroup()->id)}));
+	}
+
+	// save = 0 characters included, the journal has nothing to replay for them either
+	for (const Player* player : players) {
+		g_playerJournal.logSaved(player->getGUID());
+	}
+	return true;
 }
 
-std::string IOLoginData::getNameByGuid(uint32_t guid) {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `name` FROM `players` WHERE `id` = {:d}", guid));
-	if (!result) {
-		return {};
+bool IOLoginData::saveStorage(const StorageMap& storage, std::string_view table, std::string_view ownerColumn, uint32_t ownerId) {
+	if (!storage.isDirty()) {
+		return true;
 	}
 
-	auto name = result->getString("name");
-	return {name.data(), name.size()};
+	DBStatementInsert storageQuery(Database::getInstance(), makeStorageInsert(table, ownerColumn), 3, std::string{STORAGE_INSERT_SUFFIX});
+	return deleteStorage(storage, table, ownerColumn, ownerId) && addStorageRows(storage, ownerId, storageQuery) && storageQuery.execute();
 }
 
-uint32_t IOLoginData::getGuidByName(const std::string& name) {
-	Database& db = Database::getInstance();
+void IOLoginData::invalidateAccount(uint32_t accountId) {
+	accountCache.eraseIf([accountId](const std::string&, const std::shared_ptr<const LoginAccount>& account) {
+		return account->id == accountId;
+	});
+}
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id` FROM `players` WHERE `name` = {:s}", db.escapeString(name)));
-	if (!result) {
-		return 0;
+void IOLoginData::clearCaches() {
+	accountCache.clear();
+	playerByIdCache.clear();
+	playerByNameCache.clear();
+}
+
+LRUCacheStatsList IOLoginData::getCacheStats() {
+	return {
+		{"accounts", accountCache.getStats()},
+		{"playersById", playerByIdCache.getStats()},
+		{"playersByName", playerByNameCache.getStats()},
+	};
+}
+
+ItemIOStats IOLoginData::getItemIOStats() {
+	ItemIOStats stats;
+	stats.rowsLoaded = itemRowsLoaded.load(std::memory_order_relaxed);
+	stats.loadMicros = itemLoadMicros.load(std::memory_order_relaxed);
+	stats.rowsSaved = itemRowsSaved.load(std::memory_order_relaxed);
+	stats.saveMicros = itemSaveMicros.load(std::memory_order_relaxed);
+	stats.blobsLoaded = itemBlobsLoaded.load(std::memory_order_relaxed);
+	stats.blobsSaved = itemBlobsSaved.load(std::memory_order_relaxed);
+	stats.blobBytesSaved = itemBlobBytesSaved.load(std::memory_order_relaxed);
+	return stats;
+}
+
+PlayerSaveStats IOLoginData::getPlayerSaveStats() {
+	return playerSaveStats;
+}
+
+std::string IOLoginData::getNameByGuid(uint32_t guid) {
+	auto player = getCachedPlayer(guid);
+	if (!player) {
+		return {};
 	}
-	return result->getNumber<uint32_t>("id");
+	return player->name;
 }
 
-bool IOLoginData::getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string& name) {
-	Database& db = Database::getInstance();
+uint32_t IOLoginData::getGuidByName(const std::string& name) {
+	auto player = getCachedPlayer(name);
+	return player ? player->guid : 0;
+}
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `name`, `id`, `group_id`, `account_id` FROM `players` WHERE `name` = {:s}", db.escapeString(name)));
-	if (!result) {
+bool IOLoginData::getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string& name) {
+	auto player = getCachedPlayer(name);
+	if (!player) {
 		return false;
 	}
 
-	name = result->getString("name");
-	guid = result->getNumber<uint32_t>("id");
-	Group* group = g_game.groups.getGroup(result->getNumber<uint16_t>("group_id"));
+	name = player->name;
+	guid = player->guid;
+	Group* group = g_game.groups.getGroup(player->groupId);
 
 	uint64_t flags;
 	if (group) {
@@ -872,39 +1473,78 @@ bool IOLoginData::getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string&
 }
 
 bool IOLoginData::formatPlayerName(std::string& name) {
-	Database& db = Database::getInstance();
-
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `name` FROM `players` WHERE `name` = {:s}", db.escapeString(name)));
-	if (!result) {
+	auto player = getCachedPlayer(name);
+	if (!player) {
 		return false;
 	}
 
-	name = result->getString("name");
+	name = player->name;
 	return true;
 }
 
-void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result) {
-	do {
-		uint32_t sid = result->getNumber<uint32_t>("sid");
-		uint32_t pid = result->getNumber<uint32_t>("pid");
-		uint16_t type = result->getNumber<uint16_t>("itemtype");
-		uint16_t count = result->getNumber<uint16_t>("count");
+bool IOLoginData::loadItems(ItemMap& itemMap, const ItemRowList& rows) {
+	if (rows.empty()) {
+		return false;
+	}
 
-		auto attr = result->getString("attributes");
+	const auto start = std::chrono::steady_clock::now();
 
+	itemRowsLoaded.fetch_add(rows.size(), std::memory_order_relaxed);
+
+	for (const ItemRow& row : rows) {
 		PropStream propStream;
-		propStream.init(attr.data(), attr.size());
+		propStream.init(row.attributes.data(), row.attributes.size());
 
-		Item* item = Item::CreateItem(type, count);
+		Item* item = Item::CreateItem(row.itemType, row.count);
 		if (item) {
 			if (!item->unserializeAttr(propStream)) {
 				std::cout << "WARNING: Serialize error in IOLoginData::loadItems" << std::endl;
 			}
 
-			std::pair<Item*, uint32_t> pair(item, pid);
-			itemMap[sid] = pair;
+			std::pair<Item*, uint32_t> pair(item, row.pid);
+			itemMap[row.sid] = pair;
 		}
-	} while (result->next());
+	}
+
+	itemLoadMicros.fetch_add(elapsedMicros(start), std::memory_order_relaxed);
+	return true;
+}
+
+void IOLoginData::placeItems(Player* player, PlayerItemTable table, const ItemMap& itemMap) {
+	for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
+		Item* item = it->second.first;
+		int32_t pid = it->second.second;
+
+		// top level items have a slot (inventory) or depot id as parent, the rest a sid
+		if (table == PLAYER_ITEMS_INVENTORY) {
+			if (pid >= CONST_SLOT_FIRST && pid <= CONST_SLOT_LAST) {
+				player->internalAddThing(pid, item);
+				continue;
+			}
+		} else if (pid >= 0 && pid < 100) {
+			if (table == PLAYER_ITEMS_DEPOT) {
+				const auto& depotChest = player->getDepotChest(pid, true);
+				if (depotChest) {
+					depotChest->internalAddThing(item);
+				}
+			} else if (table == PLAYER_ITEMS_INBOX) {
+				player->getInbox()->internalAddThing(item);
+			} else {
+				player->getStoreInbox()->internalAddThing(item);
+			}
+			continue;
+		}
+
+		ItemMap::const_iterator it2 = itemMap.find(pid);
+		if (it2 == itemMap.end()) {
+			continue;
+		}
+
+		Container* container = it2->second.first->getContainer();
+		if (container) {
+			container->internalAddThing(item);
+		}
+	}
 }
 
 void IOLoginData::increaseBankBalance(uint32_t guid, uint64_t bankBalance) {
@@ -950,4 +1590,5 @@ void IOLoginData::removeVIPEntry(uint32_t accountId, uint32_t guid) {
 
 void IOLoginData::updatePremiumTime(uint32_t accountId, time_t endTime) {
 	Database::getInstance().executeQuery(fmt::format("UPDATE `accounts` SET `premium_ends_at` = {:d} WHERE `id` = {:d}", endTime, accountId));
+	invalidateAccount(accountId);
 }
\ No newline at end of file
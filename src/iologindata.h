@@ -6,17 +6,102 @@
 
 #include "database.h"
 #include "enums.h"
+#include "itemblob.h"
+#include "lrucache.h"
 
 class Item;
 class Player;
 class PropWriteStream;
+class StorageMap;
 
 using ItemBlockList = std::list<std::pair<int32_t, Item*>>;
 
+// Tables holding the items of a player, in the order they are saved.
+enum PlayerItemTable : uint8_t {
+	PLAYER_ITEMS_INVENTORY,
+	PLAYER_ITEMS_DEPOT,
+	PLAYER_ITEMS_INBOX,
+	PLAYER_ITEMS_STORE_INBOX,
+
+	PLAYER_ITEMS_FIRST = PLAYER_ITEMS_INVENTORY,
+	PLAYER_ITEMS_LAST = PLAYER_ITEMS_STORE_INBOX,
+};
+
+// blob of each item section that has one, by PlayerItemTable
+using ItemBlobSections = std::array<std::string_view, PLAYER_ITEMS_LAST + 1>;
+
 struct VIPEntry;
 
+// Rows of one player, queried on any connection (e.g. a database worker) and
+// turned into game objects by IOLoginData::loadPlayer on the dispatcher.
+struct PlayerLoadData {
+	DBStatementResult_ptr player;
+	DBStatementResult_ptr account;
+	DBStatementResult_ptr guildMembership;
+	DBStatementResult_ptr guildWars;
+	DBStatementResult_ptr guildMembers;
+	DBStatementResult_ptr spells;
+	// by PlayerItemTable; a section found in itemBlobs is not queried from its row table
+	std::array<DBStatementResult_ptr, PLAYER_ITEMS_LAST + 1> items;
+	DBStatementResult_ptr itemBlobs;
+	ItemBlobSections itemBlobSections; // points into itemBlobs
+	DBStatementResult_ptr storage;
+	DBStatementResult_ptr vips;
+	DBStatementResult_ptr outfits;
+	DBStatementResult_ptr mounts;
+};
+
+// Account row and character list checked by the login and game servers.
+struct LoginAccount {
+	std::vector<std::string> characters;
+	std::string password; // SHA1 digest
+	std::string secret; // decoded authenticator key, empty if none
+	time_t premiumEndsAt = 0;
+	uint32_t id = 0;
+};
+
+// Cumulative item rows moved by loadPlayer/savePlayer and the time spent on them;
+// rows read from or written to item blobs are counted as well.
+struct ItemIOStats {
+	uint64_t rowsLoaded = 0;
+	uint64_t loadMicros = 0;
+	uint64_t rowsSaved = 0;
+	uint64_t saveMicros = 0;
+	uint64_t blobsLoaded = 0;
+	uint64_t blobsSaved = 0;
+	uint64_t blobBytesSaved = 0;
+};
+
+// Item sections of one player written and read back in both storage formats;
+// see IOLoginData::benchmarkItemStorage.
+struct ItemStorageBenchmark {
+	uint64_t rows = 0;
+	uint64_t rowBytes = 0;
+	uint64_t rowSaveMicros = 0;
+	uint64_t rowLoadMicros = 0;
+	uint64_t blobs = 0;
+	uint64_t blobBytes = 0;
+	uint64_t blobSaveMicros = 0;
+	uint64_t blobLoadMicros = 0;
+};
+
+// Server saves through IOLoginData::savePlayers; a fallback is a batch that was
+// rolled back and retried one player at a time.
+struct PlayerSaveStats {
+	uint64_t saves = 0;
+	uint64_t players = 0;
+	uint64_t batches = 0;
+	uint64_t fallbacks = 0;
+	uint64_t failures = 0;
+	uint64_t lastPlayers = 0;
+	uint64_t lastMicros = 0;
+	uint64_t maxMicros = 0;
+	uint64_t totalMicros = 0;
+};
+
 class IOLoginData {
 	public:
+		static std::shared_ptr<const LoginAccount> getLoginAccount(std::string_view accountName);
 		static std::pair<uint32_t, std::string> gameworldAuthentication(std::string_view accountName, std::string_view password, std::string_view characterName, std::string_view token, uint32_t tokenTime);
 		static uint32_t getAccountIdByPlayerName(const std::string& playerName);
 		static uint32_t getAccountIdByPlayerId(uint32_t playerId);
@@ -24,12 +109,20 @@ class IOLoginData {
 		static AccountType_t getAccountType(uint32_t accountId);
 		static void setAccountType(uint32_t accountId, AccountType_t accountType);
 		static void updateOnlineStatus(uint32_t guid, bool login);
-		static bool preloadPlayer(Player* player, const std::string& name);
+		static DBStatementResult_ptr loadPreloadData(Database& db, const std::string& name);
+		static bool preloadPlayer(Player* player, const DBStatementResult_ptr& result);
 
 		static bool loadPlayerById(Player* player, uint32_t id);
 		static bool loadPlayerByName(Player* player, const std::string& name);
-		static bool loadPlayer(Player* player, DBResult_ptr result);
+
+		// thread-safe: only runs queries on db and fills data
+		static bool loadPlayerById(Database& db, uint32_t id, PlayerLoadData& data);
+		// dispatcher thread
+		static bool loadPlayer(Player* player, PlayerLoadData& data);
 		static bool savePlayer(Player* player);
+		// playerSaveBatchSize players per transaction, every table written once per batch
+		static bool savePlayers(const std::vector<Player*>& players);
+		static bool saveStorage(const StorageMap& storage, std::string_view table, std::string_view ownerColumn, uint32_t ownerId);
 		static uint32_t getGuidByName(const std::string& name);
 		static bool getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string& name);
 		static std::string getNameByGuid(uint32_t guid);
@@ -44,11 +137,42 @@ class IOLoginData {
 
 		static void updatePremiumTime(uint32_t accountId, time_t endTime);
 
+		// visit(pid, sid, item, attributes) for every row saveItems would write, parents before children
+		using ItemRowVisitor = std::function<bool(int32_t, int32_t, const Item*, std::string_view)>;
+		static bool forEachItemRow(const ItemBlockList& itemList, PropWriteStream& propWriteStream, const ItemRowVisitor& visit);
+		static void collectItems(const Player* player, PlayerItemTable table, ItemBlockList& itemList);
+		static bool hasItemTable(const Player* player, PlayerItemTable table);
+		static std::string_view getItemTableName(PlayerItemTable table);
+
+		// itemStorage = "blob": one player_itemblobs row per section instead of a row per item.
+		// Either format is read back, and a section moves to the configured one when it is saved.
+		static bool isItemBlobStorage();
+		// Replaces one item section of a player with rows, in the configured format.
+		static bool saveItemRows(Database& db, uint32_t guid, PlayerItemTable table, const ItemRowList& rows);
+		// Moves up to limit sections still stored in the other format; returns how many moved.
+		static size_t convertItemStorage(size_t limit);
+		// Writes and reads back the items of player in both formats inside a transaction that is rolled back.
+		static std::optional<ItemStorageBenchmark> benchmarkItemStorage(const Player* player);
+
+		static ItemIOStats getItemIOStats();
+		static PlayerSaveStats getPlayerSaveStats();
+
+		// Account (accountCacheTTL) and name/guid (playerCacheTTL) caches; writes made outside the
+		// server are picked up once an entry expires or the caches are cleared.
+		static void invalidateAccount(uint32_t accountId);
+		static void clearCaches();
+		static LRUCacheStatsList getCacheStats();
+
 	private:
 		using ItemMap = std::map<uint32_t, std::pair<Item*, uint32_t>>;
 
-		static void loadItems(ItemMap& itemMap, DBResult_ptr result);
-		static bool saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert, PropWriteStream& propWriteStream);
+		static bool loadPlayerData(Database& db, DBStatementResult_ptr result, PlayerLoadData& data);
+		static bool loadItems(ItemMap& itemMap, const ItemRowList& rows);
+		static void placeItems(Player* player, PlayerItemTable table, const ItemMap& itemMap);
+		static bool savePlayerBatch(const std::vector<Player*>& players);
+		static bool savePlayerRow(Player* player, PropWriteStream& propWriteStream);
+		static bool saveItems(const Player* player, const ItemBlockList& itemList, DBStatementInsert& query_insert, PropWriteStream& propWriteStream);
+		static bool saveItemBlob(const ItemBlockList& itemList, ItemBlob& blob, PropWriteStream& propWriteStream);
 };
 
 #endif // FS_IOLOGINDATA_H
\ No newline at end of file
@@ -17,156 +17,164 @@ extern Game g_game;
 MarketOfferList IOMarket::getActiveOffers(MarketAction_t action, uint16_t itemId) {
 	MarketOfferList offerList;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `amount`, `price`, `created`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `sale` = {:d} AND `itemtype` = {:d}", static_cast<int>(action), itemId));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto book = market.offersByItem.find(getBookKey(action, itemId));
+	if (book == market.offersByItem.end()) {
 		return offerList;
 	}
 
 	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	do {
+	for (uint32_t offerId : book->second) {
+		const Offer& entry = market.offers.at(offerId);
+
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint32_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
+		offer.amount = entry.amount;
+		offer.price = entry.price;
+		offer.timestamp = entry.created + marketOfferDuration;
+		offer.counter = offerId & 0xFFFF;
 		offer.itemId = itemId;
-		if (result->getNumber<uint16_t>("anonymous") == 0) {
-			offer.playerName = result->getString("player_name");
+		if (!entry.anonymous) {
+			offer.playerName = entry.playerName;
 		} else {
 			offer.playerName = "Anonymous";
 		}
 		offerList.push_back(offer);
-	} while (result->next());
+	}
 	return offerList;
 }
 
 MarketOfferList IOMarket::getOwnOffers(MarketAction_t action, uint32_t playerId) {
 	MarketOfferList offerList;
 
-	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
-
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `amount`, `price`, `created`, `itemtype` FROM `market_offers` WHERE `player_id` = {:d} AND `sale` = {:d}", playerId, static_cast<int>(action)));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto own = market.offersByPlayer.find(playerId);
+	if (own == market.offersByPlayer.end()) {
 		return offerList;
 	}
 
-	do {
+	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
+
+	for (uint32_t offerId : own->second) {
+		const Offer& entry = market.offers.at(offerId);
+		if (entry.type != action) {
+			continue;
+		}
+
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint32_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
+		offer.amount = entry.amount;
+		offer.price = entry.price;
+		offer.timestamp = entry.created + marketOfferDuration;
+		offer.counter = offerId & 0xFFFF;
+		offer.itemId = entry.itemId;
 		offerList.push_back(offer);
-	} while (result->next());
+	}
 	return offerList;
 }
 
 HistoryMarketOfferList IOMarket::getOwnHistory(MarketAction_t action, uint32_t playerId) {
-	HistoryMarketOfferList offerList;
-
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `itemtype`, `amount`, `price`, `expires_at`, `state` FROM `market_history` WHERE `player_id` = {:d} AND `sale` = {:d}", playerId, static_cast<int>(action)));
-	if (!result) {
-		return offerList;
+	IOMarket& market = getInstance();
+	auto it = market.history.find(playerId);
+	if (it == market.history.end()) {
+		return {};
 	}
+	return it->second[action];
+}
 
-	do {
-		HistoryMarketOffer offer;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint32_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("expires_at");
-
-		MarketOfferState_t offerState = static_cast<MarketOfferState_t>(result->getNumber<uint16_t>("state"));
-		if (offerState == OFFERSTATE_ACCEPTEDEX) {
-			offerState = OFFERSTATE_ACCEPTED;
-		}
-
-		offer.state = offerState;
+void IOMarket::processExpiredOffer(uint32_t offerId) {
+	auto it = offers.find(offerId);
+	if (it == offers.end()) {
+		return;
+	}
 
-		offerList.push_back(offer);
-	} while (result->next());
-	return offerList;
-}
+	const Offer offer = it->second;
 
-void IOMarket::processExpiredOffers(DBResult_ptr result, bool) {
-	if (!result) {
+	// the seller's items are saved synchronously below, so the offer has to be
+	// gone from the database first or a crash in between hands them out twice
+	if (!Database::getInstance().executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId))) {
 		return;
 	}
 
-	do {
-		if (!IOMarket::moveOfferToHistory(result->getNumber<uint32_t>("id"), OFFERSTATE_EXPIRED)) {
-			continue;
+	removeOffer(it);
+	appendHistory(offer.playerId, offer.type, offer.itemId, offer.amount, offer.price, offer.created + getNumber(ConfigManager::MARKET_OFFER_DURATION), OFFERSTATE_EXPIRED);
+
+	if (offer.type == MARKETACTION_SELL) {
+		const ItemType& itemType = Item::items[offer.itemId];
+		if (itemType.id == 0) {
+			return;
 		}
 
-		const uint32_t playerId = result->getNumber<uint32_t>("player_id");
-		const uint16_t amount = result->getNumber<uint16_t>("amount");
-		if (result->getNumber<uint16_t>("sale") == 1) {
-			const ItemType& itemType = Item::items[result->getNumber<uint16_t>("itemtype")];
-			if (itemType.id == 0) {
-				continue;
+		Player* player = g_game.getPlayerByGUID(offer.playerId);
+		if (!player) {
+			player = new Player(nullptr);
+			if (!IOLoginData::loadPlayerById(player, offer.playerId)) {
+				delete player;
+				return;
 			}
+		}
 
-			Player* player = g_game.getPlayerByGUID(playerId);
-			if (!player) {
-				player = new Player(nullptr);
-				if (!IOLoginData::loadPlayerById(player, playerId)) {
-					delete player;
-					continue;
+		if (itemType.stackable) {
+			uint16_t tmpAmount = offer.amount;
+			while (tmpAmount > 0) {
+				uint16_t stackCount = std::min<uint16_t>(ITEM_STACK_SIZE, tmpAmount);
+				Item* item = Item::CreateItem(itemType.id, stackCount);
+				if (g_game.internalAddItem(player->getInbox().get(), item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+					delete item;
+					break;
 				}
-			}
 
-			if (itemType.stackable) {
-				uint16_t tmpAmount = amount;
-				while (tmpAmount > 0) {
-					uint16_t stackCount = std::min<uint16_t>(ITEM_STACK_SIZE, tmpAmount);
-					Item* item = Item::CreateItem(itemType.id, stackCount);
-					if (g_game.internalAddItem(player->getInbox().get(), item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
-						delete item;
-						break;
-					}
-
-					tmpAmount -= stackCount;
-				}
+				tmpAmount -= stackCount;
+			}
+		} else {
+			int32_t subType;
+			if (itemType.charges != 0) {
+				subType = itemType.charges;
 			} else {
-				int32_t subType;
-				if (itemType.charges != 0) {
-					subType = itemType.charges;
-				} else {
-					subType = -1;
-				}
+				subType = -1;
+			}
 
-				for (uint16_t i = 0; i < amount; ++i) {
-					Item* item = Item::CreateItem(itemType.id, subType);
-					if (g_game.internalAddItem(player->getInbox().get(), item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
-						delete item;
-						break;
-					}
+			for (uint16_t i = 0; i < offer.amount; ++i) {
+				Item* item = Item::CreateItem(itemType.id, subType);
+				if (g_game.internalAddItem(player->getInbox().get(), item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+					delete item;
+					break;
 				}
 			}
+		}
 
-			if (player->isOffline()) {
-				IOLoginData::savePlayer(player);
-				delete player;
-			}
-		} else {
-			uint64_t totalPrice = result->getNumber<uint64_t>("price") * amount;
+		if (player->isOffline()) {
+			IOLoginData::savePlayer(player);
+			delete player;
+		}
+	} else {
+		uint64_t totalPrice = static_cast<uint64_t>(offer.price) * offer.amount;
 
-			Player* player = g_game.getPlayerByGUID(playerId);
-			if (player) {
-				player->setBankBalance(player->getBankBalance() + totalPrice);
-			} else {
-				IOLoginData::increaseBankBalance(playerId, totalPrice);
-			}
+		Player* player = g_game.getPlayerByGUID(offer.playerId);
+		if (player) {
+			player->setBankBalance(player->getBankBalance() + totalPrice);
+		} else {
+			IOLoginData::increaseBankBalance(offer.playerId, totalPrice);
 		}
-	} while (result->next());
+	}
 }
 
 void IOMarket::checkExpiredOffers() {
 	const time_t lastExpireDate = time(nullptr) - getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	g_databaseTasks.addTask(fmt::format("SELECT `id`, `amount`, `price`, `itemtype`, `player_id`, `sale` FROM `market_offers` WHERE `created` <= {:d}", lastExpireDate), IOMarket::processExpiredOffers, true);
+	IOMarket& market = getInstance();
+
+	std::vector<uint32_t> expiredOffers;
+	for (const auto& it : market.offers) {
+		if (it.second.created <= lastExpireDate) {
+			expiredOffers.push_back(it.first);
+		}
+	}
+
+	for (uint32_t offerId : expiredOffers) {
+		market.processExpiredOffer(offerId);
+	}
+
+	market.pruneHistory(time(nullptr) - getNumber(ConfigManager::MARKET_HISTORY_DURATION));
 
 	int32_t checkExpiredMarketOffersEachMinutes = getNumber(ConfigManager::CHECK_EXPIRED_MARKET_OFFERS_EACH_MINUTES);
 	if (checkExpiredMarketOffersEachMinutes <= 0) {
@@ -177,94 +185,233 @@ void IOMarket::checkExpiredOffers() {
 }
 
 uint32_t IOMarket::getPlayerOfferCount(uint32_t playerId) {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT COUNT(*) AS `count` FROM `market_offers` WHERE `player_id` = {:d}", playerId));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.offersByPlayer.find(playerId);
+	if (it == market.offersByPlayer.end()) {
 		return 0;
 	}
-	return result->getNumber<int32_t>("count");
+	return it->second.size();
 }
 
 MarketOfferEx IOMarket::getOfferByCounter(uint32_t timestamp, uint16_t counter) {
 	MarketOfferEx offer;
+	offer.id = 0;
+	offer.playerId = 0;
 
-	const int32_t created = timestamp - getNumber(ConfigManager::MARKET_OFFER_DURATION);
+	const uint32_t created = timestamp - getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `sale`, `itemtype`, `amount`, `created`, `price`, `player_id`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `created` = {:d} AND (`id` & 65535) = {:d} LIMIT 1", created, counter));
-	if (!result) {
-		offer.id = 0;
-		offer.playerId = 0;
-		return offer;
-	}
+	// the counter is the low 16 bits of the id, so only every 65536th id can match
+	IOMarket& market = getInstance();
+	for (uint64_t offerId = counter; offerId < market.nextOfferId; offerId += 0x10000) {
+		auto it = market.offers.find(static_cast<uint32_t>(offerId));
+		if (it == market.offers.end() || it->second.created != created) {
+			continue;
+		}
 
-	offer.id = result->getNumber<uint32_t>("id");
-	offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
-	offer.amount = result->getNumber<uint16_t>("amount");
-	offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-	offer.timestamp = result->getNumber<uint32_t>("created");
-	offer.price = result->getNumber<uint32_t>("price");
-	offer.itemId = result->getNumber<uint16_t>("itemtype");
-	offer.playerId = result->getNumber<uint32_t>("player_id");
-	if (result->getNumber<uint16_t>("anonymous") == 0) {
-		offer.playerName = result->getString("player_name");
-	} else {
-		offer.playerName = "Anonymous";
+		const Offer& entry = it->second;
+		offer.id = it->first;
+		offer.type = entry.type;
+		offer.amount = entry.amount;
+		offer.counter = counter;
+		offer.timestamp = entry.created;
+		offer.price = entry.price;
+		offer.itemId = entry.itemId;
+		offer.playerId = entry.playerId;
+		if (!entry.anonymous) {
+			offer.playerName = entry.playerName;
+		} else {
+			offer.playerName = "Anonymous";
+		}
+		break;
 	}
 	return offer;
 }
 
-void IOMarket::createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous) {
-	Database::getInstance().executeQuery(fmt::format("INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", playerId, static_cast<int>(action), itemId, amount, price, time(nullptr), anonymous));
+void IOMarket::createOffer(uint32_t playerId, const std::string& playerName, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous) {
+	IOMarket& market = getInstance();
+
+	const uint32_t offerId = market.nextOfferId++;
+	const uint32_t created = time(nullptr);
+	market.addOffer(offerId, {playerName, playerId, created, price, amount, static_cast<uint16_t>(itemId), action, anonymous});
+
+	g_databaseTasks.addTask(fmt::format("INSERT INTO `market_offers` (`id`, `player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", offerId, playerId, static_cast<int>(action), itemId, amount, price, created, anonymous), nullptr, false, DatabaseTasks::makeOrderKey(DatabaseOrder::PLAYER, playerId));
 }
 
 void IOMarket::acceptOffer(uint32_t offerId, uint16_t amount) {
-	Database::getInstance().executeQuery(fmt::format("UPDATE `market_offers` SET `amount` = `amount` - {:d} WHERE `id` = {:d}", amount, offerId));
+	IOMarket& market = getInstance();
+	auto it = market.offers.find(offerId);
+	if (it == market.offers.end()) {
+		return;
+	}
+
+	Offer& offer = it->second;
+	offer.amount -= std::min(amount, offer.amount);
+
+	g_databaseTasks.addTask(fmt::format("UPDATE `market_offers` SET `amount` = `amount` - {:d} WHERE `id` = {:d}", amount, offerId), nullptr, false, DatabaseTasks::makeOrderKey(DatabaseOrder::PLAYER, offer.playerId));
 }
 
 void IOMarket::deleteOffer(uint32_t offerId) {
-	Database::getInstance().executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId));
+	IOMarket& market = getInstance();
+	auto it = market.offers.find(offerId);
+	if (it == market.offers.end()) {
+		return;
+	}
+
+	const uint32_t playerId = it->second.playerId;
+	market.removeOffer(it);
+
+	g_databaseTasks.addTask(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId), nullptr, false, DatabaseTasks::makeOrderKey(DatabaseOrder::PLAYER, playerId));
 }
 
 void IOMarket::appendHistory(uint32_t playerId, MarketAction_t action, uint16_t itemId, uint16_t amount, uint32_t price, time_t timestamp, MarketOfferState_t state) {
-	g_databaseTasks.addTask(fmt::format("INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", playerId, static_cast<int>(action), itemId, amount, price, timestamp, time(nullptr), static_cast<int>(state)));
+	const time_t inserted = time(nullptr);
+	getInstance().addHistory(playerId, action, {static_cast<uint32_t>(timestamp), price, itemId, amount, state, static_cast<uint32_t>(inserted)});
+
+	g_databaseTasks.addTask(fmt::format("INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", playerId, static_cast<int>(action), itemId, amount, price, timestamp, inserted, static_cast<int>(state)), nullptr, false, DatabaseTasks::makeOrderKey(DatabaseOrder::PLAYER, playerId));
 }
 
 bool IOMarket::moveOfferToHistory(uint32_t offerId, MarketOfferState_t state) {
-	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
+	IOMarket& market = getInstance();
+	auto it = market.offers.find(offerId);
+	if (it == market.offers.end()) {
+		return false;
+	}
+
+	const Offer offer = it->second;
+	market.removeOffer(it);
 
+	g_databaseTasks.addTask(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId), nullptr, false, DatabaseTasks::makeOrderKey(DatabaseOrder::PLAYER, offer.playerId));
+
+	appendHistory(offer.playerId, offer.type, offer.itemId, offer.amount, offer.price, offer.created + getNumber(ConfigManager::MARKET_OFFER_DURATION), state);
+	return true;
+}
+
+void IOMarket::load() {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `player_id`, `sale`, `itemtype`, `amount`, `price`, `created` FROM `market_offers` WHERE `id` = {:d}", offerId));
-	if (!result) {
-		return false;
+	offers.clear();
+	offersByItem.clear();
+	offersByPlayer.clear();
+	history.clear();
+	purchaseStatistics.clear();
+	saleStatistics.clear();
+	nextOfferId = 1;
+
+	DBResult_ptr result = db.storeQuery("SELECT MAX(`id`) AS `id` FROM `market_offers`");
+	if (result) {
+		nextOfferId = result->getNumber<uint32_t>("id") + 1;
 	}
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId))) {
-		return false;
+	if ((result = db.storeQuery("SELECT `o`.`id`, `o`.`player_id`, `o`.`sale`, `o`.`itemtype`, `o`.`amount`, `o`.`price`, `o`.`created`, `o`.`anonymous`, `p`.`name` FROM `market_offers` AS `o` LEFT JOIN `players` AS `p` ON `p`.`id` = `o`.`player_id`"))) {
+		do {
+			Offer offer;
+			offer.playerName = result->getString("name");
+			offer.playerId = result->getNumber<uint32_t>("player_id");
+			offer.created = result->getNumber<uint32_t>("created");
+			offer.price = result->getNumber<uint32_t>("price");
+			offer.amount = result->getNumber<uint16_t>("amount");
+			offer.itemId = result->getNumber<uint16_t>("itemtype");
+			offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
+			offer.anonymous = result->getNumber<uint16_t>("anonymous") != 0;
+			addOffer(result->getNumber<uint32_t>("id"), std::move(offer));
+		} while (result->next());
 	}
 
-	appendHistory(result->getNumber<uint32_t>("player_id"), static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale")), result->getNumber<uint16_t>("itemtype"), result->getNumber<uint16_t>("amount"), result->getNumber<uint32_t>("price"), result->getNumber<uint32_t>("created") + marketOfferDuration, state);
-	return true;
+	if ((result = db.storeQuery(fmt::format("SELECT `sale`, `itemtype`, COUNT(`price`) AS `num`, MIN(`price`) AS `min`, MAX(`price`) AS `max`, SUM(`price`) AS `sum` FROM `market_history` WHERE `state` = {:d} GROUP BY `itemtype`, `sale`", static_cast<int>(OFFERSTATE_ACCEPTED))))) {
+		do {
+			MarketStatistics& statistics = (result->getNumber<uint16_t>("sale") == MARKETACTION_BUY ? purchaseStatistics[result->getNumber<uint16_t>("itemtype")] : saleStatistics[result->getNumber<uint16_t>("itemtype")]);
+			statistics.numTransactions = result->getNumber<uint32_t>("num");
+			statistics.lowestPrice = result->getNumber<uint32_t>("min");
+			statistics.highestPrice = result->getNumber<uint32_t>("max");
+			statistics.totalPrice = result->getNumber<uint64_t>("sum");
+		} while (result->next());
+	}
+
+	// statistics above cover the whole table, own history only the recent part
+	const time_t historySince = time(nullptr) - getNumber(ConfigManager::MARKET_HISTORY_DURATION);
+	if ((result = db.storeQuery(fmt::format("SELECT `player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state` FROM `market_history` WHERE `inserted` >= {:d} ORDER BY `id`", historySince)))) {
+		do {
+			HistoryMarketOffer offer;
+			offer.itemId = result->getNumber<uint16_t>("itemtype");
+			offer.amount = result->getNumber<uint16_t>("amount");
+			offer.price = result->getNumber<uint32_t>("price");
+			offer.timestamp = result->getNumber<uint32_t>("expires_at");
+			offer.state = static_cast<MarketOfferState_t>(result->getNumber<uint16_t>("state"));
+			offer.inserted = result->getNumber<uint32_t>("inserted");
+			addHistory(result->getNumber<uint32_t>("player_id"), static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale")), offer, false);
+		} while (result->next());
+	}
 }
 
-void IOMarket::updateStatistics() {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `sale` AS `sale`, `itemtype` AS `itemtype`, COUNT(`price`) AS `num`, MIN(`price`) AS `min`, MAX(`price`) AS `max`, SUM(`price`) AS `sum` FROM `market_history` WHERE `state` = {:d} GROUP BY `itemtype`, `sale`", static_cast<int>(OFFERSTATE_ACCEPTED)));
-	if (!result) {
+void IOMarket::addOffer(uint32_t offerId, Offer&& offer) {
+	offersByItem[getBookKey(offer.type, offer.itemId)].insert(offerId);
+	offersByPlayer[offer.playerId].insert(offerId);
+	offers.emplace(offerId, std::move(offer));
+}
+
+void IOMarket::removeOffer(std::map<uint32_t, Offer>::iterator it) {
+	const Offer& offer = it->second;
+
+	auto book = offersByItem.find(getBookKey(offer.type, offer.itemId));
+	if (book != offersByItem.end()) {
+		book->second.erase(it->first);
+		if (book->second.empty()) {
+			offersByItem.erase(book);
+		}
+	}
+
+	auto own = offersByPlayer.find(offer.playerId);
+	if (own != offersByPlayer.end()) {
+		own->second.erase(it->first);
+		if (own->second.empty()) {
+			offersByPlayer.erase(own);
+		}
+	}
+
+	offers.erase(it);
+}
+
+void IOMarket::addHistory(uint32_t playerId, MarketAction_t action, const HistoryMarketOffer& offer, bool countStatistics) {
+	if (action != MARKETACTION_BUY && action != MARKETACTION_SELL) {
 		return;
 	}
 
-	do {
-		MarketStatistics* statistics;
-		if (result->getNumber<uint16_t>("sale") == MARKETACTION_BUY) {
-			statistics = &purchaseStatistics[result->getNumber<uint16_t>("itemtype")];
+	if (countStatistics && offer.state == OFFERSTATE_ACCEPTED) {
+		MarketStatistics& statistics = (action == MARKETACTION_BUY ? purchaseStatistics[offer.itemId] : saleStatistics[offer.itemId]);
+		if (statistics.numTransactions == 0) {
+			statistics.lowestPrice = offer.price;
+			statistics.highestPrice = offer.price;
 		} else {
-			statistics = &saleStatistics[result->getNumber<uint16_t>("itemtype")];
+			statistics.lowestPrice = std::min(statistics.lowestPrice, offer.price);
+			statistics.highestPrice = std::max(statistics.highestPrice, offer.price);
+		}
+		++statistics.numTransactions;
+		statistics.totalPrice += offer.price;
+	}
+
+	HistoryMarketOffer& entry = history[playerId][action].emplace_back(offer);
+	if (entry.state == OFFERSTATE_ACCEPTEDEX) {
+		entry.state = OFFERSTATE_ACCEPTED;
+	}
+}
+
+void IOMarket::pruneHistory(time_t since) {
+	for (auto it = history.begin(); it != history.end();) {
+		bool empty = true;
+		for (HistoryMarketOfferList& offers : it->second) {
+			// oldest first, in the order they were added
+			while (!offers.empty() && offers.front().inserted < since) {
+				offers.pop_front();
+			}
+			empty = empty && offers.empty();
 		}
 
-		statistics->numTransactions = result->getNumber<uint32_t>("num");
-		statistics->lowestPrice = result->getNumber<uint32_t>("min");
-		statistics->totalPrice = result->getNumber<uint64_t>("sum");
-		statistics->highestPrice = result->getNumber<uint32_t>("max");
-	} while (result->next());
+		if (empty) {
+			it = history.erase(it);
+		} else {
+			++it;
+		}
+	}
 }
 
 MarketStatistics* IOMarket::getPurchaseStatistics(uint16_t itemId) {
@@ -7,6 +7,17 @@
 #include "database.h"
 #include "enums.h"
 
+/**
+ * Market order book.
+ *
+ * Active offers, per-player history and the price statistics are loaded once
+ * at startup and kept in memory; every browse request is answered from here.
+ * Mutations update the book first and are then written through to the
+ * database as asynchronous tasks ordered by the owning player, so the INSERT
+ * of an offer always reaches the database before its UPDATE or DELETE.
+ * Offer ids are assigned here, which assumes nothing else inserts into
+ * `market_offers` while the server is running.
+ */
 class IOMarket {
 	public:
 		static IOMarket& getInstance() {
@@ -18,20 +29,19 @@ class IOMarket {
 		static MarketOfferList getOwnOffers(MarketAction_t action, uint32_t playerId);
 		static HistoryMarketOfferList getOwnHistory(MarketAction_t action, uint32_t playerId);
 
-		static void processExpiredOffers(DBResult_ptr result, bool);
 		static void checkExpiredOffers();
 
 		static uint32_t getPlayerOfferCount(uint32_t playerId);
 		static MarketOfferEx getOfferByCounter(uint32_t timestamp, uint16_t counter);
 
-		static void createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous);
+		static void createOffer(uint32_t playerId, const std::string& playerName, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous);
 		static void acceptOffer(uint32_t offerId, uint16_t amount);
 		static void deleteOffer(uint32_t offerId);
 
 		static void appendHistory(uint32_t playerId, MarketAction_t type, uint16_t itemId, uint16_t amount, uint32_t price, time_t timestamp, MarketOfferState_t state);
 		static bool moveOfferToHistory(uint32_t offerId, MarketOfferState_t state);
 
-		void updateStatistics();
+		void load();
 
 		MarketStatistics* getPurchaseStatistics(uint16_t itemId);
 		MarketStatistics* getSaleStatistics(uint16_t itemId);
@@ -39,8 +49,36 @@ class IOMarket {
 	private:
 		IOMarket() = default;
 
+		struct Offer {
+			std::string playerName;
+			uint32_t playerId;
+			uint32_t created;
+			uint32_t price;
+			uint16_t amount;
+			uint16_t itemId;
+			MarketAction_t type;
+			bool anonymous;
+		};
+
+		static uint32_t getBookKey(MarketAction_t action, uint16_t itemId) {
+			return (static_cast<uint32_t>(itemId) << 1) | static_cast<uint32_t>(action);
+		}
+
+		void addOffer(uint32_t offerId, Offer&& offer);
+		void removeOffer(std::map<uint32_t, Offer>::iterator it);
+		void addHistory(uint32_t playerId, MarketAction_t action, const HistoryMarketOffer& offer, bool countStatistics = true);
+		void processExpiredOffer(uint32_t offerId);
+		// drops own history older than marketHistoryDuration, as a restart would
+		void pruneHistory(time_t since);
+
+		std::map<uint32_t, Offer> offers;
+		std::unordered_map<uint32_t, std::set<uint32_t>> offersByItem;
+		std::unordered_map<uint32_t, std::set<uint32_t>> offersByPlayer;
+		std::unordered_map<uint32_t, std::array<HistoryMarketOfferList, 2>> history;
+		uint32_t nextOfferId = 1;
+
 		std::map<uint16_t, MarketStatistics> purchaseStatistics;
 		std::map<uint16_t, MarketStatistics> saleStatistics;
 };
 
-#endif // FS_IOMARKET_H
\ No newline at end of file
+#endif // FS_IOMARKET_H
@@ -159,10 +159,11 @@ Item* Item::clone() const {
 	Item* item = Item::CreateItem(id, count);
 	if (attributes) {
 		item->attributes.reset(new ItemAttributes(*attributes));
+		if (decayIndex != DECAY_INDEX_NONE) {
+			item->setIntAttr(ITEM_ATTRIBUTE_DURATION, getDuration());
+		}
 		if (item->getDuration() > 0) {
-			item->incrementReferenceCounter();
-			item->setDecaying(DECAYING_TRUE);
-			g_game.toDecayItems.push_front(item);
+			g_game.scheduleDecay(item);
 		}
 	}
 	return item;
@@ -232,6 +233,24 @@ void Item::onRemoved() {
 	}
 }
 
+void Item::setDuration(int32_t time) {
+	setIntAttr(ITEM_ATTRIBUTE_DURATION, time);
+	if (decayIndex != DECAY_INDEX_NONE) {
+		g_game.setDecayDeadline(this, OTSYS_TIME() + std::max<int32_t>(0, time));
+	}
+}
+
+uint32_t Item::getDuration() const {
+	if (!attributes) {
+		return 0;
+	}
+
+	if (decayIndex != DECAY_INDEX_NONE && hasAttribute(ITEM_ATTRIBUTE_DURATION)) {
+		return std::max<int64_t>(0, decayDeadline - OTSYS_TIME());
+	}
+	return getIntAttr(ITEM_ATTRIBUTE_DURATION);
+}
+
 void Item::setID(uint16_t newid) {
 	const ItemType& prevIt = Item::items[id];
 	id = newid;
@@ -739,7 +758,7 @@ void Item::serializeAttr(PropWriteStream& propWriteStream) const {
 
 	if (hasAttribute(ITEM_ATTRIBUTE_DURATION)) {
 		propWriteStream.write<uint8_t>(ATTR_DURATION);
-		propWriteStream.write<uint32_t>(getIntAttr(ITEM_ATTRIBUTE_DURATION));
+		propWriteStream.write<uint32_t>(getDuration());
 	}
 
 	ItemDecayState_t decayState = getDecaying();
@@ -1736,8 +1755,7 @@ bool Item::hasMarketAttributes() const {
 				return false;
 			}
 		} else if (attr.type == ITEM_ATTRIBUTE_DURATION) {
-			uint32_t duration = static_cast<uint32_t>(attr.value.integer);
-			if (duration != getDefaultDuration()) {
+			if (getDuration() != getDefaultDuration()) {
 				return false;
 			}
 		} else {
@@ -745,18 +745,10 @@ class Item : virtual public Thing {
 			return getIntAttr(ITEM_ATTRIBUTE_CORPSEOWNER);
 		}
 
-		void setDuration(int32_t time) {
-			setIntAttr(ITEM_ATTRIBUTE_DURATION, time);
-		}
-		void decreaseDuration(int32_t time) {
-			increaseIntAttr(ITEM_ATTRIBUTE_DURATION, -time);
-		}
-		uint32_t getDuration() const {
-			if (!attributes) {
-				return 0;
-			}
-			return getIntAttr(ITEM_ATTRIBUTE_DURATION);
-		}
+		// while the item is decaying the stored duration is only refreshed
+		// when decay stops, these go through its deadline instead
+		void setDuration(int32_t time);
+		uint32_t getDuration() const;
 
 		void setDecaying(ItemDecayState_t decayState) {
 			setIntAttr(ITEM_ATTRIBUTE_DECAYSTATE, decayState);
@@ -1049,7 +1041,15 @@ class Item : virtual public Thing {
 
 		bool loadedFromMap = false;
 
+		// scheduling state of Game's decay heap rather than an attribute: it is
+		// never saved or copied and must not cost an allocation per item
+		static constexpr uint32_t DECAY_INDEX_NONE = std::numeric_limits<uint32_t>::max();
+		uint32_t decayIndex = DECAY_INDEX_NONE;
+		int64_t decayDeadline = 0;
+
 		//Don't add variables here, use the ItemAttribute class.
+
+		friend class Game;
 };
 
 using ItemList = std::list<Item*>;
@@ -0,0 +1,143 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "itemblob.h"
+
+#include <zlib.h>
+
+namespace {
+
+constexpr size_t HEADER_SIZE = sizeof(uint8_t) + sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint32_t);
+
+// pid, sid, itemtype, count and attribute size
+constexpr size_t FIXED_ROW_SIZE = sizeof(int32_t) + sizeof(int32_t) + sizeof(uint16_t) + sizeof(uint16_t) + sizeof(uint32_t);
+
+template <typename T>
+void appendValue(std::string& out, T value) {
+	out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void appendColumn(std::string& out, const std::vector<T>& column) {
+	out.append(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+}
+
+template <typename T>
+T readValue(const char* data) {
+	T value;
+	std::memcpy(&value, data, sizeof(T));
+	return value;
+}
+
+} // namespace
+
+void ItemBlob::clear() {
+	pids.clear();
+	sids.clear();
+	itemTypes.clear();
+	counts.clear();
+	attributeSizes.clear();
+	attributes.clear();
+}
+
+void ItemBlob::addRow(int32_t pid, int32_t sid, uint16_t itemType, uint16_t count, std::string_view attributes) {
+	pids.push_back(pid);
+	sids.push_back(sid);
+	itemTypes.push_back(itemType);
+	counts.push_back(count);
+	attributeSizes.push_back(attributes.size());
+	this->attributes.append(attributes);
+}
+
+std::string ItemBlob::encode(bool compress) const {
+	const uint32_t rows = pids.size();
+	if (rows * FIXED_ROW_SIZE + attributes.size() > MAX_BODY_SIZE) {
+		return {};
+	}
+
+	std::string body;
+	body.reserve(rows * FIXED_ROW_SIZE + attributes.size());
+	appendColumn(body, pids);
+	appendColumn(body, sids);
+	appendColumn(body, itemTypes);
+	appendColumn(body, counts);
+	appendColumn(body, attributeSizes);
+	body.append(attributes);
+
+	std::string blob;
+	blob.reserve(HEADER_SIZE + body.size());
+	appendValue<uint8_t>(blob, VERSION);
+
+	if (compress) {
+		uLongf compressedSize = compressBound(body.size());
+		std::string compressed(compressedSize, '\0');
+		// speed over ratio, this runs on the dispatcher during saves
+		if (compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressedSize, reinterpret_cast<const Bytef*>(body.data()), body.size(), Z_BEST_SPEED) == Z_OK && compressedSize < body.size()) {
+			appendValue<uint8_t>(blob, ITEM_BLOB_COMPRESSED);
+			appendValue<uint32_t>(blob, rows);
+			appendValue<uint32_t>(blob, body.size());
+			blob.append(compressed.data(), compressedSize);
+			return blob;
+		}
+	}
+
+	appendValue<uint8_t>(blob, 0);
+	appendValue<uint32_t>(blob, rows);
+	appendValue<uint32_t>(blob, body.size());
+	blob.append(body);
+	return blob;
+}
+
+bool ItemBlob::decode(std::string_view blob, std::string& buffer, ItemRowList& rows) {
+	rows.clear();
+	if (blob.size() < HEADER_SIZE || readValue<uint8_t>(blob.data()) != VERSION) {
+		return false;
+	}
+
+	const uint8_t flags = readValue<uint8_t>(blob.data() + 1);
+	const uint32_t rowCount = readValue<uint32_t>(blob.data() + 2);
+	const uint32_t bodySize = readValue<uint32_t>(blob.data() + 6);
+	// the size comes from the database, don't let it pick how much to allocate
+	if (bodySize > MAX_BODY_SIZE || bodySize < static_cast<uint64_t>(rowCount) * FIXED_ROW_SIZE) {
+		return false;
+	}
+
+	std::string_view body = blob.substr(HEADER_SIZE);
+	if (flags & ITEM_BLOB_COMPRESSED) {
+		buffer.resize(bodySize);
+		uLongf size = bodySize;
+		if (uncompress(reinterpret_cast<Bytef*>(buffer.data()), &size, reinterpret_cast<const Bytef*>(body.data()), body.size()) != Z_OK || size != bodySize) {
+			return false;
+		}
+		body = buffer;
+	} else if (body.size() != bodySize) {
+		return false;
+	}
+
+	const char* pidColumn = body.data();
+	const char* sidColumn = pidColumn + rowCount * sizeof(int32_t);
+	const char* itemTypeColumn = sidColumn + rowCount * sizeof(int32_t);
+	const char* countColumn = itemTypeColumn + rowCount * sizeof(uint16_t);
+	const char* sizeColumn = countColumn + rowCount * sizeof(uint16_t);
+	const char* attributeData = sizeColumn + rowCount * sizeof(uint32_t);
+	const char* end = body.data() + body.size();
+
+	rows.reserve(rowCount);
+	for (uint32_t i = 0; i < rowCount; ++i) {
+		const uint32_t attributeSize = readValue<uint32_t>(sizeColumn + i * sizeof(uint32_t));
+		if (attributeSize > static_cast<size_t>(end - attributeData)) {
+			return false;
+		}
+
+		ItemRow& row = rows.emplace_back();
+		row.pid = readValue<int32_t>(pidColumn + i * sizeof(int32_t));
+		row.sid = readValue<int32_t>(sidColumn + i * sizeof(int32_t));
+		row.itemType = readValue<uint16_t>(itemTypeColumn + i * sizeof(uint16_t));
+		row.count = readValue<uint16_t>(countColumn + i * sizeof(uint16_t));
+		row.attributes = {attributeData, attributeSize};
+		attributeData += attributeSize;
+	}
+	return attributeData == end;
+}
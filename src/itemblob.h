@@ -0,0 +1,58 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_ITEMBLOB_H
+#define FS_ITEMBLOB_H
+
+// One row of a player item section, whichever format it was stored in;
+// attributes points into the result or blob it was read from.
+struct ItemRow {
+	int32_t pid = 0;
+	int32_t sid = 0;
+	uint16_t itemType = 0;
+	uint16_t count = 0;
+	std::string_view attributes;
+};
+
+using ItemRowList = std::vector<ItemRow>;
+
+/**
+ * The rows of one item section packed into a single value, column by column:
+ * every pid, then every sid, item type, count and attribute size, followed by
+ * the attribute bytes. Keeping alike values together lets a depot of
+ * thousands of items compress to a fraction of its row size.
+ *
+ * Layout: version (u8), flags (u8), rows (u32), body size (u32), body; the
+ * body is zlib compressed when ITEM_BLOB_COMPRESSED is set.
+ */
+class ItemBlob {
+	public:
+		static constexpr uint8_t VERSION = 1;
+		static constexpr uint8_t ITEM_BLOB_COMPRESSED = 1 << 0;
+		// what a MEDIUMBLOB holds; also bounds the buffer a compressed body is inflated into
+		static constexpr uint32_t MAX_BODY_SIZE = 16 * 1024 * 1024;
+
+		void clear();
+		void addRow(int32_t pid, int32_t sid, uint16_t itemType, uint16_t count, std::string_view attributes);
+
+		size_t getRowCount() const {
+			return pids.size();
+		}
+
+		// compressed only if compress is set and it comes out smaller;
+		// empty if the body would exceed MAX_BODY_SIZE
+		std::string encode(bool compress) const;
+
+		// rows point into blob, or into buffer when the blob is compressed
+		static bool decode(std::string_view blob, std::string& buffer, ItemRowList& rows);
+
+	private:
+		std::vector<int32_t> pids;
+		std::vector<int32_t> sids;
+		std::vector<uint16_t> itemTypes;
+		std::vector<uint16_t> counts;
+		std::vector<uint32_t> attributeSizes;
+		std::string attributes;
+};
+
+#endif // FS_ITEMBLOB_H
@@ -0,0 +1,142 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_LRUCACHE_H
+#define FS_LRUCACHE_H
+
+struct LRUCacheStats {
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t evictions = 0;
+	uint64_t invalidations = 0;
+	size_t size = 0;
+	size_t capacity = 0;
+};
+
+using LRUCacheStatsList = std::vector<std::pair<std::string_view, LRUCacheStats>>;
+
+// Bounded, thread-safe least-recently-used cache. Entries may carry a time to
+// live; an expired entry counts as a miss and is dropped on lookup.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LRUCache {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		explicit LRUCache(size_t capacity) : capacity(capacity) {}
+
+		// non-copyable
+		LRUCache(const LRUCache&) = delete;
+		LRUCache& operator=(const LRUCache&) = delete;
+
+		std::optional<Value> get(const Key& key) {
+			std::lock_guard<std::mutex> lockGuard(cacheLock);
+			auto it = index.find(key);
+			if (it == index.end()) {
+				++stats.misses;
+				return std::nullopt;
+			}
+
+			if (it->second->expiresAt != Clock::time_point{} && Clock::now() >= it->second->expiresAt) {
+				entries.erase(it->second);
+				index.erase(it);
+				++stats.misses;
+				return std::nullopt;
+			}
+
+			entries.splice(entries.begin(), entries, it->second);
+			++stats.hits;
+			return it->second->value;
+		}
+
+		// Looks an entry up without refreshing it or counting a hit or miss.
+		std::optional<Value> peek(const Key& key) {
+			std::lock_guard<std::mutex> lockGuard(cacheLock);
+			auto it = index.find(key);
+			if (it == index.end() || (it->second->expiresAt != Clock::time_point{} && Clock::now() >= it->second->expiresAt)) {
+				return std::nullopt;
+			}
+			return it->second->value;
+		}
+
+		// ttl of zero keeps the entry until it is evicted or invalidated
+		void put(const Key& key, Value value, std::chrono::milliseconds ttl = std::chrono::milliseconds::zero()) {
+			const Clock::time_point expiresAt = ttl.count() > 0 ? Clock::now() + ttl : Clock::time_point{};
+
+			std::lock_guard<std::mutex> lockGuard(cacheLock);
+			auto it = index.find(key);
+			if (it != index.end()) {
+				it->second->value = std::move(value);
+				it->second->expiresAt = expiresAt;
+				entries.splice(entries.begin(), entries, it->second);
+				return;
+			}
+
+			if (capacity == 0) {
+				return;
+			}
+
+			if (entries.size() >= capacity) {
+				index.erase(entries.back().key);
+				entries.pop_back();
+				++stats.evictions;
+			}
+
+			entries.push_front({key, std::move(value), expiresAt});
+			index.emplace(key, entries.begin());
+		}
+
+		void erase(const Key& key) {
+			std::lock_guard<std::mutex> lockGuard(cacheLock);
+			auto it = index.find(key);
+			if (it != index.end()) {
+				entries.erase(it->second);
+				index.erase(it);
+				++stats.invalidations;
+			}
+		}
+
+		// Drops every entry for which pred(key, value) holds; for write paths that only know a secondary key.
+		template <typename Predicate>
+		void eraseIf(Predicate&& pred) {
+			std::lock_guard<std::mutex> lockGuard(cacheLock);
+			for (auto it = entries.begin(); it != entries.end();) {
+				if (pred(it->key, it->value)) {
+					index.erase(it->key);
+					it = entries.erase(it);
+					++stats.invalidations;
+				} else {
+					++it;
+				}
+			}
+		}
+
+		void clear() {
+			std::lock_guard<std::mutex> lockGuard(cacheLock);
+			stats.invalidations += entries.size();
+			entries.clear();
+			index.clear();
+		}
+
+		LRUCacheStats getStats() {
+			std::lock_guard<std::mutex> lockGuard(cacheLock);
+			LRUCacheStats result = stats;
+			result.size = entries.size();
+			result.capacity = capacity;
+			return result;
+		}
+
+	private:
+		struct Entry {
+			Key key;
+			Value value;
+			Clock::time_point expiresAt;
+		};
+
+		std::mutex cacheLock;
+		std::list<Entry> entries;
+		std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;
+		size_t capacity;
+		LRUCacheStats stats;
+};
+
+#endif // FS_LRUCACHE_H
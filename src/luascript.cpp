@@ -5,11 +5,13 @@
 
 #include "luascript.h"
 
+#include "ban.h"
 #include "bed.h"
 #include "chat.h"
 #include "configmanager.h"
 #include "databasemanager.h"
 #include "databasetasks.h"
+#include "dbstats.h"
 #include "depotchest.h"
 #include "events.h"
 #include "game/game.h"
@@ -29,6 +31,7 @@
 #include "outfit.h"
 #include "party.h"
 #include "player.h"
+#include "playerjournal.h"
 #include "protocolstatus.h"
 #include "scheduler.h"
 #include "script.h"
@@ -486,7 +489,7 @@ int lua::protectedCall(lua_State* L, int nargs, int nresults) {
         return ret;
 }
 
-int32_t LuaScriptInterface::loadFile(const std::string& file, Npc* npc /* = nullptr*/) {
+int32_t LuaScriptInterface::loadFile(const std::string& file, Npc* npc /* = nullptr*/, int32_t environment /* = LUA_NOREF*/) {
 	//loads file as a chunk at stack top
 	int ret = luaL_loadfile(L, file.data());
 	if (ret != 0) {
@@ -500,6 +503,16 @@ int32_t LuaScriptInterface::loadFile(const std::string& file, Npc* npc /* = null
 		return -1;
 	}
 
+	//run the chunk against the given table instead of the globals
+	if (environment != LUA_NOREF) {
+		lua_rawgeti(L, LUA_REGISTRYINDEX, environment);
+#if LUA_VERSION_NUM >= 502
+		lua_setupvalue(L, -2, 1);
+#else
+		lua_setfenv(L, -2);
+#endif
+	}
+
         loadingFile = file;
         lastLuaError.clear();
 
@@ -678,6 +691,7 @@ bool LuaScriptInterface::closeState() {
 	}
 
 	cacheFiles.clear();
+	g_luaEnvironment.clearTimerScriptStats(this);
 	if (eventTableRef != -1) {
 		luaL_unref(L, LUA_REGISTRYINDEX, eventTableRef);
 		eventTableRef = -1;
@@ -2274,6 +2288,21 @@ void LuaScriptInterface::registerFunctions() {
 	registerMethod(L, "Game", "setAccountStorageValue", LuaScriptInterface::luaGameSetAccountStorageValue);
 	registerMethod(L, "Game", "saveAccountStorageValues", LuaScriptInterface::luaGameSaveAccountStorageValues);
 
+	registerMethod(L, "Game", "getTimerEventStats", LuaScriptInterface::luaGameGetTimerEventStats);
+	registerMethod(L, "Game", "getItemIOStats", LuaScriptInterface::luaGameGetItemIOStats);
+	registerMethod(L, "Game", "getPlayerSaveStats", LuaScriptInterface::luaGameGetPlayerSaveStats);
+	registerMethod(L, "Game", "getPlayerJournalStats", LuaScriptInterface::luaGameGetPlayerJournalStats);
+	registerMethod(L, "Game", "convertItemStorage", LuaScriptInterface::luaGameConvertItemStorage);
+	registerMethod(L, "Game", "benchmarkItemStorage", LuaScriptInterface::luaGameBenchmarkItemStorage);
+	registerMethod(L, "Game", "benchmarkConditions", LuaScriptInterface::luaGameBenchmarkConditions);
+	registerMethod(L, "Game", "benchmarkMonsterThink", LuaScriptInterface::luaGameBenchmarkMonsterThink);
+	registerMethod(L, "Game", "getCreatureCheckStats", LuaScriptInterface::luaGameGetCreatureCheckStats);
+	registerMethod(L, "Game", "getLoginStats", LuaScriptInterface::luaGameGetLoginStats);
+	registerMethod(L, "Game", "getClientUpdateStats", LuaScriptInterface::luaGameGetClientUpdateStats);
+	registerMethod(L, "Game", "getLoginCacheStats", LuaScriptInterface::luaGameGetLoginCacheStats);
+	registerMethod(L, "Game", "clearLoginCache", LuaScriptInterface::luaGameClearLoginCache);
+	registerMethod(L, "Game", "clearBanCache", LuaScriptInterface::luaGameClearBanCache);
+
 	// Variant
 	registerClass(L, "Variant", "", LuaScriptInterface::luaVariantCreate);
 
@@ -3814,39 +3843,18 @@ int LuaScriptInterface::luaAddEvent(lua_State* L) {
 	uint32_t delay = std::max<uint32_t>(100, lua::getNumber<uint32_t>(L, 2));
 	lua_pop(L, 1);
 
+	ScriptEnvironment* env = lua::getScriptEnv();
 	eventDesc.function = luaL_ref(L, LUA_REGISTRYINDEX);
-	eventDesc.scriptId = lua::getScriptEnv()->getScriptId();
-
-	auto& lastTimerEventId = g_luaEnvironment.lastEventTimerId;
-	eventDesc.eventId = g_scheduler.addEvent(createSchedulerTask(delay, [=]() { g_luaEnvironment.executeTimerEvent(lastTimerEventId); }));
+	eventDesc.scriptId = env->getScriptId();
 
-	g_luaEnvironment.timerEvents.emplace(lastTimerEventId, std::move(eventDesc));
-	lua_pushnumber(L, lastTimerEventId++);
+	lua_pushnumber(L, g_luaEnvironment.addTimerEvent(std::move(eventDesc), env->getScriptInterface(), delay));
 	return 1;
 }
 
 int LuaScriptInterface::luaStopEvent(lua_State* L) {
 	//stopEvent(eventid)
 	uint32_t eventId = lua::getNumber<uint32_t>(L, 1);
-
-	auto& timerEvents = g_luaEnvironment.timerEvents;
-	auto it = timerEvents.find(eventId);
-	if (it == timerEvents.end()) {
-		lua::pushBoolean(L, false);
-		return 1;
-	}
-
-	LuaTimerEventDesc timerEventDesc = std::move(it->second);
-	timerEvents.erase(it);
-
-	g_scheduler.stopEvent(timerEventDesc.eventId);
-	luaL_unref(L, LUA_REGISTRYINDEX, timerEventDesc.function);
-
-	for (auto parameter : timerEventDesc.parameters) {
-		luaL_unref(L, LUA_REGISTRYINDEX, parameter);
-	}
-
-	lua::pushBoolean(L, true);
+	lua::pushBoolean(L, g_luaEnvironment.stopTimerEvent(eventId));
 	return 1;
 }
 
@@ -4225,9 +4233,91 @@ const luaL_Reg LuaScriptInterface::luaDatabaseTable[] = {
 	{"escapeBlob", LuaScriptInterface::luaDatabaseEscapeBlob},
 	{"lastInsertId", LuaScriptInterface::luaDatabaseLastInsertId},
 	{"tableExists", LuaScriptInterface::luaDatabaseTableExists},
+	{"getTaskStats", LuaScriptInterface::luaDatabaseGetTaskStats},
+	{"getQueryStats", LuaScriptInterface::luaDatabaseGetQueryStats},
+	{"getSlowQueries", LuaScriptInterface::luaDatabaseGetSlowQueries},
+	{"resetQueryStats", LuaScriptInterface::luaDatabaseResetQueryStats},
 	{nullptr, nullptr}
 };
 
+int LuaScriptInterface::luaDatabaseGetTaskStats(lua_State* L) {
+	// db.getTaskStats()
+	const DatabaseTaskStats stats = g_databaseTasks.getStats();
+	lua_createtable(L, 0, 9);
+	setField(L, "workers", stats.workers);
+	setField(L, "pending", stats.pending);
+	setField(L, "running", stats.running);
+	setField(L, "highWater", stats.highWater);
+	setField(L, "executed", stats.executed);
+	setField(L, "totalWaitMicros", stats.totalWaitMicros);
+	setField(L, "maxWaitMicros", stats.maxWaitMicros);
+	setField(L, "totalRunMicros", stats.totalRunMicros);
+	setField(L, "maxRunMicros", stats.maxRunMicros);
+	return 1;
+}
+
+int LuaScriptInterface::luaDatabaseGetQueryStats(lua_State* L) {
+	// db.getQueryStats()
+	static constexpr std::array<const char*, static_cast<size_t>(DBThreadRole::COUNT)> roleNames = {"other", "dispatcher", "worker"};
+
+	const auto fingerprints = DBQueryStats::getInstance().getFingerprints();
+	lua_createtable(L, fingerprints.size(), 0);
+
+	int index = 0;
+	for (const DBQueryFingerprintStats& stats : fingerprints) {
+		lua_createtable(L, 0, 1 + roleNames.size());
+		setField(L, "query", stats.fingerprint);
+		for (size_t role = 0; role < roleNames.size(); ++role) {
+			const DBQueryHistogram& histogram = stats.roles[role];
+			if (histogram.count == 0) {
+				continue;
+			}
+
+			lua_createtable(L, 0, 4);
+			setField(L, "count", histogram.count);
+			setField(L, "totalMicros", histogram.totalMicros);
+			setField(L, "maxMicros", histogram.maxMicros);
+
+			// buckets[i] counts queries faster than 2^(i + 4) microseconds
+			lua_createtable(L, histogram.buckets.size(), 0);
+			for (size_t bucket = 0; bucket < histogram.buckets.size(); ++bucket) {
+				lua_pushnumber(L, histogram.buckets[bucket]);
+				lua_rawseti(L, -2, bucket + 1);
+			}
+			lua_setfield(L, -2, "buckets");
+
+			lua_setfield(L, -2, roleNames[role]);
+		}
+		lua_rawseti(L, -2, ++index);
+	}
+	return 1;
+}
+
+int LuaScriptInterface::luaDatabaseGetSlowQueries(lua_State* L) {
+	// db.getSlowQueries()
+	const auto slowQueries = DBQueryStats::getInstance().getSlowQueries();
+	lua_createtable(L, slowQueries.size(), 0);
+
+	int index = 0;
+	for (const DBSlowQuery& slowQuery : slowQueries) {
+		lua_createtable(L, 0, 4);
+		setField(L, "fingerprint", slowQuery.fingerprint);
+		setField(L, "timestamp", slowQuery.timestamp);
+		setField(L, "micros", slowQuery.micros);
+		lua::pushBoolean(L, slowQuery.role == DBThreadRole::DISPATCHER);
+		lua_setfield(L, -2, "dispatcher");
+		lua_rawseti(L, -2, ++index);
+	}
+	return 1;
+}
+
+int LuaScriptInterface::luaDatabaseResetQueryStats(lua_State* L) {
+	// db.resetQueryStats()
+	DBQueryStats::getInstance().reset();
+	lua::pushBoolean(L, true);
+	return 1;
+}
+
 int LuaScriptInterface::luaDatabaseExecute(lua_State* L) {
 	lua::pushBoolean(L, Database::getInstance().executeQuery(lua::getString(L, -1)));
 	return 1;
@@ -4258,7 +4348,8 @@ int LuaScriptInterface::luaDatabaseAsyncExecute(lua_State* L) {
 			luaL_unref(L, LUA_REGISTRYINDEX, ref);
 		};
 	}
-	g_databaseTasks.addTask(lua::getString(L, -1), callback);
+	// scripts may rely on their async queries running in submission order
+	g_databaseTasks.addTask(lua::getString(L, -1), callback, false, DatabaseTasks::makeOrderKey(DatabaseOrder::SCRIPT, 0));
 	return 0;
 }
 
@@ -4300,7 +4391,7 @@ int LuaScriptInterface::luaDatabaseAsyncStoreQuery(lua_State* L) {
 			luaL_unref(L, LUA_REGISTRYINDEX, ref);
 		};
 	}
-	g_databaseTasks.addTask(lua::getString(L, -1), callback, true);
+	g_databaseTasks.addTask(lua::getString(L, -1), callback, true, DatabaseTasks::makeOrderKey(DatabaseOrder::SCRIPT, 0));
 	return 0;
 }
 
@@ -4577,6 +4668,206 @@ int LuaScriptInterface::luaGameGetSpectators(lua_State* L) {
 	return 1;
 }
 
+int LuaScriptInterface::luaGameGetTimerEventStats(lua_State* L) {
+	// Game.getTimerEventStats()
+	const auto stats = g_luaEnvironment.getTimerEventStats();
+	lua_createtable(L, 0, stats.size());
+	for (const auto& [name, live] : stats) {
+		lua_pushnumber(L, live);
+		lua_setfield(L, -2, name.c_str());
+	}
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetItemIOStats(lua_State* L) {
+	// Game.getItemIOStats()
+	const ItemIOStats stats = IOLoginData::getItemIOStats();
+	auto rowsPerSecond = [](uint64_t rows, uint64_t micros) {
+		return micros != 0 ? rows * 1000000 / micros : 0;
+	};
+
+	lua_createtable(L, 0, 9);
+	setField(L, "rowsLoaded", stats.rowsLoaded);
+	setField(L, "loadMicros", stats.loadMicros);
+	setField(L, "loadRowsPerSecond", rowsPerSecond(stats.rowsLoaded, stats.loadMicros));
+	setField(L, "rowsSaved", stats.rowsSaved);
+	setField(L, "saveMicros", stats.saveMicros);
+	setField(L, "saveRowsPerSecond", rowsPerSecond(stats.rowsSaved, stats.saveMicros));
+	setField(L, "blobsLoaded", stats.blobsLoaded);
+	setField(L, "blobsSaved", stats.blobsSaved);
+	setField(L, "blobBytesSaved", stats.blobBytesSaved);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameConvertItemStorage(lua_State* L) {
+	// Game.convertItemStorage([limit = 1000])
+	lua_pushnumber(L, IOLoginData::convertItemStorage(lua::getNumber<size_t>(L, 1, 1000)));
+	return 1;
+}
+
+int LuaScriptInterface::luaGameBenchmarkItemStorage(lua_State* L) {
+	// Game.benchmarkItemStorage(player)
+	const Player* player = lua::getPlayer(L, 1);
+	if (!player) {
+		reportErrorFunc(L, lua::getErrorDesc(LUA_ERROR_PLAYER_NOT_FOUND));
+		lua_pushnil(L);
+		return 1;
+	}
+
+	const auto benchmark = IOLoginData::benchmarkItemStorage(player);
+	if (!benchmark) {
+		lua_pushnil(L);
+		return 1;
+	}
+
+	lua_createtable(L, 0, 8);
+	setField(L, "rows", benchmark->rows);
+	setField(L, "rowBytes", benchmark->rowBytes);
+	setField(L, "rowSaveMicros", benchmark->rowSaveMicros);
+	setField(L, "rowLoadMicros", benchmark->rowLoadMicros);
+	setField(L, "blobs", benchmark->blobs);
+	setField(L, "blobBytes", benchmark->blobBytes);
+	setField(L, "blobSaveMicros", benchmark->blobSaveMicros);
+	setField(L, "blobLoadMicros", benchmark->blobLoadMicros);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameBenchmarkConditions(lua_State* L) {
+	// Game.benchmarkConditions([creatures = 20000[, rounds = 10]])
+	const ConditionBenchmark benchmark = Game::benchmarkConditions(lua::getNumber<size_t>(L, 1, 20000), lua::getNumber<size_t>(L, 2, 10));
+	lua_createtable(L, 0, 5);
+	setField(L, "creatures", benchmark.creatures);
+	setField(L, "conditions", benchmark.conditions);
+	setField(L, "rounds", benchmark.rounds);
+	setField(L, "micros", benchmark.micros);
+	setField(L, "legacyMicros", benchmark.legacyMicros);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameBenchmarkMonsterThink(lua_State* L) {
+	// Game.benchmarkMonsterThink(position, monsterName[, monsters = 100[, rounds = 100]])
+	const Position& position = lua::getPosition(L, 1);
+	const MonsterThinkBenchmark benchmark = g_game.benchmarkMonsterThink(position, lua::getString(L, 2), lua::getNumber<size_t>(L, 3, 100), lua::getNumber<size_t>(L, 4, 100));
+	lua_createtable(L, 0, 4);
+	setField(L, "monsters", benchmark.monsters);
+	setField(L, "rounds", benchmark.rounds);
+	setField(L, "thinks", benchmark.thinks);
+	setField(L, "micros", benchmark.micros);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetCreatureCheckStats(lua_State* L) {
+	// Game.getCreatureCheckStats()
+	const CreatureCheckStats stats = g_game.getCreatureCheckStats();
+	lua_createtable(L, 0, 3);
+	setField(L, "active", stats.active);
+	setField(L, "activeMonsters", stats.activeMonsters);
+	setField(L, "idleMonsters", stats.idleMonsters);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetPlayerSaveStats(lua_State* L) {
+	// Game.getPlayerSaveStats()
+	const PlayerSaveStats stats = IOLoginData::getPlayerSaveStats();
+	lua_createtable(L, 0, 9);
+	setField(L, "saves", stats.saves);
+	setField(L, "players", stats.players);
+	setField(L, "batches", stats.batches);
+	setField(L, "fallbacks", stats.fallbacks);
+	setField(L, "failures", stats.failures);
+	setField(L, "lastPlayers", stats.lastPlayers);
+	setField(L, "lastMicros", stats.lastMicros);
+	setField(L, "maxMicros", stats.maxMicros);
+	setField(L, "totalMicros", stats.totalMicros);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetPlayerJournalStats(lua_State* L) {
+	// Game.getPlayerJournalStats()
+	if (!g_playerJournal.isOpen()) {
+		lua_pushnil(L);
+		return 1;
+	}
+
+	const PlayerJournalStats stats = g_playerJournal.getStats();
+	lua_createtable(L, 0, 10);
+	setField(L, "records", stats.records);
+	setField(L, "dropped", stats.dropped);
+	setField(L, "used", stats.used);
+	setField(L, "capacity", stats.capacity);
+	setField(L, "epoch", stats.epoch);
+	setField(L, "syncs", stats.syncs);
+	setField(L, "totalSyncMicros", stats.totalSyncMicros);
+	setField(L, "maxSyncMicros", stats.maxSyncMicros);
+	setField(L, "replayedRecords", stats.replayedRecords);
+	setField(L, "replayedPlayers", stats.replayedPlayers);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetLoginStats(lua_State* L) {
+	// Game.getLoginStats()
+	const LoginStats stats = ProtocolGame::getLoginStats();
+	lua_createtable(L, 0, 7);
+	setField(L, "logins", stats.logins);
+	setField(L, "p50Millis", stats.p50Millis);
+	setField(L, "p95Millis", stats.p95Millis);
+	setField(L, "p99Millis", stats.p99Millis);
+	setField(L, "maxMillis", stats.maxMillis);
+	setField(L, "totalDispatcherMicros", stats.totalDispatcherMicros);
+	setField(L, "maxDispatcherMicros", stats.maxDispatcherMicros);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetClientUpdateStats(lua_State* L) {
+	// Game.getClientUpdateStats()
+	const ClientUpdateStats stats = ProtocolGame::getClientUpdateStats();
+	lua_createtable(L, 0, 8);
+	setField(L, "statsQueued", stats.statsQueued);
+	setField(L, "statsSent", stats.statsSent);
+	setField(L, "skillsQueued", stats.skillsQueued);
+	setField(L, "skillsSent", stats.skillsSent);
+	setField(L, "iconsQueued", stats.iconsQueued);
+	setField(L, "iconsSent", stats.iconsSent);
+	setField(L, "healthQueued", stats.healthQueued);
+	setField(L, "healthSent", stats.healthSent);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetLoginCacheStats(lua_State* L) {
+	// Game.getLoginCacheStats()
+	LRUCacheStatsList caches = IOLoginData::getCacheStats();
+	for (auto& it : IOBan::getCacheStats()) {
+		caches.push_back(it);
+	}
+
+	lua_createtable(L, 0, caches.size());
+	for (const auto& [name, stats] : caches) {
+		lua_createtable(L, 0, 6);
+		setField(L, "hits", stats.hits);
+		setField(L, "misses", stats.misses);
+		setField(L, "evictions", stats.evictions);
+		setField(L, "invalidations", stats.invalidations);
+		setField(L, "size", stats.size);
+		setField(L, "capacity", stats.capacity);
+		lua_setfield(L, -2, std::string{name}.c_str());
+	}
+	return 1;
+}
+
+int LuaScriptInterface::luaGameClearLoginCache(lua_State* L) {
+	// Game.clearLoginCache()
+	IOLoginData::clearCaches();
+	lua::pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameClearBanCache(lua_State* L) {
+	// Game.clearBanCache()
+	IOBan::clearCache();
+	lua::pushBoolean(L, true);
+	return 1;
+}
+
 int LuaScriptInterface::luaGameGetPlayers(lua_State* L) {
 	// Game.getPlayers()
 	lua_createtable(L, g_game.getPlayersOnline(), 0);
@@ -6802,7 +7093,9 @@ int LuaScriptInterface::luaItemGetAttribute(lua_State* L) {
 		attribute = ITEM_ATTRIBUTE_NONE;
 	}
 
-	if (ItemAttributes::isIntAttrType(attribute)) {
+	if (attribute == ITEM_ATTRIBUTE_DURATION) {
+		lua_pushnumber(L, item->getDuration());
+	} else if (ItemAttributes::isIntAttrType(attribute)) {
 		lua_pushnumber(L, item->getIntAttr(attribute));
 	} else if (ItemAttributes::isStrAttrType(attribute)) {
 		lua::pushString(L, item->getStrAttr(attribute));
@@ -6836,7 +7129,11 @@ int LuaScriptInterface::luaItemSetAttribute(lua_State* L) {
 			return 1;
 		}
 
-		item->setIntAttr(attribute, lua::getNumber<int32_t>(L, 3));
+		if (attribute == ITEM_ATTRIBUTE_DURATION) {
+			item->setDuration(lua::getNumber<int32_t>(L, 3));
+		} else {
+			item->setIntAttr(attribute, lua::getNumber<int32_t>(L, 3));
+		}
 		lua::pushBoolean(L, true);
 	} else if (ItemAttributes::isStrAttrType(attribute)) {
 		item->setStrAttr(attribute, lua::getString(L, 3));
@@ -17557,9 +17854,16 @@ bool LuaEnvironment::closeState() {
 		luaL_unref(L, LUA_REGISTRYINDEX, timerEventDesc.function);
 	}
 
+	g_scheduler.stopEvent(timerTickEventId);
+	timerTickEventId = 0;
+
 	combatIdMap.clear();
 	areaIdMap.clear();
 	timerEvents.clear();
+	timerQueue.clear();
+	timerScriptStats.clear();
+	freeTimerScriptStats.clear();
+	timerScriptIndex.clear();
 	cacheFiles.clear();
 
 	lua_close(L);
@@ -17635,36 +17939,168 @@ void LuaEnvironment::clearAreaObjects(LuaScriptInterface* interface) {
 	it->second.clear();
 }
 
-void LuaEnvironment::executeTimerEvent(uint32_t eventIndex) {
-	auto it = timerEvents.find(eventIndex);
+uint32_t LuaEnvironment::addTimerEvent(LuaTimerEventDesc&& eventDesc, LuaScriptInterface* interface, uint32_t delay) {
+	auto key = std::make_pair(static_cast<const LuaScriptInterface*>(interface), eventDesc.scriptId);
+	auto statsIt = timerScriptIndex.find(key);
+	if (statsIt == timerScriptIndex.end()) {
+		std::string name = interface ? interface->getFileById(eventDesc.scriptId) : "(Unknown scriptfile)";
+		if (freeTimerScriptStats.empty()) {
+			statsIt = timerScriptIndex.emplace(key, static_cast<uint32_t>(timerScriptStats.size())).first;
+			timerScriptStats.push_back({std::move(name), 0});
+		} else {
+			statsIt = timerScriptIndex.emplace(key, freeTimerScriptStats.back()).first;
+			freeTimerScriptStats.pop_back();
+			timerScriptStats[statsIt->second] = {std::move(name), 0};
+		}
+	}
+	eventDesc.statsIndex = statsIt->second;
+	++timerScriptStats[eventDesc.statsIndex].live;
+
+	const uint32_t eventId = lastEventTimerId++;
+	const int64_t executeAt = OTSYS_TIME() + delay;
+	timerEvents.emplace(eventId, std::move(eventDesc));
+	timerQueue.emplace_back(executeAt, eventId);
+	std::push_heap(timerQueue.begin(), timerQueue.end(), std::greater<>());
+	scheduleTimerEvents(executeAt);
+	return eventId;
+}
+
+bool LuaEnvironment::stopTimerEvent(uint32_t eventId) {
+	auto it = timerEvents.find(eventId);
 	if (it == timerEvents.end()) {
-		return;
+		return false;
 	}
 
+	// the queue entry is dropped lazily once it comes due, unless stopped
+	// timers (e.g. long timeouts cancelled right away) come to outnumber live ones
 	LuaTimerEventDesc timerEventDesc = std::move(it->second);
 	timerEvents.erase(it);
+	releaseTimerEvent(timerEventDesc);
 
-	//push function
-	lua_rawgeti(L, LUA_REGISTRYINDEX, timerEventDesc.function);
+	if (timerQueue.size() > 64 && timerQueue.size() > 2 * timerEvents.size()) {
+		std::erase_if(timerQueue, [this](const TimerQueueEntry& entry) { return !timerEvents.contains(entry.second); });
+		std::make_heap(timerQueue.begin(), timerQueue.end(), std::greater<>());
+	}
+	return true;
+}
 
-	//push parameters
-	for (auto parameter : std::views::reverse(timerEventDesc.parameters)) {
-		lua_rawgeti(L, LUA_REGISTRYINDEX, parameter);
+void LuaEnvironment::clearTimerScriptStats(const LuaScriptInterface* interface) {
+	auto first = timerScriptIndex.lower_bound({interface, std::numeric_limits<int32_t>::min()});
+	auto last = timerScriptIndex.upper_bound({interface, std::numeric_limits<int32_t>::max()});
+	for (auto it = first; it != last; ++it) {
+		// timers outlive a reload, so an entry still counting them is freed by the last one
+		TimerScriptStats& stats = timerScriptStats[it->second];
+		stats.indexed = false;
+		if (stats.live == 0) {
+			freeTimerScriptStats.push_back(it->second);
+		}
 	}
+	timerScriptIndex.erase(first, last);
+}
 
-	//call the function
-	if (lua::reserveScriptEnv()) {
-		ScriptEnvironment* env = lua::getScriptEnv();
-		env->setTimerEvent();
-		env->setScriptId(timerEventDesc.scriptId, this);
-		callFunction(timerEventDesc.parameters.size());
-	} else {
-		std::cout << "[Error - LuaScriptInterface::executeTimerEvent] Call stack overflow" << std::endl;
+std::vector<std::pair<std::string, uint32_t>> LuaEnvironment::getTimerEventStats() const {
+	std::map<std::string, uint32_t> liveByName;
+	for (const TimerScriptStats& stats : timerScriptStats) {
+		if (stats.live != 0) {
+			liveByName[stats.name] += stats.live;
+		}
 	}
+	return {liveByName.begin(), liveByName.end()};
+}
 
-	//free resources
+void LuaEnvironment::releaseTimerEvent(LuaTimerEventDesc& timerEventDesc) {
 	luaL_unref(L, LUA_REGISTRYINDEX, timerEventDesc.function);
 	for (auto parameter : timerEventDesc.parameters) {
 		luaL_unref(L, LUA_REGISTRYINDEX, parameter);
 	}
+	TimerScriptStats& stats = timerScriptStats[timerEventDesc.statsIndex];
+	if (--stats.live == 0 && !stats.indexed) {
+		freeTimerScriptStats.push_back(timerEventDesc.statsIndex);
+	}
+}
+
+void LuaEnvironment::popTimerQueue() {
+	std::pop_heap(timerQueue.begin(), timerQueue.end(), std::greater<>());
+	timerQueue.pop_back();
+}
+
+void LuaEnvironment::scheduleTimerEvents(int64_t executeAt) {
+	if (timerTickEventId != 0) {
+		if (timerTickAt <= executeAt) {
+			return;
+		}
+		g_scheduler.stopEvent(timerTickEventId);
+	}
+
+	const int64_t delay = std::max<int64_t>(1, executeAt - OTSYS_TIME());
+	timerTickAt = executeAt;
+	timerTickEventId = g_scheduler.addEvent(createSchedulerTask(static_cast<uint32_t>(delay), [this]() {
+		timerTickEventId = 0;
+		executeTimerEvents();
+	}));
+}
+
+void LuaEnvironment::executeTimerEvents() {
+	const int64_t now = OTSYS_TIME();
+
+	bool reserved = lua::reserveScriptEnv();
+	if (!reserved) {
+		std::cout << "[Error - LuaScriptInterface::executeTimerEvent] Call stack overflow" << std::endl;
+	}
+
+	while (!timerQueue.empty() && timerQueue.front().first <= now) {
+		const uint32_t eventId = timerQueue.front().second;
+		popTimerQueue();
+
+		auto it = timerEvents.find(eventId);
+		if (it == timerEvents.end()) {
+			continue;
+		}
+
+		LuaTimerEventDesc timerEventDesc = std::move(it->second);
+		timerEvents.erase(it);
+
+		if (reserved) {
+			//push function
+			lua_rawgeti(L, LUA_REGISTRYINDEX, timerEventDesc.function);
+
+			//push parameters
+			for (auto parameter : std::views::reverse(timerEventDesc.parameters)) {
+				lua_rawgeti(L, LUA_REGISTRYINDEX, parameter);
+			}
+
+			//call the function; the environment is reset, not released, between timers of the batch
+			ScriptEnvironment* env = lua::getScriptEnv();
+			env->setTimerEvent();
+			env->setScriptId(timerEventDesc.scriptId, this);
+
+			const int params = static_cast<int>(timerEventDesc.parameters.size());
+			int size = lua_gettop(L);
+			if (lua::protectedCall(L, params, 1) != 0) {
+				reportErrorFunc(nullptr, lua::getString(L, -1));
+			}
+
+			lua_pop(L, 1);
+			if ((lua_gettop(L) + params + 1) != size) {
+				reportErrorFunc(nullptr, "Stack size changed!");
+			}
+			env->resetEnv();
+		}
+
+		//free resources
+		releaseTimerEvent(timerEventDesc);
+	}
+
+	if (reserved) {
+		lua::resetScriptEnv();
+	}
+
+	// skip entries of stopped timers so we do not wake up for them
+	while (!timerQueue.empty() && timerEvents.find(timerQueue.front().second) == timerEvents.end()) {
+		popTimerQueue();
+	}
+
+	if (!timerQueue.empty()) {
+		scheduleTimerEvents(timerQueue.front().first);
+	}
 }
\ No newline at end of file
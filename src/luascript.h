@@ -42,7 +42,7 @@ struct LuaTimerEventDesc {
 	int32_t scriptId = -1;
 	int32_t function = -1;
 	std::vector<int32_t> parameters;
-	uint32_t eventId = 0;
+	uint32_t statsIndex = 0;
 
 	LuaTimerEventDesc() = default;
 	LuaTimerEventDesc(LuaTimerEventDesc&& other) = default;
@@ -140,7 +140,7 @@ class LuaScriptInterface {
 		virtual bool initState();
 		bool reInitState();
 
-		int32_t loadFile(const std::string& file, Npc* npc = nullptr);
+		int32_t loadFile(const std::string& file, Npc* npc = nullptr, int32_t environment = LUA_NOREF);
 
 		const std::string& getFileById(int32_t scriptId);
 		int32_t getEvent(std::string_view eventName);
@@ -169,7 +169,7 @@ class LuaScriptInterface {
 		static const luaL_Reg luaBitReg[7];
 #endif
 		static const luaL_Reg luaConfigManagerTable[4];
-		static const luaL_Reg luaDatabaseTable[9];
+		static const luaL_Reg luaDatabaseTable[13];
 		static const luaL_Reg luaResultTable[6];
 
 	protected:
@@ -261,6 +261,10 @@ class LuaScriptInterface {
 		static int luaDatabaseEscapeBlob(lua_State* L);
 		static int luaDatabaseLastInsertId(lua_State* L);
 		static int luaDatabaseTableExists(lua_State* L);
+		static int luaDatabaseGetTaskStats(lua_State* L);
+		static int luaDatabaseGetQueryStats(lua_State* L);
+		static int luaDatabaseGetSlowQueries(lua_State* L);
+		static int luaDatabaseResetQueryStats(lua_State* L);
 
 		static int luaResultGetNumber(lua_State* L);
 		static int luaResultGetString(lua_State* L);
@@ -342,6 +346,21 @@ class LuaScriptInterface {
 		static int luaGameSetAccountStorageValue(lua_State* L);
 		static int luaGameSaveAccountStorageValues(lua_State* L);
 
+		static int luaGameGetTimerEventStats(lua_State* L);
+		static int luaGameGetItemIOStats(lua_State* L);
+		static int luaGameGetPlayerSaveStats(lua_State* L);
+		static int luaGameGetPlayerJournalStats(lua_State* L);
+		static int luaGameConvertItemStorage(lua_State* L);
+		static int luaGameBenchmarkItemStorage(lua_State* L);
+		static int luaGameBenchmarkConditions(lua_State* L);
+		static int luaGameBenchmarkMonsterThink(lua_State* L);
+		static int luaGameGetCreatureCheckStats(lua_State* L);
+		static int luaGameGetLoginStats(lua_State* L);
+		static int luaGameGetClientUpdateStats(lua_State* L);
+		static int luaGameGetLoginCacheStats(lua_State* L);
+		static int luaGameClearLoginCache(lua_State* L);
+		static int luaGameClearBanCache(lua_State* L);
+
 		// Variant
 		static int luaVariantCreate(lua_State* L);
 
@@ -1405,10 +1424,39 @@ class LuaEnvironment : public LuaScriptInterface {
 		uint32_t createAreaObject(LuaScriptInterface* interface);
 		void clearAreaObjects(LuaScriptInterface* interface);
 
+		uint32_t addTimerEvent(LuaTimerEventDesc&& eventDesc, LuaScriptInterface* interface, uint32_t delay);
+		bool stopTimerEvent(uint32_t eventId);
+
+		// live timer count per script that created them
+		std::vector<std::pair<std::string, uint32_t>> getTimerEventStats() const;
+		// forgets the scripts of an interface that is closed or reloaded
+		void clearTimerScriptStats(const LuaScriptInterface* interface);
+
 	private:
-		void executeTimerEvent(uint32_t eventIndex);
+		struct TimerScriptStats {
+			std::string name;
+			uint32_t live = 0;
+			// false once the interface is gone; reused when its last timer ends
+			bool indexed = true;
+		};
+
+		// Timers are not scheduler tasks of their own: a single scheduler event is armed for the
+		// earliest deadline and runs every timer due by then under one script environment.
+		void scheduleTimerEvents(int64_t executeAt);
+		void executeTimerEvents();
+		void releaseTimerEvent(LuaTimerEventDesc& timerEventDesc);
+		void popTimerQueue();
+
+		using TimerQueueEntry = std::pair<int64_t, uint32_t>;
 
 		std::unordered_map<uint32_t, LuaTimerEventDesc> timerEvents;
+		// min-heap on the deadline; stopped timers stay in it until they come due or the heap is compacted
+		std::vector<TimerQueueEntry> timerQueue;
+		std::vector<TimerScriptStats> timerScriptStats;
+		std::vector<uint32_t> freeTimerScriptStats;
+		std::map<std::pair<const LuaScriptInterface*, int32_t>, uint32_t> timerScriptIndex;
+		uint32_t timerTickEventId = 0;
+		int64_t timerTickAt = 0;
 		std::unordered_map<uint32_t, Combat_ptr> combatMap;
 		std::unordered_map<uint32_t, AreaCombat*> areaMap;
 
@@ -134,6 +134,7 @@ void Map::setTile(uint16_t x, uint16_t y, uint8_t z, Tile* newTile) {
 		delete newTile;
 	} else {
 		tile = newTile;
+		floor->updateBlocking(x, y);
 	}
 }
 
@@ -246,6 +247,9 @@ bool Map::placeCreature(const Position& centerPos, Creature* creature, bool exte
 
 	const Position& dest = toCylinder->getPosition();
 	getQTNode(dest.x, dest.y)->addCreature(creature);
+	if (creature->getPlayer()) {
+		players.addPlayer(dest);
+	}
 	return true;
 }
 
@@ -262,10 +266,9 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport/* =
 
 	bool teleport = forceTeleport || !newTile.getGround() || !oldPos.isInRange(newPos, 1, 1, 0);
 
-	SpectatorVec spectators, newPosSpectators;
-	getSpectators(spectators, oldPos, true);
-	getSpectators(newPosSpectators, newPos, true);
-	spectators.addSpectators(newPosSpectators);
+	// not through the spectator cache, moving the creature clears it anyway
+	SpectatorVec spectators;
+	getMoveSpectators(spectators, oldPos, newPos);
 
 	std::vector<int32_t> oldStackPosVector;
 	for (Creature* spectator : spectators) {
@@ -288,6 +291,11 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport/* =
 	if (leaf != new_leaf) {
 		leaf->removeCreature(&creature);
 		new_leaf->addCreature(&creature);
+
+		// player cells are made of whole leaves
+		if (creature.getPlayer()) {
+			players.movePlayer(oldPos, newPos);
+		}
 	}
 
 	//add the creature
@@ -383,6 +391,59 @@ void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& center
 	}
 }
 
+void Map::getMultifloorRange(const Position& centerPos, int32_t& minRangeZ, int32_t& maxRangeZ) {
+	if (centerPos.z > 7) {
+		//underground (8->15)
+		minRangeZ = std::max(centerPos.getZ() - 2, 0);
+		maxRangeZ = std::min(centerPos.getZ() + 2, MAP_MAX_LAYERS - 1);
+	} else if (centerPos.z == 6) {
+		minRangeZ = 0;
+		maxRangeZ = 8;
+	} else if (centerPos.z == 7) {
+		minRangeZ = 0;
+		maxRangeZ = 9;
+	} else {
+		minRangeZ = 0;
+		maxRangeZ = 7;
+	}
+}
+
+void Map::getMoveSpectators(SpectatorVec& spectators, const Position& oldPos, const Position& newPos) const {
+	int32_t minRangeZ, maxRangeZ;
+	getMultifloorRange(oldPos, minRangeZ, maxRangeZ);
+
+	const int32_t offsetX = newPos.getOffsetX(oldPos);
+	const int32_t offsetY = newPos.getOffsetY(oldPos);
+	if (oldPos.z != newPos.z || std::abs(offsetX) > 1 || std::abs(offsetY) > 1) {
+		getSpectatorsInternal(spectators, oldPos, -maxViewportX, maxViewportX, -maxViewportY, maxViewportY, minRangeZ, maxRangeZ, false);
+
+		SpectatorVec newPosSpectators;
+		getMultifloorRange(newPos, minRangeZ, maxRangeZ);
+		getSpectatorsInternal(newPosSpectators, newPos, -maxViewportX, maxViewportX, -maxViewportY, maxViewportY, minRangeZ, maxRangeZ, false);
+		spectators.addSpectators(newPosSpectators);
+		return;
+	}
+
+	// a step widens the view by one row or column, which is exactly the
+	// union of both views unless it is diagonal
+	getSpectatorsInternal(spectators, oldPos,
+	                      -maxViewportX + std::min(0, offsetX), maxViewportX + std::max(0, offsetX),
+	                      -maxViewportY + std::min(0, offsetY), maxViewportY + std::max(0, offsetY),
+	                      minRangeZ, maxRangeZ, false);
+	if (offsetX == 0 || offsetY == 0) {
+		return;
+	}
+
+	// drop the far corner that only the bounding box covers
+	spectators.eraseIf([&](const Creature* spectator) {
+		const Position& pos = spectator->getPosition();
+		const int32_t offsetZ = oldPos.getOffsetZ(pos);
+		const bool seesOld = std::abs(pos.x - offsetZ - oldPos.x) <= maxViewportX && std::abs(pos.y - offsetZ - oldPos.y) <= maxViewportY;
+		const bool seesNew = std::abs(pos.x - offsetZ - newPos.x) <= maxViewportX && std::abs(pos.y - offsetZ - newPos.y) <= maxViewportY;
+		return !seesOld && !seesNew;
+	});
+}
+
 void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, bool multifloor /*= false*/, bool onlyPlayers /*= false*/, int32_t minRangeX /*= 0*/, int32_t maxRangeX /*= 0*/, int32_t minRangeY /*= 0*/, int32_t maxRangeY /*= 0*/) {
         if (centerPos.z >= MAP_MAX_LAYERS) {
                 return;
@@ -441,20 +502,7 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 		int32_t maxRangeZ;
 
 		if (multifloor) {
-			if (centerPos.z > 7) {
-				//underground (8->15)
-				minRangeZ = std::max(centerPos.getZ() - 2, 0);
-				maxRangeZ = std::min(centerPos.getZ() + 2, MAP_MAX_LAYERS - 1);
-			} else if (centerPos.z == 6) {
-				minRangeZ = 0;
-				maxRangeZ = 8;
-			} else if (centerPos.z == 7) {
-				minRangeZ = 0;
-				maxRangeZ = 9;
-			} else {
-				minRangeZ = 0;
-				maxRangeZ = 7;
-			}
+			getMultifloorRange(centerPos, minRangeZ, maxRangeZ);
 		} else {
 			minRangeZ = centerPos.z;
 			maxRangeZ = centerPos.z;
@@ -510,35 +558,68 @@ bool Map::canThrowObjectTo(const Position& fromPos, const Position& toPos, bool
 	return !checkLineOfSight || isSightClear(fromPos, toPos, sameFloor);
 }
 
-bool Map::isTileClear(uint16_t x, uint16_t y, uint8_t z, bool blockFloor /*= false*/, bool pathfinding /*= false*/) const {
-	const Tile* tile = getTile(x, y, z);
-	if (!tile) {
-		return true;
-	}
+namespace {
 
-	if (blockFloor && tile->getGround()) {
-		return false;
-	}
+	// Answers isTileClear from the blocking bits of each floor, walking the
+	// quadtree once per leaf block instead of once per tile.
+	class TileClearLookup {
+		public:
+			TileClearLookup(uint8_t z, bool pathfinding) : z(z), pathfinding(pathfinding) {}
+
+			bool isClear(uint16_t x, uint16_t y, bool blockFloor = false) {
+				if ((x & ~FLOOR_MASK) != floorX || (y & ~FLOOR_MASK) != floorY) {
+					floorX = x & ~FLOOR_MASK;
+					floorY = y & ~FLOOR_MASK;
+					const QTreeLeafNode* leaf = g_game.map.getQTNode(x, y);
+					floor = leaf ? leaf->getFloor(z) : nullptr;
+				}
 
-	if (pathfinding) {
-		return !tile->hasProperty(CONST_PROP_BLOCKPROJECTILE) && !tile->hasProperty(CONST_PROP_BLOCKPATH) &&
-		       !tile->hasProperty(CONST_PROP_BLOCKSOLID) && !tile->hasProperty(CONST_PROP_IMMOVABLEBLOCKPATH) &&
-		       !tile->hasProperty(CONST_PROP_IMMOVABLEBLOCKSOLID) && !tile->getTopCreature();
-	}
+				if (!floor) {
+					return true;
+				}
 
-	return !tile->hasProperty(CONST_PROP_BLOCKPROJECTILE);
-}
+				const uint64_t bit = Floor::getBit(x, y);
+				if (floor->blockProjectile & bit) {
+					return false;
+				}
 
-namespace {
+				if (pathfinding && ((floor->blockSolid | floor->blockPath) & bit)) {
+					return false;
+				}
+
+				if (!blockFloor && !pathfinding) {
+					return true;
+				}
+
+				const Tile* tile = floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK];
+				if (!tile) {
+					return true;
+				}
+
+				if (blockFloor && tile->getGround()) {
+					return false;
+				}
+				return !pathfinding || !tile->getTopCreature();
+			}
+
+		private:
+			const Floor* floor = nullptr;
+			int32_t floorX = -1;
+			int32_t floorY = -1;
+			uint8_t z;
+			bool pathfinding;
+	};
 
 	bool checkSteepLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z, bool pathfinding /*= false*/) {
+		TileClearLookup lookup(z, pathfinding);
+
 		float dx = x1 - x0;
 		float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
 		float yi = y0 + slope;
 
 		for (uint16_t x = x0 + 1; x < x1; ++x) {
 			//0.1 is necessary to avoid loss of precision during calculation
-			if (!g_game.map.isTileClear(std::floor(yi + 0.1), x, z, false, pathfinding)) {
+			if (!lookup.isClear(std::floor(yi + 0.1), x)) {
 				return false;
 			}
 			yi += slope;
@@ -548,13 +629,15 @@ namespace {
 	}
 
 	bool checkSlightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z, bool pathfinding /*= false*/) {
+		TileClearLookup lookup(z, pathfinding);
+
 		float dx = x1 - x0;
 		float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
 		float yi = y0 + slope;
 
 		for (uint16_t x = x0 + 1; x < x1; ++x) {
 			//0.1 is necessary to avoid loss of precision during calculation
-			if (!g_game.map.isTileClear(x, std::floor(yi + 0.1), z, false, pathfinding)) {
+			if (!lookup.isClear(x, std::floor(yi + 0.1))) {
 				return false;
 			}
 			yi += slope;
@@ -565,6 +648,30 @@ namespace {
 
 }
 
+bool Map::isTileClear(uint16_t x, uint16_t y, uint8_t z, bool blockFloor /*= false*/, bool pathfinding /*= false*/) const {
+	if (z >= MAP_MAX_LAYERS) {
+		return true;
+	}
+	return TileClearLookup(z, pathfinding).isClear(x, y, blockFloor);
+}
+
+void Map::updateTileBlocking(const Tile* tile) {
+	const Position& pos = tile->getPosition();
+	if (pos.z >= MAP_MAX_LAYERS) {
+		return;
+	}
+
+	QTreeLeafNode* leaf = getQTNode(pos.x, pos.y);
+	if (!leaf) {
+		return;
+	}
+
+	Floor* floor = leaf->getFloor(pos.z);
+	if (floor && floor->tiles[pos.x & FLOOR_MASK][pos.y & FLOOR_MASK] == tile) {
+		floor->updateBlocking(pos.x, pos.y);
+	}
+}
+
 bool Map::checkSightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z, bool pathfinding /*= false*/) const {
 	if (x0 == x1 && y0 == y1) {
 		return true;
@@ -943,6 +1050,29 @@ Floor::~Floor() {
 	}
 }
 
+void Floor::updateBlocking(uint16_t x, uint16_t y) {
+	const uint64_t bit = getBit(x, y);
+	blockProjectile &= ~bit;
+	blockSolid &= ~bit;
+	blockPath &= ~bit;
+
+	const Tile* tile = tiles[x & FLOOR_MASK][y & FLOOR_MASK];
+	if (!tile) {
+		return;
+	}
+
+	// the immovable variants only narrow these down, so they need no bits
+	if (tile->hasProperty(CONST_PROP_BLOCKPROJECTILE)) {
+		blockProjectile |= bit;
+	}
+	if (tile->hasProperty(CONST_PROP_BLOCKSOLID)) {
+		blockSolid |= bit;
+	}
+	if (tile->hasProperty(CONST_PROP_BLOCKPATH)) {
+		blockPath |= bit;
+	}
+}
+
 // QTreeNode
 QTreeNode::~QTreeNode() {
 	for (auto* ptr : child) {
@@ -1056,4 +1186,49 @@ uint32_t Map::clean() const {
 		<< " from " << tiles << " tile" << (tiles != 1 ? "s" : "") << " in "
 		<< (OTSYS_TIME() - start) / (1000.) << " seconds." << std::endl;
 	return count;
-}
\ No newline at end of file
+}
+
+// PlayerIndex
+void PlayerIndex::addPlayer(const Position& pos) {
+	const uint32_t cell = getCell(pos.x, pos.y);
+	if (cellPlayers[cell]++ == 0) {
+		cellBits[cell / 64] |= uint64_t{1} << (cell % 64);
+	}
+}
+
+void PlayerIndex::removePlayer(const Position& pos) {
+	const uint32_t cell = getCell(pos.x, pos.y);
+	auto it = cellPlayers.find(cell);
+	if (it == cellPlayers.end()) {
+		return;
+	}
+
+	if (--it->second == 0) {
+		cellPlayers.erase(it);
+		cellBits[cell / 64] &= ~(uint64_t{1} << (cell % 64));
+	}
+}
+
+void PlayerIndex::movePlayer(const Position& oldPos, const Position& newPos) {
+	if (getCell(oldPos.x, oldPos.y) != getCell(newPos.x, newPos.y)) {
+		removePlayer(oldPos);
+		addPlayer(newPos);
+	}
+}
+
+bool PlayerIndex::hasPlayerNear(const Position& pos, int32_t rangeX, int32_t rangeY) const {
+	const int32_t minX = std::max<int32_t>(0, pos.x - rangeX) >> CELL_BITS;
+	const int32_t maxX = std::min<int32_t>(0xFFFF, pos.x + rangeX) >> CELL_BITS;
+	const int32_t minY = std::max<int32_t>(0, pos.y - rangeY) >> CELL_BITS;
+	const int32_t maxY = std::min<int32_t>(0xFFFF, pos.y + rangeY) >> CELL_BITS;
+
+	for (int32_t x = minX; x <= maxX; ++x) {
+		for (int32_t y = minY; y <= maxY; ++y) {
+			const uint32_t cell = (x * CELL_COUNT) + y;
+			if (cellBits[cell / 64] & (uint64_t{1} << (cell % 64))) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
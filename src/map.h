@@ -56,6 +56,35 @@ class AStarNodes {
 
 using SpectatorCache = std::map<Position, SpectatorVec>;
 
+/**
+ * Coarse grid of the cells holding at least one player, across all floors,
+ * so spawns and monsters can tell that nobody is around without walking the
+ * creature lists of every quadtree leaf in range.
+ */
+class PlayerIndex {
+	public:
+		static constexpr int32_t CELL_BITS = 5;
+		static constexpr int32_t CELL_SIZE = (1 << CELL_BITS);
+
+		PlayerIndex() : cellBits(CELL_COUNT * CELL_COUNT / 64) {}
+
+		void addPlayer(const Position& pos);
+		void removePlayer(const Position& pos);
+		void movePlayer(const Position& oldPos, const Position& newPos);
+
+		bool hasPlayerNear(const Position& pos, int32_t rangeX, int32_t rangeY) const;
+
+	private:
+		static constexpr uint32_t CELL_COUNT = 0x10000 >> CELL_BITS;
+
+		static uint32_t getCell(uint16_t x, uint16_t y) {
+			return ((x >> CELL_BITS) * CELL_COUNT) + (y >> CELL_BITS);
+		}
+
+		std::vector<uint64_t> cellBits;
+		std::unordered_map<uint32_t, uint32_t> cellPlayers;
+};
+
 static constexpr int32_t FLOOR_BITS = 3;
 static constexpr int32_t FLOOR_SIZE = (1 << FLOOR_BITS);
 static constexpr int32_t FLOOR_MASK = (FLOOR_SIZE - 1);
@@ -68,7 +97,20 @@ struct Floor {
 	Floor(const Floor&) = delete;
 	Floor& operator=(const Floor&) = delete;
 
+	static constexpr uint64_t getBit(uint16_t x, uint16_t y) {
+		return uint64_t{1} << (((x & FLOOR_MASK) << FLOOR_BITS) | (y & FLOOR_MASK));
+	}
+
+	// recomputes the blocking bits of the tile at x, y
+	void updateBlocking(uint16_t x, uint16_t y);
+
 	Tile* tiles[FLOOR_SIZE][FLOOR_SIZE] = {};
+
+	// one bit per tile, set while anything on it has the property, so sight
+	// lines and pathfinding don't have to look through the items
+	uint64_t blockProjectile = 0;
+	uint64_t blockSolid = 0;
+	uint64_t blockPath = 0;
 };
 
 class FrozenPathingConditionCall;
@@ -239,6 +281,12 @@ class Map {
 		  */
 		bool isTileClear(uint16_t x, uint16_t y, uint8_t z, bool blockFloor = false, bool pathfinding = false) const;
 
+		/**
+		  * Updates the blocking bits of a tile after its items changed; tiles
+		  * not placed on the map yet are picked up by setTile instead
+		  */
+		void updateTileBlocking(const Tile* tile);
+
 		/**
 		  * Checks if path is clear from fromPos to toPos
 		  * Notice: This only checks a straight line if the path is clear, for path finding use getPathTo.
@@ -263,6 +311,7 @@ class Map {
 		Spawns spawns;
 		Towns towns;
 		Houses houses;
+		PlayerIndex players;
 
 	private:
 		SpectatorCache spectatorCache;
@@ -278,6 +327,9 @@ class Map {
 
 		// Actually scans the map for spectators
 		void getSpectatorsInternal(SpectatorVec& spectators, const Position& centerPos, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers) const;
+		// everyone seeing either end of a move, in one pass when both ends are on the same floor
+		void getMoveSpectators(SpectatorVec& spectators, const Position& oldPos, const Position& newPos) const;
+		static void getMultifloorRange(const Position& centerPos, int32_t& minRangeZ, int32_t& maxRangeZ);
 
 		friend class Game;
 		friend class IOMap;
@@ -309,17 +309,21 @@ void Monster::onCreatureSay(Creature* creature, SpeakClasses type, const std::st
         }
 }
 
-#if ENABLE_INSTANCING
 void Monster::onPlacedCreature() {
         Creature::onPlacedCreature();
 
+	// Game::placeCreature adds every creature to the check lists; leave them
+	// right away when nobody is around instead of after a first think
+	updateIdleStatus();
+
+#if ENABLE_INSTANCING
         if (getInstanceId() == 0) {
                 return;
         }
 
         // TODO: fetch the active instance descriptor and scale monster stats accordingly.
-}
 #endif
+}
 
 void Monster::addFriend(Creature* creature) {
         assert(creature != this);
@@ -342,7 +346,7 @@ void Monster::addTarget(Creature* creature, bool pushFront/* = false*/) {
 	if (std::find(targetList.begin(), targetList.end(), creature) == targetList.end()) {
 		creature->incrementReferenceCounter();
 		if (pushFront) {
-			targetList.push_front(creature);
+			targetList.insert(targetList.begin(), creature);
 		} else {
 			targetList.push_back(creature);
 		}
@@ -380,6 +384,13 @@ void Monster::updateTargetList() {
 		}
 	}
 
+	// opponents are players and their summons, so with no player in range
+	// don't look through every monster around; summons wandering without
+	// their master are picked up when they move into view
+	if (!isSummon() && !g_game.map.players.hasPlayerNear(position, Map::maxViewportX + MAP_MAX_LAYERS, Map::maxViewportY + MAP_MAX_LAYERS)) {
+		return;
+	}
+
 	SpectatorVec spectators;
 	g_game.map.getSpectators(spectators, position, true);
 	spectators.erase(this);
@@ -501,7 +512,7 @@ void Monster::onCreatureLeave(Creature* creature) {
 }
 
 bool Monster::searchTarget(TargetSearchType_t searchType /*= TARGETSEARCH_DEFAULT*/) {
-	std::list<Creature*> resultList;
+	CreatureList resultList;
 	const Position& myPos = getPosition();
 
 	for (Creature* creature : targetList) {
@@ -515,34 +526,16 @@ bool Monster::searchTarget(TargetSearchType_t searchType /*= TARGETSEARCH_DEFAUL
 	switch (searchType) {
 		case TARGETSEARCH_NEAREST: {
 			Creature* target = nullptr;
-			if (!resultList.empty()) {
-				auto it = resultList.begin();
-				target = *it;
-
-				if (++it != resultList.end()) {
-					const Position& targetPosition = target->getPosition();
-					int32_t minRange = myPos.getDistanceX(targetPosition) + myPos.getDistanceY(targetPosition);
-					do {
-						const Position& pos = (*it)->getPosition();
-
-						if (int32_t distance = myPos.getDistanceX(pos) + myPos.getDistanceY(pos); distance < minRange) {
-							target = *it;
-							minRange = distance;
-						}
-					} while (++it != resultList.end());
+			int32_t minRange = std::numeric_limits<int32_t>::max();
+			for (Creature* creature : resultList.empty() ? targetList : resultList) {
+				if (resultList.empty() && !isTarget(creature)) {
+					continue;
 				}
-			} else {
-				int32_t minRange = std::numeric_limits<int32_t>::max();
-				for (Creature* creature : targetList) {
-					if (!isTarget(creature)) {
-						continue;
-					}
 
-					const Position& pos = creature->getPosition();
-					if (int32_t distance = myPos.getDistanceX(pos) + myPos.getDistanceY(pos); distance < minRange) {
-						target = creature;
-						minRange = distance;
-					}
+				const Position& pos = creature->getPosition();
+				if (int32_t distance = myPos.getDistanceX(pos) + myPos.getDistanceY(pos); distance < minRange) {
+					target = creature;
+					minRange = distance;
 				}
 			}
 
@@ -557,9 +550,7 @@ bool Monster::searchTarget(TargetSearchType_t searchType /*= TARGETSEARCH_DEFAUL
 		case TARGETSEARCH_RANDOM:
 		default: {
 			if (!resultList.empty()) {
-				auto it = resultList.begin();
-				std::advance(it, uniform_random(0, resultList.size() - 1));
-				return selectTarget(*it);
+				return selectTarget(resultList[uniform_random(0, resultList.size() - 1)]);
 			}
 
 			if (searchType == TARGETSEARCH_ATTACKRANGE) {
@@ -589,6 +580,7 @@ void Monster::goToFollowCreature() {
 
 	if (!isSummon()) {
 		Direction dir = DIRECTION_NONE;
+		resetStepCache();
 
 		if (isFleeing()) {
 			getDistanceStep(followCreature->getPosition(), dir, true);
@@ -621,7 +613,7 @@ void Monster::onFollowCreatureComplete() {
 		targetList.erase(it);
 
 		if (hasFollowPath) {
-			targetList.push_front(target);
+			targetList.insert(targetList.begin(), target);
 		} else if (!isSummon()) {
 			targetList.push_back(target);
 		} else {
@@ -1201,6 +1193,8 @@ bool Monster::getNextStep(Direction& direction, uint32_t& flags) {
 		return false;
 	}
 
+	resetStepCache();
+
 	bool result = false;
 	if (!walkingToSpawn && (!followCreature || !hasFollowPath) && (!isSummon() || !isMasterInRange)) {
 		if (getTimeSinceLastMove() >= 1000) {
@@ -1275,8 +1269,8 @@ bool Monster::getDanceStep(const Position& creaturePos, Direction& direction,
 
 	int32_t centerToDist = std::max(distance_x, distance_y);
 
-	std::vector<Direction> dirList;
-	dirList.reserve(4);
+	std::array<Direction, 4> dirList;
+	size_t dirCount = 0;
 
 	if (!keepDistance || offset_y >= 0) {
 		int32_t tmpDist = std::max(distance_x, std::abs((creaturePos.getY() - 1) - centerPos.getY()));
@@ -1288,7 +1282,7 @@ bool Monster::getDanceStep(const Position& creaturePos, Direction& direction,
 			}
 
 			if (result) {
-				dirList.push_back(DIRECTION_NORTH);
+				dirList[dirCount++] = DIRECTION_NORTH;
 			}
 		}
 	}
@@ -1303,7 +1297,7 @@ bool Monster::getDanceStep(const Position& creaturePos, Direction& direction,
 			}
 
 			if (result) {
-				dirList.push_back(DIRECTION_SOUTH);
+				dirList[dirCount++] = DIRECTION_SOUTH;
 			}
 		}
 	}
@@ -1318,7 +1312,7 @@ bool Monster::getDanceStep(const Position& creaturePos, Direction& direction,
 			}
 
 			if (result) {
-				dirList.push_back(DIRECTION_EAST);
+				dirList[dirCount++] = DIRECTION_EAST;
 			}
 		}
 	}
@@ -1333,14 +1327,14 @@ bool Monster::getDanceStep(const Position& creaturePos, Direction& direction,
 			}
 
 			if (result) {
-				dirList.push_back(DIRECTION_WEST);
+				dirList[dirCount++] = DIRECTION_WEST;
 			}
 		}
 	}
 
-	if (!dirList.empty()) {
-		std::shuffle(dirList.begin(), dirList.end(), getRandomGenerator());
-		direction = dirList[uniform_random(0, dirList.size() - 1)];
+	if (dirCount != 0) {
+		std::shuffle(dirList.begin(), dirList.begin() + dirCount, getRandomGenerator());
+		direction = dirList[uniform_random(0, dirCount - 1)];
 		return true;
 	}
 	return false;
@@ -1842,14 +1836,30 @@ bool Monster::getDistanceStep(const Position& targetPos, Direction& direction, b
 }
 
 bool Monster::canWalkTo(Position pos, Direction direction) const {
+	const bool cached = pos == stepCache.origin && direction <= DIRECTION_LAST;
+	const uint8_t bit = 1 << direction;
+	if (cached && (stepCache.known & bit)) {
+		return (stepCache.walkable & bit) != 0;
+	}
+
+	bool walkable = false;
 	pos = getNextPosition(direction, pos);
 	if (isInSpawnRange(pos)) {
 		Tile* tile = g_game.map.getTile(pos);
 		if (tile && !tile->getTopVisibleCreature(this) && tile->queryAdd(0, *this, 1, FLAG_PATHFINDING) == RETURNVALUE_NOERROR) {
-			return true;
+			walkable = true;
 		}
 	}
-	return false;
+
+	if (cached) {
+		stepCache.known |= bit;
+		if (walkable) {
+			stepCache.walkable |= bit;
+		} else {
+			stepCache.walkable &= ~bit;
+		}
+	}
+	return walkable;
 }
 
 void Monster::death(Creature*) {
@@ -8,6 +8,8 @@
 
 #include <limits>
 
+#include <boost/container/small_vector.hpp>
+
 #include "monster/Rank.hpp"
 #include "creature.h"
 #include "position.h"
@@ -17,7 +19,8 @@ class Spawn;
 class Tile;
 
 using CreatureHashSet = std::unordered_set<Creature*>;
-using CreatureList = std::list<Creature*>;
+// a monster rarely has more than a handful of targets, keep them inline
+using CreatureList = boost::container::small_vector<Creature*, 8>;
 
 enum TargetSearchType_t {
 	TARGETSEARCH_DEFAULT,
@@ -119,9 +122,7 @@ class Monster final : public Creature {
                 void onRemoveCreature(Creature* creature, bool isLogout) override;
                 void onCreatureMove(Creature* creature, const Tile* newTile, const Position& newPos, const Tile* oldTile, const Position& oldPos, bool teleport) override;
                 void onCreatureSay(Creature* creature, SpeakClasses type, const std::string& text) override;
-#if ENABLE_INSTANCING
                 void onPlacedCreature() override;
-#endif
 
                 void drainHealth(Creature* attacker, int32_t damage) override;
 		void changeHealth(int32_t healthChange, bool sendHealthChange = true) override;
@@ -229,10 +230,23 @@ class Monster final : public Creature {
                         return getRankLootMultiplier();
                 }
 
+		bool getIdleStatus() const {
+			return isIdle;
+		}
+
         private:
 		CreatureHashSet friendList;
 		CreatureList targetList;
 
+		// canWalkTo answers for the eight tiles around origin, filled in as the
+		// step functions ask and dropped when a new step is being chosen
+		struct StepCache {
+			Position origin;
+			uint8_t known = 0;
+			uint8_t walkable = 0;
+		};
+		mutable StepCache stepCache;
+
 		std::string name;
 		std::string nameDescription;
 
@@ -291,9 +305,6 @@ class Monster final : public Creature {
 
 		void setIdle(bool idle);
 		void updateIdleStatus();
-		bool getIdleStatus() const {
-			return isIdle;
-		}
 
 		void onAddCondition(ConditionType_t type) override;
 		void onEndCondition(ConditionType_t type) override;
@@ -306,6 +317,10 @@ class Monster final : public Creature {
 		                  bool keepAttack = true, bool keepDistance = true);
 		bool isInSpawnRange(const Position& pos) const;
 		bool canWalkTo(Position pos, Direction direction) const;
+		void resetStepCache() const {
+			stepCache.origin = getPosition();
+			stepCache.known = 0;
+		}
 
 		static bool pushItem(Item* item);
 		static void pushItems(Tile* tile);
@@ -11,18 +11,67 @@
 
 extern Game g_game;
 extern LuaEnvironment g_luaEnvironment;
+extern Npcs* g_npcs;
 
 uint32_t Npc::npcAutoID = 0x80000000;
 
+namespace {
+
+std::atomic<size_t> npcScriptInterfaces{0};
+
+size_t getLuaMemoryUsage(lua_State* L) {
+	return (static_cast<size_t>(lua_gc(L, LUA_GCCOUNT, 0)) << 10) + static_cast<size_t>(lua_gc(L, LUA_GCCOUNTB, 0));
+}
+
+}
+
+std::shared_ptr<NpcScriptInterface> Npcs::getScriptInterface() {
+	if (!scriptInterface) {
+		auto newInterface = std::make_shared<NpcScriptInterface>();
+		if (!newInterface->loadNpcLib("data/npc/lib/npc.lua")) {
+			std::cout << "[Warning - Npcs::getScriptInterface] Can not load lib: data/npc/lib/npc.lua" << std::endl;
+			std::cout << newInterface->getLastLuaError() << std::endl;
+			return nullptr;
+		}
+		scriptInterface = std::move(newInterface);
+	}
+	return scriptInterface;
+}
+
 void Npcs::reload() {
 	const std::map<uint32_t, Npc*>& npcs = g_game.getNpcs();
 	for (const auto& it : npcs) {
 		it.second->closeAllShopWindows();
 	}
 
+	lua_State* L = g_luaEnvironment.getLuaState();
+	lua_gc(L, LUA_GCCOLLECT, 0);
+	const size_t interfacesBefore = NpcScriptInterface::getInstanceCount();
+	const size_t luaMemoryBefore = getLuaMemoryUsage(L);
+
+	const int64_t start = OTSYS_TIME();
+
+	// handlers still hold the previous interface until each npc has been reloaded
+	scriptInterface.reset();
+
+	size_t memoryUsage = 0;
 	for (const auto& it : npcs) {
-		it.second->reload();
+		Npc* npc = it.second;
+		npc->reload();
+		if (npc->npcEventHandler) {
+			memoryUsage += npc->npcEventHandler->getMemoryUsage();
+		}
+	}
+
+	if (!npcs.empty()) {
+		std::cout << ">> Reloaded " << npcs.size() << " npcs in " << (OTSYS_TIME() - start) << " ms, "
+		          << (memoryUsage / npcs.size()) << " bytes of Lua memory per npc script." << std::endl;
 	}
+
+	// a count still above one after the reload means something kept an old interface alive
+	lua_gc(L, LUA_GCCOLLECT, 0);
+	std::cout << ">> Npc script interfaces: " << interfacesBefore << " -> " << NpcScriptInterface::getInstanceCount()
+	          << ", Lua memory: " << (luaMemoryBefore >> 10) << " KB -> " << (getLuaMemoryUsage(L) >> 10) << " KB." << std::endl;
 }
 
 Npc* Npc::createNpc(const std::string& name) {
@@ -516,6 +565,15 @@ NpcScriptInterface::NpcScriptInterface() :
 	LuaScriptInterface("Npc interface") {
 	libLoaded = false;
 	initState();
+	++npcScriptInterfaces;
+}
+
+NpcScriptInterface::~NpcScriptInterface() {
+	--npcScriptInterfaces;
+}
+
+size_t NpcScriptInterface::getInstanceCount() {
+	return npcScriptInterfaces;
 }
 
 bool NpcScriptInterface::initState() {
@@ -538,6 +596,60 @@ bool NpcScriptInterface::closeState() {
 	return true;
 }
 
+int32_t NpcScriptInterface::loadScript(const std::string& file, Npc* npc) {
+	// setmetatable({}, {__index = _G})
+	lua_newtable(L);
+	lua_createtable(L, 0, 1);
+	lua_getglobal(L, "_G");
+	lua_setfield(L, -2, "__index");
+	lua_setmetatable(L, -2);
+	int32_t environment = luaL_ref(L, LUA_REGISTRYINDEX);
+
+	if (loadFile(file, npc, environment) == -1) {
+		luaL_unref(L, LUA_REGISTRYINDEX, environment);
+		return LUA_NOREF;
+	}
+	return environment;
+}
+
+int32_t NpcScriptInterface::getEnvironmentEvent(int32_t environment, const std::string& eventName) {
+	lua_rawgeti(L, LUA_REGISTRYINDEX, environment);
+	lua_getfield(L, -1, eventName.c_str());
+	lua_remove(L, -2);
+
+	int32_t eventId = getEvent();
+	if (eventId == -1) {
+		lua_pop(L, 1);
+		return -1;
+	}
+
+	// getEvent() labels it "<file>:callback"; name the actual event instead
+	std::string& fileName = cacheFiles[eventId];
+	fileName.replace(fileName.rfind(':') + 1, std::string::npos, eventName);
+	return eventId;
+}
+
+void NpcScriptInterface::releaseScript(int32_t environment, std::initializer_list<int32_t> events) {
+	// npcs can outlive the Lua state at shutdown; closing it already freed everything
+	if (!L || !g_luaEnvironment.getLuaState() || eventTableRef == -1) {
+		return;
+	}
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, eventTableRef);
+	for (int32_t eventId : events) {
+		if (eventId == -1) {
+			continue;
+		}
+
+		lua_pushnil(L);
+		lua_rawseti(L, -2, eventId);
+		cacheFiles.erase(eventId);
+	}
+	lua_pop(L, 1);
+
+	luaL_unref(L, LUA_REGISTRYINDEX, environment);
+}
+
 bool NpcScriptInterface::loadNpcLib(const std::string& file) {
 	if (libLoaded) {
 		return true;
@@ -1042,25 +1154,38 @@ int NpcScriptInterface::luaNpcCloseShopWindow(lua_State* L) {
 	return 1;
 }
 
-NpcEventsHandler::NpcEventsHandler(const std::string& file, Npc* npc) : scriptInterface(std::make_unique<NpcScriptInterface>()), npc(npc) {
-	if (!scriptInterface->loadNpcLib("data/npc/lib/npc.lua")) {
+NpcEventsHandler::NpcEventsHandler(const std::string& file, Npc* npc) : scriptInterface(g_npcs->getScriptInterface()), npc(npc) {
+	if (!scriptInterface) {
 		std::cout << "[Warning - NpcLib::NpcLib] Can not load lib: " << file << std::endl;
-		std::cout << scriptInterface->getLastLuaError() << std::endl;
 		return;
 	}
 
-	loaded = scriptInterface->loadFile("data/npc/scripts/" + file, npc) == 0;
+	lua_State* L = scriptInterface->getLuaState();
+	const size_t memoryBefore = getLuaMemoryUsage(L);
+
+	environment = scriptInterface->loadScript("data/npc/scripts/" + file, npc);
+	loaded = environment != LUA_NOREF;
 	if (!loaded) {
 		std::cout << "[Warning - NpcScript::NpcScript] Can not load script: " << file << std::endl;
 		std::cout << scriptInterface->getLastLuaError() << std::endl;
 	} else {
-		creatureSayEvent = scriptInterface->getEvent("onCreatureSay");
-		creatureDisappearEvent = scriptInterface->getEvent("onCreatureDisappear");
-		creatureAppearEvent = scriptInterface->getEvent("onCreatureAppear");
-		creatureMoveEvent = scriptInterface->getEvent("onCreatureMove");
-		playerCloseChannelEvent = scriptInterface->getEvent("onPlayerCloseChannel");
-		playerEndTradeEvent = scriptInterface->getEvent("onPlayerEndTrade");
-		thinkEvent = scriptInterface->getEvent("onThink");
+		creatureSayEvent = scriptInterface->getEnvironmentEvent(environment, "onCreatureSay");
+		creatureDisappearEvent = scriptInterface->getEnvironmentEvent(environment, "onCreatureDisappear");
+		creatureAppearEvent = scriptInterface->getEnvironmentEvent(environment, "onCreatureAppear");
+		creatureMoveEvent = scriptInterface->getEnvironmentEvent(environment, "onCreatureMove");
+		playerCloseChannelEvent = scriptInterface->getEnvironmentEvent(environment, "onPlayerCloseChannel");
+		playerEndTradeEvent = scriptInterface->getEnvironmentEvent(environment, "onPlayerEndTrade");
+		thinkEvent = scriptInterface->getEnvironmentEvent(environment, "onThink");
+	}
+
+	const size_t memoryAfter = getLuaMemoryUsage(L);
+	memoryUsage = memoryAfter > memoryBefore ? memoryAfter - memoryBefore : 0;
+}
+
+NpcEventsHandler::~NpcEventsHandler() {
+	if (scriptInterface && environment != LUA_NOREF) {
+		scriptInterface->releaseScript(environment, {creatureSayEvent, creatureDisappearEvent, creatureAppearEvent,
+			creatureMoveEvent, playerCloseChannelEvent, playerEndTradeEvent, thinkEvent});
 	}
 }
 
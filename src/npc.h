@@ -10,17 +10,41 @@
 class Npc;
 class Player;
 
+class NpcScriptInterface;
+
 class Npcs {
 	public:
-		static void reload();
+		Npcs() = default;
+
+		// non-copyable
+		Npcs(const Npcs&) = delete;
+		Npcs& operator=(const Npcs&) = delete;
+
+		void reload();
+
+		// All npc scripts share one interface (and one load of the npc lib); every
+		// script runs in its own environment table so their globals stay isolated.
+		std::shared_ptr<NpcScriptInterface> getScriptInterface();
+
+	private:
+		std::shared_ptr<NpcScriptInterface> scriptInterface;
 };
 
 class NpcScriptInterface final : public LuaScriptInterface {
 	public:
 		NpcScriptInterface();
+		~NpcScriptInterface();
+
+		// interfaces alive, including ones still held by npcs awaiting reload
+		static size_t getInstanceCount();
 
 		bool loadNpcLib(const std::string& file);
 
+		// Runs file inside a fresh environment table inheriting from _G; returns a registry ref to it or LUA_NOREF.
+		int32_t loadScript(const std::string& file, Npc* npc);
+		int32_t getEnvironmentEvent(int32_t environment, const std::string& eventName);
+		void releaseScript(int32_t environment, std::initializer_list<int32_t> events);
+
 	private:
 		void registerFunctions();
 
@@ -54,6 +78,11 @@ class NpcScriptInterface final : public LuaScriptInterface {
 class NpcEventsHandler {
 	public:
 		NpcEventsHandler(const std::string& file, Npc* npc);
+		~NpcEventsHandler();
+
+		// non-copyable
+		NpcEventsHandler(const NpcEventsHandler&) = delete;
+		NpcEventsHandler& operator=(const NpcEventsHandler&) = delete;
 
 		void onCreatureAppear(Creature* creature);
 		void onCreatureDisappear(Creature* creature);
@@ -65,10 +94,16 @@ class NpcEventsHandler {
 		void onThink();
 
 		bool isLoaded() const;
-		std::unique_ptr<NpcScriptInterface> scriptInterface;
+		size_t getMemoryUsage() const {
+			return memoryUsage;
+		}
+
+		std::shared_ptr<NpcScriptInterface> scriptInterface;
 
 	private:
 		Npc* npc;
+		int32_t environment = LUA_NOREF;
+		size_t memoryUsage = 0;
 
 		int32_t creatureAppearEvent = -1;
 		int32_t creatureDisappearEvent = -1;
@@ -13,6 +13,7 @@
 #include "monsters.h"
 #include "monster/Rank.hpp"
 #include "outfit.h"
+#include "playerjournal.h"
 #include "protocollogin.h"
 #include "protocolold.h"
 #include "protocolstatus.h"
@@ -27,6 +28,7 @@
 
 #ifdef WITH_PYTHON
 #include "python/PythonEngine.h"
+#include "python/WorldSnapshot.h"
 #endif
 
 #include <algorithm>
@@ -46,6 +48,7 @@
 #endif
 
 DatabaseTasks g_databaseTasks;
+PlayerJournal g_playerJournal;
 Dispatcher g_dispatcher;
 Scheduler g_scheduler;
 
@@ -627,6 +630,16 @@ namespace {
         }
         StartupProbe::mark("migrations");
 
+        // replays what a crash left in the journal, before anything reads players back
+        if (!g_playerJournal.open()) {
+            startupErrorMessage("Unable to open the player journal. See logs for details.");
+            return;
+        }
+
+        if (g_playerJournal.isOpen()) {
+            g_playerJournal.start();
+        }
+
         //load vocations
         logger.info("Loading vocations");
         if (!g_vocations.loadFromXml()) {
@@ -749,8 +762,8 @@ namespace {
 
         g_game.map.houses.payHouses(rentPeriod);
 
+        IOMarket::getInstance().load();
         IOMarket::checkExpiredOffers();
-        IOMarket::getInstance().updateStatistics();
 
         StartupProbe::mark("ready");
         logger.info("Loaded all modules, server starting up...");
@@ -766,6 +779,7 @@ namespace {
 #ifdef WITH_PYTHON
         if (getBoolean(ConfigManager::PYTHON_ENABLED) && PythonEngine::instance().isReady()) {
             PythonEngine::instance().onServerStart();
+            WorldSnapshot::instance().start(std::max<int32_t>(0, getNumber(ConfigManager::PYTHON_SNAPSHOT_INTERVAL)), std::max<int32_t>(0, getNumber(ConfigManager::PYTHON_SNAPSHOT_BUDGET)));
         }
 #endif
         StartupProbe::mark(nullptr);
@@ -803,6 +817,7 @@ bool startServer() {
         Logger::instance().error("No services running. The server is NOT online.");
         g_scheduler.shutdown();
         g_databaseTasks.shutdown();
+        g_playerJournal.shutdown();
         g_dispatcher.shutdown();
     }
 
@@ -31,6 +31,7 @@ namespace {
 	void sendAll(const std::vector<Protocol_ptr>& bufferedProtocol) {
 		//dispatcher thread
 		for (auto& protocol : bufferedProtocol) {
+			protocol->onAutoSend();
 			auto& msg = protocol->getCurrentBuffer();
 			if (msg) {
 				protocol->send(std::move(msg));
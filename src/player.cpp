@@ -19,6 +19,7 @@
 #include "npc.h"
 #include "outfit.h"
 #include "party.h"
+#include "playerjournal.h"
 #include "scheduler.h"
 #include "spectators.h"
 #include "storeinbox.h"
@@ -49,6 +50,8 @@ Player::Player(ProtocolGame_ptr p) :
 Player::~Player() {
 	for (Item* item : inventory) {
 		if (item) {
+			// e.g. an equipped ring, saved on logout and resumed on login
+			g_game.unscheduleDecay(item);
 			item->setParent(nullptr);
 			item->decrementReferenceCounter();
 		}
@@ -633,6 +636,16 @@ void Player::setStorageValue(uint32_t key, std::optional<int32_t> value, bool is
 	}
 
 	Creature::setStorageValue(key, value, isSpawn);
+
+	// values restored while loading are what the database already holds
+	if (!isSpawn) {
+		g_playerJournal.logStorage(this, key, value);
+	}
+}
+
+void Player::setBankBalance(uint64_t balance) {
+	bankBalance = balance;
+	g_playerJournal.logBalance(this);
 }
 
 bool Player::canSee(const Position& pos) const {
@@ -1650,6 +1663,7 @@ void Player::addExperience(Creature* source, uint64_t exp, bool sendText/* = fal
 	} else {
 		levelPercent = 0;
 	}
+	g_playerJournal.logLevel(this);
 	sendStats();
 }
 
@@ -1729,6 +1743,7 @@ void Player::removeExperience(uint64_t exp, bool sendText/* = false*/) {
 	} else {
 		levelPercent = 0;
 	}
+	g_playerJournal.logLevel(this);
 	sendStats();
 }
 
@@ -1950,6 +1965,7 @@ void Player::death(Creature* lastHitCreature) {
 			} else {
 				levelPercent = 0;
 			}
+			g_playerJournal.logLevel(this);
 		}
 
 		if (blessings.test(5)) {
@@ -1975,35 +1991,11 @@ void Player::death(Creature* lastHitCreature) {
 			mana = manaMax;
 		}
 
-		auto it = conditions.begin(), end = conditions.end();
-		while (it != end) {
-			Condition* condition = *it;
-			if (condition->isPersistent()) {
-				it = conditions.erase(it);
-
-				condition->endCondition(this);
-				onEndCondition(condition->getType());
-				delete condition;
-			} else {
-				++it;
-			}
-		}
+		removeConditionsIf([](const Condition* condition) { return condition->isPersistent(); });
 	} else {
 		setSkillLoss(true);
 
-		auto it = conditions.begin(), end = conditions.end();
-		while (it != end) {
-			Condition* condition = *it;
-			if (condition->isPersistent()) {
-				it = conditions.erase(it);
-
-				condition->endCondition(this);
-				onEndCondition(condition->getType());
-				delete condition;
-			} else {
-				++it;
-			}
-		}
+		removeConditionsIf([](const Condition* condition) { return condition->isPersistent(); });
 
 		health = healthMax;
 		g_game.internalTeleport(this, getTemplePosition(), true);
@@ -2659,6 +2651,7 @@ void Player::addThing(int32_t index, Thing* thing) {
 
 	item->setParent(this);
 	inventory[index] = item;
+	updateItemTypeCounts(item, true);
 
 	//send to client
 	sendInventoryItem(static_cast<slots_t>(index), item);
@@ -2675,8 +2668,10 @@ void Player::updateThing(Thing* thing, uint16_t itemId, uint32_t count) {
 		return /*RETURNVALUE_NOTPOSSIBLE*/;
 	}
 
+	updateItemTypeCounts(item, false);
 	item->setID(itemId);
 	item->setSubType(count);
+	updateItemTypeCounts(item, true);
 
 	//send to client
 	sendInventoryItem(static_cast<slots_t>(index), item);
@@ -2708,7 +2703,9 @@ void Player::replaceThing(uint32_t index, Thing* thing) {
 
 	item->setParent(this);
 
+	updateItemTypeCounts(oldItem, false);
 	inventory[index] = item;
+	updateItemTypeCounts(item, true);
 }
 
 void Player::removeThing(Thing* thing, uint32_t count) {
@@ -2722,6 +2719,8 @@ void Player::removeThing(Thing* thing, uint32_t count) {
 		return /*RETURNVALUE_NOTPOSSIBLE*/;
 	}
 
+	updateItemTypeCounts(item, false);
+
 	if (item->isStackable()) {
 		if (count == item->getItemCount()) {
 			//send change to client
@@ -2735,6 +2734,7 @@ void Player::removeThing(Thing* thing, uint32_t count) {
 		} else {
 			uint8_t newCount = static_cast<uint8_t>(std::max<int32_t>(0, item->getItemCount() - count));
 			item->setItemCount(newCount);
+			updateItemTypeCounts(item, true);
 
 			//send change to client
 			sendInventoryItem(static_cast<slots_t>(index), item);
@@ -2772,6 +2772,79 @@ size_t Player::getLastIndex() const {
 }
 
 uint32_t Player::getItemTypeCount(uint16_t itemId, int32_t subType /*= -1*/) const {
+	if (subType != -1) {
+		return countItemType(itemId, subType);
+	}
+
+	const auto& counts = getItemTypeCounts();
+	auto it = counts.find(itemId);
+	const uint32_t count = it != counts.end() ? it->second : 0;
+	assert(count == countItemType(itemId, -1));
+	return count;
+}
+
+const std::unordered_map<uint16_t, uint32_t>& Player::getItemTypeCounts() const {
+	if (itemTypeCountsValid) {
+		return itemTypeCounts;
+	}
+
+	itemTypeCounts.clear();
+	for (int32_t i = CONST_SLOT_FIRST; i <= CONST_SLOT_LAST; i++) {
+		Item* item = inventory[i];
+		if (!item) {
+			continue;
+		}
+
+		itemTypeCounts[item->getID()] += Item::countByType(item, -1);
+
+		if (Container* container = item->getContainer()) {
+			for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
+				itemTypeCounts[(*it)->getID()] += Item::countByType(*it, -1);
+			}
+		}
+	}
+	itemTypeCountsValid = true;
+	return itemTypeCounts;
+}
+
+void Player::updateItemTypeCounts(const Item* item, bool added) {
+	// nothing to keep up to date until the first lookup builds the counts
+	if (!itemTypeCountsValid) {
+		return;
+	}
+
+	auto update = [this, added](const Item* countedItem) {
+		auto it = itemTypeCounts.try_emplace(countedItem->getID(), 0).first;
+		if (added) {
+			it->second += countedItem->getItemCount();
+		} else if (it->second > countedItem->getItemCount()) {
+			it->second -= countedItem->getItemCount();
+		} else {
+			itemTypeCounts.erase(it);
+		}
+	};
+
+	update(item);
+	if (const Container* container = item->getContainer()) {
+		for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
+			update(*it);
+		}
+	}
+}
+
+bool Player::isInInventory(const Item* item) const {
+	// the store inbox and the depots have the player as their top parent too
+	const Item* topItem = item;
+	for (const Cylinder* parent = item->getParent(); parent != this; parent = topItem->getParent()) {
+		topItem = parent ? parent->getItem() : nullptr;
+		if (!topItem) {
+			return false;
+		}
+	}
+	return getThingIndex(topItem) != -1;
+}
+
+uint32_t Player::countItemType(uint16_t itemId, int32_t subType) const {
 	uint32_t count = 0;
 	for (int32_t i = CONST_SLOT_FIRST; i <= CONST_SLOT_LAST; i++) {
 		Item* item = inventory[i];
@@ -2799,6 +2872,10 @@ bool Player::removeItemOfType(uint16_t itemId, uint32_t amount, int32_t subType,
 		return true;
 	}
 
+	if (subType == -1 && getItemTypeCount(itemId) < amount) {
+		return false;
+	}
+
 	std::vector<Item*> itemList;
 
 	uint32_t count = 0;
@@ -2845,19 +2922,8 @@ bool Player::removeItemOfType(uint16_t itemId, uint32_t amount, int32_t subType,
 }
 
 std::map<uint32_t, uint32_t>& Player::getAllItemTypeCount(std::map<uint32_t, uint32_t>& countMap) const {
-	for (int32_t i = CONST_SLOT_FIRST; i <= CONST_SLOT_LAST; i++) {
-		Item* item = inventory[i];
-		if (!item) {
-			continue;
-		}
-
-		countMap[item->getID()] += Item::countByType(item, -1);
-
-		if (Container* container = item->getContainer()) {
-			for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
-				countMap[(*it)->getID()] += Item::countByType(*it, -1);
-			}
-		}
+	for (const auto& it : getItemTypeCounts()) {
+		countMap[it.first] += it.second;
 	}
 	return countMap;
 }
@@ -2870,6 +2936,8 @@ Thing* Player::getThing(size_t index) const {
 }
 
 void Player::postAddNotification(Thing* thing, const Cylinder* oldParent, int32_t index, cylinderlink_t link /*= LINK_OWNER*/) {
+	g_playerJournal.markItemsDirty(getGUID());
+
 	if (link == LINK_OWNER) {
 		//calling movement scripts
 		g_moveEvents->onPlayerEquip(this, thing->getItem(), static_cast<slots_t>(index), false);
@@ -2924,6 +2992,8 @@ void Player::postAddNotification(Thing* thing, const Cylinder* oldParent, int32_
 }
 
 void Player::postRemoveNotification(Thing* thing, const Cylinder* newParent, int32_t index, cylinderlink_t link /*= LINK_OWNER*/) {
+	g_playerJournal.markItemsDirty(getGUID());
+
 	if (link == LINK_OWNER) {
 		//calling movement scripts
 		g_moveEvents->onPlayerDeEquip(this, thing->getItem(), static_cast<slots_t>(index));
@@ -3045,6 +3115,7 @@ void Player::internalAddThing(uint32_t index, Thing* thing) {
 
 		inventory[index] = item;
 		item->setParent(this);
+		itemTypeCountsValid = false;
 	}
 }
 
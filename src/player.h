@@ -185,9 +185,7 @@ class Player final : public Creature, public Cylinder {
 		uint64_t getBankBalance() const {
 			return bankBalance;
 		}
-		void setBankBalance(uint64_t balance) {
-			bankBalance = balance;
-		}
+		void setBankBalance(uint64_t balance);
 
 		Guild_ptr getGuild() const {
 			return guild;
@@ -429,6 +427,11 @@ class Player final : public Creature, public Cylinder {
 
 		bool removeItemOfType(uint16_t itemId, uint32_t amount, int32_t subType, bool ignoreEquipped = false) const;
 
+		// Adds or subtracts an item and everything inside it from the item type
+		// counts; called by the inventory and its containers as they change.
+		void updateItemTypeCounts(const Item* item, bool added);
+		bool isInInventory(const Item* item) const;
+
 		uint32_t getCapacity() const {
 			if (hasFlag(PlayerFlag_CannotPickupItem)) {
 				return 0;
@@ -1183,6 +1186,9 @@ class Player final : public Creature, public Cylinder {
 
 		void updateInventoryWeight();
 
+		const std::unordered_map<uint16_t, uint32_t>& getItemTypeCounts() const;
+		uint32_t countItemType(uint16_t itemId, int32_t subType) const;
+
 		void setNextWalkActionTask(SchedulerTask* task);
 		void setNextActionTask(SchedulerTask* task, bool resetIdleTime = true);
 
@@ -1280,6 +1286,11 @@ class Player final : public Creature, public Cylinder {
 		std::map<uint32_t, DepotChest_ptr> depotChests;
 		std::map<uint32_t, DepotLocker_ptr> depotLockerMap;
 
+		// item id -> count over the inventory and everything inside it, built on
+		// the first lookup after login and kept up to date from then on
+		mutable std::unordered_map<uint16_t, uint32_t> itemTypeCounts;
+		mutable bool itemTypeCountsValid = false;
+
 		uint32_t inventoryWeight = 0;
 		uint32_t capacity = 40000;
 		uint32_t damageImmunities = 0;
@@ -1381,6 +1392,7 @@ class Player final : public Creature, public Cylinder {
 		friend class Map;
 		friend class Actions;
 		friend class IOLoginData;
+		friend class PlayerJournal;
 		friend class ProtocolGame;
 };
 
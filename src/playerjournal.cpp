@@ -0,0 +1,748 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "playerjournal.h"
+
+#include "configmanager.h"
+#include "game/game.h"
+#include "iologindata.h"
+#include "tasks.h"
+#include "utils/Logger.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+extern Game g_game;
+
+namespace {
+
+constexpr char JOURNAL_MAGIC[8] = {'T', 'F', 'S', 'J', 'R', 'N', 'L', '\0'};
+constexpr uint32_t JOURNAL_VERSION = 2;
+
+struct JournalHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	uint64_t epoch;
+};
+
+// records start here; the rest of the first cache line is left for future header fields
+constexpr size_t HEADER_SIZE = 64;
+
+struct RecordHeader {
+	uint32_t size; // payload bytes
+	uint32_t checksum;
+	uint32_t guid;
+	uint8_t type;
+	uint8_t padding[3];
+};
+
+static_assert(sizeof(JournalHeader) <= HEADER_SIZE);
+static_assert(sizeof(RecordHeader) == 16);
+
+struct LevelPayload {
+	uint64_t experience;
+	uint32_t level;
+	int32_t healthMax;
+	uint32_t manaMax;
+	uint32_t capacity;
+};
+
+struct StoragePayload {
+	uint32_t key;
+	int32_t value;
+};
+
+// records are 8-byte aligned
+size_t getRecordSize(size_t payloadSize) {
+	return (sizeof(RecordHeader) + payloadSize + 7) & ~size_t(7);
+}
+
+// FNV-1a over the epoch, the record header and its payload
+uint32_t getChecksum(uint64_t epoch, const RecordHeader& header, std::string_view payload) {
+	uint32_t hash = 2166136261u;
+	auto add = [&hash](const void* bytes, size_t size) {
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= static_cast<const uint8_t*>(bytes)[i];
+			hash *= 16777619u;
+		}
+	};
+
+	add(&epoch, sizeof(epoch));
+	add(&header.size, sizeof(header.size));
+	add(&header.guid, sizeof(header.guid));
+	add(&header.type, sizeof(header.type));
+	add(payload.data(), payload.size());
+	return hash;
+}
+
+// FNV-1a over a whole item section, to tell whether it changed since it was last journaled
+uint64_t getSectionHash(std::string_view section) {
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : section) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// the key of a player's item section in PlayerJournal::itemHashes
+uint64_t getSectionKey(uint32_t guid, uint8_t table) {
+	return (static_cast<uint64_t>(guid) << 8) | table;
+}
+
+void writeRecord(char* record, uint64_t epoch, JournalRecord type, uint32_t guid, std::string_view payload) {
+	std::memcpy(record + sizeof(RecordHeader), payload.data(), payload.size());
+
+	RecordHeader header{};
+	header.size = static_cast<uint32_t>(payload.size());
+	header.guid = guid;
+	header.type = static_cast<uint8_t>(type);
+	header.checksum = getChecksum(epoch, header, payload);
+
+	// the header goes last, so a record torn by a crash never validates
+	std::memcpy(record, &header, sizeof(header));
+}
+
+template <typename T>
+std::string_view asPayload(const T& value) {
+	return {reinterpret_cast<const char*>(&value), sizeof(T)};
+}
+
+// What the journal holds about one player once its records are folded together.
+struct ReplayPlayer {
+	std::optional<LevelPayload> level;
+	std::optional<uint64_t> balance;
+	std::map<uint32_t, std::optional<int32_t>> storage;
+	// the latest ITEMS record of each item section, indexed by PlayerItemTable
+	std::array<std::string_view, PLAYER_ITEMS_LAST + 1> items;
+};
+
+// Folds the records of the given epoch up to the first one that does not
+// validate, or up to end; returns where it stopped.
+size_t foldRecords(const char* data, size_t end, uint64_t epoch, std::map<uint32_t, ReplayPlayer>& players, uint64_t& count) {
+	size_t offset = HEADER_SIZE;
+	while (end - offset >= sizeof(RecordHeader)) {
+		RecordHeader header;
+		std::memcpy(&header, data + offset, sizeof(header));
+		if (header.type == 0 || header.size > end - offset - sizeof(RecordHeader)) {
+			break;
+		}
+
+		// the first record that does not validate is where the last run stopped writing
+		std::string_view payload{data + offset + sizeof(RecordHeader), header.size};
+		if (getChecksum(epoch, header, payload) != header.checksum) {
+			break;
+		}
+
+		offset += std::min(getRecordSize(header.size), end - offset);
+		++count;
+
+		switch (static_cast<JournalRecord>(header.type)) {
+			case JournalRecord::LEVEL: {
+				LevelPayload level;
+				if (payload.size() == sizeof(level)) {
+					std::memcpy(&level, payload.data(), sizeof(level));
+					players[header.guid].level = level;
+				}
+				break;
+			}
+
+			case JournalRecord::BALANCE: {
+				uint64_t balance;
+				if (payload.size() == sizeof(balance)) {
+					std::memcpy(&balance, payload.data(), sizeof(balance));
+					players[header.guid].balance = balance;
+				}
+				break;
+			}
+
+			case JournalRecord::STORAGE_SET: {
+				StoragePayload storage;
+				if (payload.size() == sizeof(storage)) {
+					std::memcpy(&storage, payload.data(), sizeof(storage));
+					players[header.guid].storage[storage.key] = storage.value;
+				}
+				break;
+			}
+
+			case JournalRecord::STORAGE_ERASE: {
+				uint32_t key;
+				if (payload.size() == sizeof(key)) {
+					std::memcpy(&key, payload.data(), sizeof(key));
+					players[header.guid].storage[key] = std::nullopt;
+				}
+				break;
+			}
+
+			case JournalRecord::ITEMS: {
+				const uint8_t table = payload.empty() ? 0xFF : static_cast<uint8_t>(payload.front());
+				if (table <= PLAYER_ITEMS_LAST) {
+					players[header.guid].items[table] = payload;
+				}
+				break;
+			}
+
+			case JournalRecord::SAVED:
+				players.erase(header.guid);
+				break;
+
+			default:
+				break;
+		}
+	}
+	return offset;
+}
+
+// one item section: (u8 table, {u8 1, i32 pid, i32 sid, u16 type, u16 count, string attributes}..., u8 0)
+bool replayItems(Database& db, uint32_t guid, std::string_view section) {
+	PropStream stream;
+	stream.init(section.data(), section.size());
+
+	uint8_t table;
+	if (!stream.read<uint8_t>(table) || table > PLAYER_ITEMS_LAST) {
+		return false;
+	}
+
+	ItemRowList rows;
+	uint8_t hasRow;
+	while (stream.read<uint8_t>(hasRow) && hasRow != 0) {
+		ItemRow& row = rows.emplace_back();
+		if (!stream.read<int32_t>(row.pid) || !stream.read<int32_t>(row.sid) || !stream.read<uint16_t>(row.itemType) || !stream.read<uint16_t>(row.count)) {
+			return false;
+		}
+
+		auto [attributes, ok] = stream.readString();
+		if (!ok) {
+			return false;
+		}
+		row.attributes = attributes;
+	}
+
+	// written in the configured itemStorage format
+	return IOLoginData::saveItemRows(db, guid, static_cast<PlayerItemTable>(table), rows);
+}
+
+bool replayPlayer(Database& db, uint32_t guid, const ReplayPlayer& player) {
+	// deleted characters and those flagged save = 0 keep what they have
+	DBStatementResult_ptr result = db.storeStatement("SELECT `save` FROM `players` WHERE `id` = ?", {guid});
+	if (!result || result->getNumber<uint16_t>(0) == 0) {
+		return true;
+	}
+
+	DBTransaction transaction;
+	if (!transaction.begin()) {
+		return false;
+	}
+
+	if (const auto& level = player.level) {
+		if (!db.executeStatement("UPDATE `players` SET `experience` = ?, `level` = ?, `healthmax` = ?, `manamax` = ?, `cap` = ? WHERE `id` = ?", {level->experience, level->level, level->healthMax, level->manaMax, level->capacity / 100, guid})) {
+			return false;
+		}
+	}
+
+	if (player.balance && !db.executeStatement("UPDATE `players` SET `balance` = ? WHERE `id` = ?", {*player.balance, guid})) {
+		return false;
+	}
+
+	DBStatementInsert storageQuery(db, "INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ", 3, " ON DUPLICATE KEY UPDATE `value` = VALUES(`value`)");
+	for (const auto& [key, value] : player.storage) {
+		if (value) {
+			if (!storageQuery.addRow({guid, key, *value})) {
+				return false;
+			}
+		} else if (!db.executeStatement("DELETE FROM `player_storage` WHERE `player_id` = ? AND `key` = ?", {guid, key})) {
+			return false;
+		}
+	}
+
+	if (!storageQuery.execute()) {
+		return false;
+	}
+
+	for (std::string_view section : player.items) {
+		if (!section.empty() && !replayItems(db, guid, section)) {
+			return false;
+		}
+	}
+	return transaction.commit();
+}
+
+} // namespace
+
+PlayerJournal::PlayerJournal() = default;
+PlayerJournal::~PlayerJournal() = default;
+
+bool PlayerJournal::open() {
+	const std::string& path = getString(ConfigManager::PLAYER_JOURNAL_FILE);
+	if (path.empty()) {
+		return true;
+	}
+
+	const size_t size = std::max<int64_t>(getNumber(ConfigManager::PLAYER_JOURNAL_SIZE), 1) * 1024 * 1024;
+
+	std::error_code ec;
+	if (!std::filesystem::exists(path, ec)) {
+		std::ofstream{path, std::ios::binary};
+		std::filesystem::resize_file(path, size, ec);
+		if (ec) {
+			Logger::instance().error(fmt::format("[PlayerJournal] Unable to create {}: {}", path, ec.message()));
+			return false;
+		}
+	}
+
+	if (!map(path)) {
+		return false;
+	}
+
+	// whatever is left was written after the last save that reached the database
+	if (!replay()) {
+		Logger::instance().error(fmt::format("[PlayerJournal] Replaying {} failed; the journal is kept for the next start.", path));
+		return false;
+	}
+
+	if (capacity != size) {
+		region.reset();
+		file.reset();
+		data = nullptr;
+
+		std::filesystem::resize_file(path, size, ec);
+		if (ec) {
+			Logger::instance().error(fmt::format("[PlayerJournal] Unable to resize {}: {}", path, ec.message()));
+			return false;
+		}
+
+		if (!map(path)) {
+			return false;
+		}
+	}
+
+	truncate();
+	return true;
+}
+
+bool PlayerJournal::map(const std::string& path) {
+	using namespace boost::interprocess;
+	try {
+		file = std::make_unique<file_mapping>(path.c_str(), read_write);
+		region = std::make_unique<mapped_region>(*file, read_write);
+	} catch (const interprocess_exception& e) {
+		Logger::instance().error(fmt::format("[PlayerJournal] Unable to map {}: {}", path, e.what()));
+		region.reset();
+		file.reset();
+		return false;
+	}
+
+	data = static_cast<char*>(region->get_address());
+	capacity = region->get_size();
+	if (capacity < HEADER_SIZE + sizeof(RecordHeader)) {
+		Logger::instance().error(fmt::format("[PlayerJournal] {} is too small to hold a journal.", path));
+		region.reset();
+		file.reset();
+		data = nullptr;
+		return false;
+	}
+
+	JournalHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 || header.version != JOURNAL_VERSION) {
+		header = {};
+		std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+		header.version = JOURNAL_VERSION;
+		header.epoch = 1;
+		std::memcpy(data, &header, sizeof(header));
+	}
+
+	epoch.store(header.epoch, std::memory_order_relaxed);
+	writeOffset.store(HEADER_SIZE, std::memory_order_relaxed);
+	syncedEpoch = 0;
+	syncedOffset = 0;
+	return true;
+}
+
+bool PlayerJournal::replay() {
+	const uint64_t currentEpoch = epoch.load(std::memory_order_relaxed);
+
+	std::map<uint32_t, ReplayPlayer> players;
+	foldRecords(data, capacity, currentEpoch, players, replayedRecords);
+
+	if (players.empty()) {
+		return true;
+	}
+
+	Logger::instance().warn(fmt::format("[PlayerJournal] Unclean shutdown, replaying {} records for {} players.", replayedRecords, players.size()));
+
+	Database& db = Database::getInstance();
+	for (const auto& [guid, player] : players) {
+		if (!replayPlayer(db, guid, player)) {
+			Logger::instance().error(fmt::format("[PlayerJournal] Unable to replay player {}.", guid));
+			return false;
+		}
+		++replayedPlayers;
+	}
+	return true;
+}
+
+void PlayerJournal::shutdown() {
+	if (!data) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lockGuard(syncLock);
+		stop();
+	}
+	syncSignal.notify_one();
+	join();
+
+	writeItemSnapshots();
+	sync();
+
+	region.reset();
+	file.reset();
+	data = nullptr;
+}
+
+void PlayerJournal::logLevel(const Player* player) {
+	if (!data) {
+		return;
+	}
+
+	flushItems(player);
+	const LevelPayload level{player->experience, player->level, player->healthMax, player->manaMax, player->capacity};
+	append(JournalRecord::LEVEL, player->getGUID(), asPayload(level));
+}
+
+void PlayerJournal::logBalance(const Player* player) {
+	if (!data) {
+		return;
+	}
+
+	flushItems(player);
+	const uint64_t balance = player->bankBalance;
+	append(JournalRecord::BALANCE, player->getGUID(), asPayload(balance));
+}
+
+void PlayerJournal::logStorage(const Player* player, uint32_t key, std::optional<int32_t> value) {
+	if (!data) {
+		return;
+	}
+
+	flushItems(player);
+	if (value) {
+		append(JournalRecord::STORAGE_SET, player->getGUID(), asPayload(StoragePayload{key, *value}));
+	} else {
+		append(JournalRecord::STORAGE_ERASE, player->getGUID(), asPayload(key));
+	}
+}
+
+void PlayerJournal::logSaved(uint32_t guid) {
+	if (!data) {
+		return;
+	}
+
+	dirtyItems.erase(guid);
+	// the database holds every section now, whatever the journal last saw of them
+	for (uint8_t table = PLAYER_ITEMS_FIRST; table <= PLAYER_ITEMS_LAST; ++table) {
+		itemHashes.erase(getSectionKey(guid, table));
+	}
+
+	if (!unsaved.contains(guid)) {
+		return;
+	}
+
+	if (append(JournalRecord::SAVED, guid, {})) {
+		unsaved.erase(guid);
+	}
+}
+
+void PlayerJournal::markItemsDirty(uint32_t guid) {
+	if (data) {
+		dirtyItems.insert(guid);
+	}
+}
+
+void PlayerJournal::truncate() {
+	if (!data) {
+		return;
+	}
+
+	if (!unsaved.empty()) {
+		Logger::instance().warn(fmt::format("[PlayerJournal] {} players have changes that were not saved, keeping the journal.", unsaved.size()));
+		return;
+	}
+
+	startEpoch(epoch.load(std::memory_order_relaxed) + 1, HEADER_SIZE);
+	full = false;
+}
+
+void PlayerJournal::startEpoch(uint64_t newEpoch, size_t offset) {
+	JournalHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	header.epoch = newEpoch;
+	std::memcpy(data, &header, sizeof(header));
+
+	// synced right away: records of the old epoch must not outlive the save that made them obsolete
+	region->flush(0, HEADER_SIZE, false);
+
+	// the journal thread must never pair the new epoch with the old offset
+	positionSequence.fetch_add(1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	epoch.store(newEpoch, std::memory_order_relaxed);
+	writeOffset.store(offset, std::memory_order_relaxed);
+	positionSequence.fetch_add(1, std::memory_order_release);
+}
+
+bool PlayerJournal::compact(size_t needed) {
+	const uint64_t currentEpoch = epoch.load(std::memory_order_relaxed);
+
+	std::map<uint32_t, ReplayPlayer> players;
+	uint64_t count = 0;
+	const size_t used = foldRecords(data, writeOffset.load(std::memory_order_relaxed), currentEpoch, players, count);
+
+	// the latest state of every unsaved player, checksummed for the next epoch
+	const uint64_t nextEpoch = currentEpoch + 1;
+	std::string image;
+	auto add = [&image, nextEpoch](JournalRecord type, uint32_t guid, std::string_view payload) {
+		const size_t offset = image.size();
+		image.resize(offset + getRecordSize(payload.size()));
+		writeRecord(image.data() + offset, nextEpoch, type, guid, payload);
+	};
+
+	for (const auto& [guid, player] : players) {
+		if (player.level) {
+			add(JournalRecord::LEVEL, guid, asPayload(*player.level));
+		}
+		if (player.balance) {
+			add(JournalRecord::BALANCE, guid, asPayload(*player.balance));
+		}
+		for (const auto& [key, value] : player.storage) {
+			if (value) {
+				add(JournalRecord::STORAGE_SET, guid, asPayload(StoragePayload{key, *value}));
+			} else {
+				add(JournalRecord::STORAGE_ERASE, guid, asPayload(key));
+			}
+		}
+		for (std::string_view section : player.items) {
+			if (!section.empty()) {
+				add(JournalRecord::ITEMS, guid, section);
+			}
+		}
+	}
+
+	if (image.size() + needed > capacity - HEADER_SIZE) {
+		return false;
+	}
+
+	// the copy only becomes valid with the new epoch, and the new epoch is only
+	// written once the copy is on disk; a crash in between replays nothing
+	std::memcpy(data + HEADER_SIZE, image.data(), image.size());
+	region->flush(HEADER_SIZE, image.size(), false);
+	startEpoch(nextEpoch, HEADER_SIZE + image.size());
+
+	Logger::instance().info(fmt::format("[PlayerJournal] Journal compacted from {} to {} bytes for {} players.", used, HEADER_SIZE + image.size(), players.size()));
+	return true;
+}
+
+bool PlayerJournal::checkpoint() {
+	std::vector<Player*> players;
+	players.reserve(unsaved.size());
+	for (uint32_t guid : unsaved) {
+		if (Player* player = g_game.getPlayerByGUID(guid)) {
+			players.push_back(player);
+		}
+		// otherwise logged out, and saved on the way
+	}
+
+	Logger::instance().warn(fmt::format("[PlayerJournal] Journal is full, saving {} players to start a new one.", players.size()));
+
+	// nothing in the journal is needed once they are saved, and the saves must not journal themselves
+	unsaved.clear();
+	itemHashes.clear();
+	if (!IOLoginData::savePlayers(players)) {
+		return false;
+	}
+
+	truncate();
+	return true;
+}
+
+bool PlayerJournal::append(JournalRecord type, uint32_t guid, std::string_view payload) {
+	if (full) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	size_t offset = writeOffset.load(std::memory_order_relaxed);
+	const size_t size = getRecordSize(payload.size());
+	if (size > capacity - offset) {
+		// fold the journal down to the latest state of each player; if even that
+		// does not leave room, save them. SAVED records are written from within
+		// a save, so those never start another one.
+		const bool hasRoom = compact(size) || (type != JournalRecord::SAVED && checkpoint() && size <= capacity - HEADER_SIZE);
+		if (!hasRoom) {
+			// a journal with gaps could replay a player into a state that never existed,
+			// so drop it entirely; the next server save starts a new one
+			Logger::instance().warn("[PlayerJournal] Journal is full, changes are not journaled until the next server save.");
+			unsaved.clear();
+			itemHashes.clear();
+			truncate();
+			full = true;
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		offset = writeOffset.load(std::memory_order_relaxed);
+	}
+
+	writeRecord(data + offset, epoch.load(std::memory_order_relaxed), type, guid, payload);
+	writeOffset.store(offset + size, std::memory_order_release);
+	records.fetch_add(1, std::memory_order_relaxed);
+
+	if (type != JournalRecord::SAVED) {
+		unsaved.insert(guid);
+	}
+	return true;
+}
+
+void PlayerJournal::writeItemSnapshots() {
+	if (!data || dirtyItems.empty()) {
+		return;
+	}
+
+	// a full journal saves players while this runs, and each save clears their entry
+	std::unordered_set<uint32_t> pending;
+	pending.swap(dirtyItems);
+	for (uint32_t guid : pending) {
+		const Player* player = g_game.getPlayerByGUID(guid);
+		if (player) {
+			writeItemSnapshot(player);
+		}
+		// otherwise logged out, and saved on the way
+	}
+}
+
+void PlayerJournal::flushItems(const Player* player) {
+	// replay applies records in order, so a balance or level written ahead of
+	// the items it was traded for would hand them back on top of the new value
+	if (dirtyItems.erase(player->getGUID()) != 0) {
+		writeItemSnapshot(player);
+	}
+}
+
+void PlayerJournal::writeItemSnapshot(const Player* player) {
+	const uint32_t guid = player->getGUID();
+	ItemBlockList itemList;
+	for (uint8_t table = PLAYER_ITEMS_FIRST; table <= PLAYER_ITEMS_LAST; ++table) {
+		const auto itemTable = static_cast<PlayerItemTable>(table);
+		if (!IOLoginData::hasItemTable(player, itemTable)) {
+			continue;
+		}
+
+		itemStream.clear();
+		IOLoginData::collectItems(player, itemTable, itemList);
+		itemStream.write<uint8_t>(table);
+		const bool success = IOLoginData::forEachItemRow(itemList, attributeStream, [this](int32_t pid, int32_t sid, const Item* item, std::string_view attributes) {
+			if (attributes.size() > std::numeric_limits<uint16_t>::max()) {
+				return false;
+			}
+
+			itemStream.write<uint8_t>(1);
+			itemStream.write<int32_t>(pid);
+			itemStream.write<int32_t>(sid);
+			itemStream.write<uint16_t>(item->getID());
+			itemStream.write<uint16_t>(item->getSubType());
+			itemStream.writeString(attributes);
+			return true;
+		});
+		itemStream.write<uint8_t>(0);
+		if (!success) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+
+		// only the sections that changed since they were last journaled; the
+		// depot of a player moving things around the backpack stays out of it
+		const std::string_view section = itemStream.getStream();
+		const uint64_t hash = getSectionHash(section);
+		auto it = itemHashes.find(getSectionKey(guid, table));
+		if (it != itemHashes.end() && it->second == hash) {
+			continue;
+		}
+
+		if (append(JournalRecord::ITEMS, guid, section)) {
+			itemHashes[getSectionKey(guid, table)] = hash;
+		}
+	}
+}
+
+void PlayerJournal::threadMain() {
+	const auto interval = std::chrono::milliseconds(std::max<int64_t>(getNumber(ConfigManager::PLAYER_JOURNAL_SYNC_INTERVAL), 10));
+
+	std::unique_lock<std::mutex> syncLockUnique(syncLock);
+	while (getState() == THREAD_STATE_RUNNING) {
+		syncSignal.wait_for(syncLockUnique, interval);
+		if (getState() != THREAD_STATE_RUNNING) {
+			break;
+		}
+
+		// snapshots land in the mapping now and reach the disk with the next sync
+		g_dispatcher.addTask([this]() { writeItemSnapshots(); });
+		sync();
+	}
+}
+
+void PlayerJournal::sync() {
+	// seqlock read of the epoch and the offset, see startEpoch
+	uint64_t currentEpoch;
+	size_t end;
+	uint32_t sequence;
+	do {
+		sequence = positionSequence.load(std::memory_order_acquire);
+		currentEpoch = epoch.load(std::memory_order_relaxed);
+		end = writeOffset.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+	} while ((sequence & 1) != 0 || sequence != positionSequence.load(std::memory_order_relaxed));
+
+	size_t first = syncedOffset;
+	if (currentEpoch != syncedEpoch) {
+		first = 0;
+	}
+
+	if (end <= first) {
+		return;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	if (!region->flush(first, end - first, false)) {
+		// retried from the same offset with the next sync
+		Logger::instance().warn("[PlayerJournal] Unable to sync the journal to disk.");
+		return;
+	}
+
+	syncedEpoch = currentEpoch;
+	syncedOffset = end;
+	const uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+	syncs.fetch_add(1, std::memory_order_relaxed);
+	totalSyncMicros.fetch_add(micros, std::memory_order_relaxed);
+	if (micros > maxSyncMicros.load(std::memory_order_relaxed)) {
+		maxSyncMicros.store(micros, std::memory_order_relaxed);
+	}
+}
+
+PlayerJournalStats PlayerJournal::getStats() const {
+	PlayerJournalStats stats;
+	stats.records = records.load(std::memory_order_relaxed);
+	stats.dropped = dropped.load(std::memory_order_relaxed);
+	stats.used = writeOffset.load(std::memory_order_relaxed);
+	stats.capacity = capacity;
+	stats.epoch = epoch.load(std::memory_order_relaxed);
+	stats.syncs = syncs.load(std::memory_order_relaxed);
+	stats.totalSyncMicros = totalSyncMicros.load(std::memory_order_relaxed);
+	stats.maxSyncMicros = maxSyncMicros.load(std::memory_order_relaxed);
+	stats.replayedRecords = replayedRecords;
+	stats.replayedPlayers = replayedPlayers;
+	return stats;
+}
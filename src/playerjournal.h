@@ -0,0 +1,133 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_PLAYERJOURNAL_H
+#define FS_PLAYERJOURNAL_H
+
+#include "fileloader.h"
+#include "thread_holder_base.h"
+
+namespace boost::interprocess {
+class file_mapping;
+class mapped_region;
+}
+
+class Player;
+
+enum class JournalRecord : uint8_t {
+	NONE,
+	LEVEL, // experience, level and the stats that follow it
+	BALANCE,
+	STORAGE_SET,
+	STORAGE_ERASE,
+	ITEMS, // one item table of the player, replaces what the database holds of it
+	SAVED, // the player was saved; earlier records of the player are obsolete
+};
+
+struct PlayerJournalStats {
+	uint64_t records = 0;
+	uint64_t dropped = 0;
+	uint64_t used = 0;
+	uint64_t capacity = 0;
+	uint64_t epoch = 0;
+	uint64_t syncs = 0;
+	uint64_t totalSyncMicros = 0;
+	uint64_t maxSyncMicros = 0;
+	uint64_t replayedRecords = 0;
+	uint64_t replayedPlayers = 0;
+};
+
+/**
+ * Write-ahead journal of what changed on players since they were last saved,
+ * so a crash does not roll them back to the previous server save.
+ *
+ * Records are appended by the dispatcher straight into a memory-mapped file and
+ * synced to disk by the journal thread every playerJournalSyncInterval. Each
+ * record carries a checksum seeded with the journal epoch; truncating after a
+ * server save only bumps the epoch, which invalidates everything written before.
+ * A journal that runs full is compacted to the latest state of each player, or
+ * failing that, those players are saved and a new epoch started. After an unclean shutdown the records still valid are replayed into the
+ * database before the world loads.
+ */
+class PlayerJournal : public ThreadHolder<PlayerJournal> {
+	public:
+		PlayerJournal();
+		~PlayerJournal();
+
+		// non-copyable
+		PlayerJournal(const PlayerJournal&) = delete;
+		PlayerJournal& operator=(const PlayerJournal&) = delete;
+
+		// Maps playerJournalFile and replays what it holds; call once the database is up.
+		bool open();
+		void shutdown();
+
+		bool isOpen() const {
+			return region != nullptr;
+		}
+
+		// dispatcher thread
+		void logLevel(const Player* player);
+		void logBalance(const Player* player);
+		void logStorage(const Player* player, uint32_t key, std::optional<int32_t> value);
+		void logSaved(uint32_t guid);
+		// items are snapshotted once per sync interval, not on every move
+		void markItemsDirty(uint32_t guid);
+
+		// Drops every record once a server save has written all players.
+		void truncate();
+
+		PlayerJournalStats getStats() const;
+
+		void threadMain();
+
+	private:
+		bool map(const std::string& path);
+		bool replay();
+		void writeItemSnapshots();
+		// writes the player's pending item snapshot ahead of any other record
+		void flushItems(const Player* player);
+		void writeItemSnapshot(const Player* player);
+		bool append(JournalRecord type, uint32_t guid, std::string_view payload);
+		void startEpoch(uint64_t newEpoch, size_t offset);
+		bool compact(size_t needed);
+		bool checkpoint();
+		void sync();
+
+		std::unique_ptr<boost::interprocess::file_mapping> file;
+		std::unique_ptr<boost::interprocess::mapped_region> region;
+		char* data = nullptr;
+		size_t capacity = 0;
+
+		// written by the dispatcher, read by the journal thread
+		std::atomic<size_t> writeOffset{0};
+		std::atomic<uint64_t> epoch{0};
+		// odd while startEpoch moves both of the above
+		std::atomic<uint32_t> positionSequence{0};
+		size_t syncedOffset = 0;
+		uint64_t syncedEpoch = 0;
+		bool full = false;
+
+		// players with records not yet covered by a save
+		std::unordered_set<uint32_t> unsaved;
+		std::unordered_set<uint32_t> dirtyItems;
+		// (guid << 8 | item table) -> hash of the section as last journaled
+		std::unordered_map<uint64_t, uint64_t> itemHashes;
+		PropWriteStream itemStream;
+		PropWriteStream attributeStream;
+
+		std::mutex syncLock;
+		std::condition_variable syncSignal;
+
+		std::atomic<uint64_t> records{0};
+		std::atomic<uint64_t> dropped{0};
+		std::atomic<uint64_t> syncs{0};
+		std::atomic<uint64_t> totalSyncMicros{0};
+		std::atomic<uint64_t> maxSyncMicros{0};
+		uint64_t replayedRecords = 0;
+		uint64_t replayedPlayers = 0;
+};
+
+extern PlayerJournal g_playerJournal;
+
+#endif // FS_PLAYERJOURNAL_H
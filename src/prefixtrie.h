@@ -0,0 +1,111 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_PREFIXTRIE_H
+#define FS_PREFIXTRIE_H
+
+// Case-folded prefix index over words owned elsewhere (map keys of spells and
+// talkactions). Keys are referenced, not copied, so the owning container must
+// keep them alive and the trie must be rebuilt whenever entries are erased.
+template <typename T>
+class PrefixTrie {
+	public:
+		using Entry = std::pair<std::string_view, T*>;
+
+		PrefixTrie() {
+			clear();
+		}
+
+		void clear() {
+			nodes.clear();
+			nodes.emplace_back();
+		}
+
+		void insert(std::string_view key, T* value) {
+			uint32_t index = 0;
+			for (char ch : key) {
+				index = addChild(index, fold(ch));
+			}
+
+			// keep entries of a node in the order the owning std::map iterates them
+			auto& values = nodes[index].values;
+			Entry entry{key, value};
+			values.insert(std::upper_bound(values.begin(), values.end(), entry, [](const Entry& lhs, const Entry& rhs) {
+				return lhs.first < rhs.first;
+			}), entry);
+		}
+
+		// Calls visit(entry) for every key that is a case-insensitive prefix of text, shortest key first.
+		template <typename Visitor>
+		void forEachPrefix(std::string_view text, Visitor&& visit) const {
+			findPrefix(text, [&visit](const Entry& entry) {
+				visit(entry);
+				return false;
+			});
+		}
+
+		// Same order as forEachPrefix, stopping at the first entry for which match(entry) returns true.
+		template <typename Predicate>
+		bool findPrefix(std::string_view text, Predicate&& match) const {
+			uint32_t index = 0;
+			for (size_t pos = 0; ; ++pos) {
+				for (const Entry& entry : nodes[index].values) {
+					if (match(entry)) {
+						return true;
+					}
+				}
+
+				if (pos == text.size() || !findChild(index, fold(text[pos]), index)) {
+					return false;
+				}
+			}
+		}
+
+		// Longest key that is a case-insensitive prefix of text; among equal keys the first in map order.
+		T* findLongest(std::string_view text) const {
+			T* result = nullptr;
+			forEachPrefix(text, [&result, length = size_t(0)](const Entry& entry) mutable {
+				if (!result || entry.first.size() > length) {
+					result = entry.second;
+					length = entry.first.size();
+				}
+			});
+			return result;
+		}
+
+	private:
+		struct Node {
+			std::vector<std::pair<char, uint32_t>> children;
+			std::vector<Entry> values;
+		};
+
+		static char fold(char ch) {
+			return static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+		}
+
+		bool findChild(uint32_t index, char ch, uint32_t& child) const {
+			for (const auto& it : nodes[index].children) {
+				if (it.first == ch) {
+					child = it.second;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		uint32_t addChild(uint32_t index, char ch) {
+			uint32_t child;
+			if (findChild(index, ch, child)) {
+				return child;
+			}
+
+			child = static_cast<uint32_t>(nodes.size());
+			nodes.emplace_back();
+			nodes[index].children.emplace_back(ch, child);
+			return child;
+		}
+
+		std::vector<Node> nodes;
+};
+
+#endif // FS_PREFIXTRIE_H
@@ -22,6 +22,8 @@ class Protocol : public std::enable_shared_from_this<Protocol> {
 		void onRecvMessage(NetworkMessage& msg);
 		virtual void onRecvFirstMessage(NetworkMessage& msg) = 0;
 		virtual void onConnect() {}
+		// dispatcher thread, right before the autosend sends the current buffer
+		virtual void onAutoSend() {}
 
 		bool isConnectionExpired() const {
 			return connection.expired();
@@ -8,6 +8,7 @@
 #include "ban.h"
 #include "condition.h"
 #include "configmanager.h"
+#include "databasetasks.h"
 #include "depotchest.h"
 #include "game/game.h"
 #include "inbox.h"
@@ -27,8 +28,34 @@
 extern CreatureEvents* g_creatureEvents;
 extern Chat* g_chat;
 
+// Everything a login reads from the database, fetched on a database worker.
+struct PlayerLoginData {
+	std::chrono::steady_clock::time_point requestedAt;
+	std::chrono::steady_clock::duration dispatcherTime{};
+	DBStatementResult_ptr preload;
+	bool namelocked = false;
+	std::optional<IOBan::BanInfo> banInfo;
+	PlayerLoadData player;
+	bool loaded = false;
+};
+
 namespace {
 
+	// dispatcher thread only
+	constexpr size_t LOGIN_LATENCY_SAMPLES = 1024;
+	std::array<uint32_t, LOGIN_LATENCY_SAMPLES> loginLatencies;
+	LoginStats loginStats;
+	ClientUpdateStats clientUpdateStats;
+
+	void recordLogin(std::chrono::steady_clock::time_point requestedAt, std::chrono::steady_clock::duration dispatcherTime) {
+		const auto now = std::chrono::steady_clock::now();
+		const uint64_t dispatcherMicros = std::chrono::duration_cast<std::chrono::microseconds>(dispatcherTime).count();
+		loginLatencies[loginStats.logins % LOGIN_LATENCY_SAMPLES] = std::chrono::duration_cast<std::chrono::milliseconds>(now - requestedAt).count();
+		++loginStats.logins;
+		loginStats.totalDispatcherMicros += dispatcherMicros;
+		loginStats.maxDispatcherMicros = std::max(loginStats.maxDispatcherMicros, dispatcherMicros);
+	}
+
 	std::deque<std::pair<int64_t, uint32_t>> waitList; // (timeout, player guid)
 	auto priorityEnd = waitList.end();
 
@@ -131,96 +158,196 @@ void ProtocolGame::login(const std::string& name, uint32_t accountId, OperatingS
 		player->incrementReferenceCounter();
 		player->setID();
 
-		if (!IOLoginData::preloadPlayer(player, name)) {
-			disconnectClient("Your character could not be loaded.");
-			return;
-		}
+		// the queries run on a database worker; only the checks and placing the player are left for the dispatcher.
+		// The cheap lookups come first, so a login that is turned away never loads the whole character.
+		auto data = std::make_shared<PlayerLoginData>();
+		data->requestedAt = std::chrono::steady_clock::now();
+		auto job = [=, thisPtr = getThis()](Database& db) {
+			if ((data->preload = IOLoginData::loadPreloadData(db, name))) {
+				const uint32_t guid = data->preload->getNumber<uint32_t>(0);
+				data->namelocked = IOBan::isPlayerNamelocked(guid, db);
+				data->banInfo = IOBan::getAccountBanInfo(accountId, db);
+			}
 
-		if (IOBan::isPlayerNamelocked(player->getGUID())) {
-			disconnectClient("Your character has been namelocked.");
-			return;
-		}
+			g_dispatcher.addTask([=]() {
+				thisPtr->onLoginPreloaded(name, operatingSystem, data);
+			});
+		};
 
-		if (g_game.getGameState() == GAME_STATE_CLOSING && !player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
-			disconnectClient("The game is just going down.\nPlease try again later.");
-			return;
+		if (!g_databaseTasks.addJob(job, DatabaseTasks::makeOrderKey(DatabaseOrder::ACCOUNT, accountId))) {
+			job(Database::getInstance());
 		}
+		return;
+	}
 
-		if (g_game.getGameState() == GAME_STATE_CLOSED && !player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
-			disconnectClient("Server is currently closed.\nPlease try again later.");
-			return;
-		}
+	if (eventConnect != 0 || !getBoolean(ConfigManager::REPLACE_KICK_ON_LOGIN)) {
+		//Already trying to connect
+		disconnectClient("You are already logged in.");
+		return;
+	}
 
-		if (getBoolean(ConfigManager::ONE_PLAYER_ON_ACCOUNT) && player->getAccountType() < ACCOUNT_TYPE_GAMEMASTER && g_game.getPlayerByAccount(player->getAccount())) {
-			disconnectClient("You may only login with one character\nof your account at the same time.");
-			return;
-		}
+	if (foundPlayer->client) {
+		foundPlayer->disconnect();
+		foundPlayer->isConnecting = true;
 
-		if (!player->hasFlag(PlayerFlag_CannotBeBanned)) {
-			if (const auto& banInfo = IOBan::getAccountBanInfo(accountId)) {
-				if (banInfo->expiresAt > 0) {
-					disconnectClient(fmt::format("Your account has been banned until {:s} by {:s}.\n\nReason specified:\n{:s}", formatDateShort(banInfo->expiresAt), banInfo->bannedBy, banInfo->reason));
-				} else {
-					disconnectClient(fmt::format("Your account has been permanently banned by {:s}.\n\nReason specified:\n{:s}", banInfo->bannedBy, banInfo->reason));
-				}
-				return;
-			}
-		}
+		eventConnect = g_scheduler.addEvent(createSchedulerTask(1000, [=, thisPtr = getThis(), playerID = foundPlayer->getID()]() {
+			thisPtr->connect(playerID, operatingSystem);
+		}));
+	} else {
+		connect(foundPlayer->getID(), operatingSystem);
+	}
 
-		if (std::size_t currentSlot = clientLogin(*player)) {
-			uint8_t retryTime = getWaitTime(currentSlot);
-			auto output = net::make_output_message();
-			output->addByte(0x16);
-			output->addString(fmt::format("Too many players online.\nYou are at place {:d} on the waiting list.", currentSlot));
-			output->addByte(retryTime);
-			send(output);
-			disconnect();
-			return;
-		}
+	net::insert_protocol_to_autosend(shared_from_this());
+}
 
-		if (!IOLoginData::loadPlayerById(player, player->getGUID())) {
-			disconnectClient("Your character could not be loaded.");
-			return;
-		}
+void ProtocolGame::onLoginPreloaded(const std::string& name, OperatingSystem_t operatingSystem, const std::shared_ptr<PlayerLoginData>& data) {
+	//dispatcher thread
+	if (!player || isConnectionExpired()) {
+		// the client went away while the character was loading
+		return;
+	}
 
-		player->setOperatingSystem(operatingSystem);
+	const auto start = std::chrono::steady_clock::now();
 
-		if (!g_game.placeCreature(player, player->getLoginPosition())) {
-			if (!g_game.placeCreature(player, player->getTemplePosition(), false, true)) {
-				disconnectClient("Temple position is wrong. Contact the administrator.");
-				return;
-			}
-		}
+	// another login of the same character may have completed while this one was loading
+	if (!getBoolean(ConfigManager::ALLOW_CLONES) && g_game.getPlayerByName(name)) {
+		disconnectClient("You are already logged in.");
+		return;
+	}
 
-		if (operatingSystem >= CLIENTOS_OTCLIENT_LINUX) {
-			player->registerCreatureEvent("ExtendedOpcode");
-		}
+	if (!IOLoginData::preloadPlayer(player, data->preload)) {
+		disconnectClient("Your character could not be loaded.");
+		return;
+	}
 
-		player->lastIP = player->getIP();
-		player->lastLoginSaved = std::max<time_t>(time(nullptr), player->lastLoginSaved + 1);
-		acceptPackets = true;
-	} else {
-		if (eventConnect != 0 || !getBoolean(ConfigManager::REPLACE_KICK_ON_LOGIN)) {
-			//Already trying to connect
-			disconnectClient("You are already logged in.");
+	if (data->namelocked) {
+		disconnectClient("Your character has been namelocked.");
+		return;
+	}
+
+	if (!canPlacePlayer()) {
+		return;
+	}
+
+	if (!player->hasFlag(PlayerFlag_CannotBeBanned)) {
+		if (const auto& banInfo = data->banInfo) {
+			if (banInfo->expiresAt > 0) {
+				disconnectClient(fmt::format("Your account has been banned until {:s} by {:s}.\n\nReason specified:\n{:s}", formatDateShort(banInfo->expiresAt), banInfo->bannedBy, banInfo->reason));
+			} else {
+				disconnectClient(fmt::format("Your account has been permanently banned by {:s}.\n\nReason specified:\n{:s}", banInfo->bannedBy, banInfo->reason));
+			}
 			return;
 		}
+	}
+
+	if (std::size_t currentSlot = clientLogin(*player)) {
+		uint8_t retryTime = getWaitTime(currentSlot);
+		auto output = net::make_output_message();
+		output->addByte(0x16);
+		output->addString(fmt::format("Too many players online.\nYou are at place {:d} on the waiting list.", currentSlot));
+		output->addByte(retryTime);
+		send(output);
+		disconnect();
+		return;
+	}
 
-		if (foundPlayer->client) {
-			foundPlayer->disconnect();
-			foundPlayer->isConnecting = true;
+	data->dispatcherTime += std::chrono::steady_clock::now() - start;
 
-			eventConnect = g_scheduler.addEvent(createSchedulerTask(1000, [=, thisPtr = getThis(), playerID = foundPlayer->getID()]() {
-				thisPtr->connect(playerID, operatingSystem);
-			}));
-		} else {
-			connect(foundPlayer->getID(), operatingSystem);
+	auto job = [=, thisPtr = getThis(), guid = player->getGUID()](Database& db) {
+		data->loaded = IOLoginData::loadPlayerById(db, guid, data->player);
+
+		g_dispatcher.addTask([=]() {
+			thisPtr->onLoginDataLoaded(name, operatingSystem, data);
+		});
+	};
+
+	if (!g_databaseTasks.addJob(job, DatabaseTasks::makeOrderKey(DatabaseOrder::ACCOUNT, player->getAccount()))) {
+		job(Database::getInstance());
+	}
+}
+
+void ProtocolGame::onLoginDataLoaded(const std::string& name, OperatingSystem_t operatingSystem, const std::shared_ptr<PlayerLoginData>& data) {
+	//dispatcher thread
+	if (!player || isConnectionExpired()) {
+		return;
+	}
+
+	// the state may have changed while the character was loading; the waiting list was settled before
+	const auto start = std::chrono::steady_clock::now();
+	if (!getBoolean(ConfigManager::ALLOW_CLONES) && g_game.getPlayerByName(name)) {
+		disconnectClient("You are already logged in.");
+		return;
+	}
+
+	if (!canPlacePlayer()) {
+		return;
+	}
+
+	if (!data->loaded || !IOLoginData::loadPlayer(player, data->player)) {
+		disconnectClient("Your character could not be loaded.");
+		return;
+	}
+
+	player->setOperatingSystem(operatingSystem);
+
+	if (!g_game.placeCreature(player, player->getLoginPosition())) {
+		if (!g_game.placeCreature(player, player->getTemplePosition(), false, true)) {
+			disconnectClient("Temple position is wrong. Contact the administrator.");
+			return;
 		}
 	}
 
+	if (operatingSystem >= CLIENTOS_OTCLIENT_LINUX) {
+		player->registerCreatureEvent("ExtendedOpcode");
+	}
+
+	player->lastIP = player->getIP();
+	player->lastLoginSaved = std::max<time_t>(time(nullptr), player->lastLoginSaved + 1);
+	acceptPackets = true;
+
+	data->dispatcherTime += std::chrono::steady_clock::now() - start;
+	recordLogin(data->requestedAt, data->dispatcherTime);
 	net::insert_protocol_to_autosend(shared_from_this());
 }
 
+bool ProtocolGame::canPlacePlayer() const {
+	if (g_game.getGameState() == GAME_STATE_CLOSING && !player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
+		disconnectClient("The game is just going down.\nPlease try again later.");
+		return false;
+	}
+
+	if (g_game.getGameState() == GAME_STATE_CLOSED && !player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
+		disconnectClient("Server is currently closed.\nPlease try again later.");
+		return false;
+	}
+
+	if (getBoolean(ConfigManager::ONE_PLAYER_ON_ACCOUNT) && player->getAccountType() < ACCOUNT_TYPE_GAMEMASTER && g_game.getPlayerByAccount(player->getAccount())) {
+		disconnectClient("You may only login with one character\nof your account at the same time.");
+		return false;
+	}
+	return true;
+}
+
+ClientUpdateStats ProtocolGame::getClientUpdateStats() {
+	return clientUpdateStats;
+}
+
+LoginStats ProtocolGame::getLoginStats() {
+	LoginStats stats = loginStats;
+	const size_t samples = std::min<uint64_t>(stats.logins, LOGIN_LATENCY_SAMPLES);
+	if (samples == 0) {
+		return stats;
+	}
+
+	std::vector<uint32_t> sorted(loginLatencies.begin(), loginLatencies.begin() + samples);
+	std::sort(sorted.begin(), sorted.end());
+	stats.p50Millis = sorted[(samples - 1) * 50 / 100];
+	stats.p95Millis = sorted[(samples - 1) * 95 / 100];
+	stats.p99Millis = sorted[(samples - 1) * 99 / 100];
+	stats.maxMillis = sorted.back();
+	return stats;
+}
+
 void ProtocolGame::connect(uint32_t playerId, OperatingSystem_t operatingSystem) {
 	// dispatcher thread
 
@@ -442,6 +569,53 @@ void ProtocolGame::writeToOutputBuffer(const NetworkMessage& msg) {
 	out->append(msg);
 }
 
+void ProtocolGame::onAutoSend() {
+	if (pendingUpdates != 0 || !pendingHealth.empty()) {
+		flushPendingUpdates();
+	}
+}
+
+void ProtocolGame::flushPendingUpdates() {
+	if (!player) {
+		pendingUpdates = 0;
+		pendingHealth.clear();
+		return;
+	}
+
+	NetworkMessage msg;
+	if (pendingUpdates & PENDING_STATS) {
+		AddPlayerStats(msg);
+		++clientUpdateStats.statsSent;
+	}
+
+	if (pendingUpdates & PENDING_SKILLS) {
+		AddPlayerSkills(msg);
+		++clientUpdateStats.skillsSent;
+	}
+
+	if (pendingUpdates & PENDING_ICONS) {
+		msg.addByte(0xA2);
+		msg.add<uint16_t>(pendingIcons);
+		++clientUpdateStats.iconsSent;
+	}
+	pendingUpdates = 0;
+
+	// creatures that died or walked out of view in the meantime are skipped,
+	// the client gets their health with the creature when it shows up again
+	for (uint32_t creatureId : pendingHealth) {
+		const Creature* creature = g_game.getCreatureByID(creatureId);
+		if (creature && canSee(creature)) {
+			AddCreatureHealth(msg, creature);
+			++clientUpdateStats.healthSent;
+		}
+	}
+	pendingHealth.clear();
+
+	if (msg.getLength() != 0) {
+		writeToOutputBuffer(msg);
+	}
+}
+
 void ProtocolGame::parsePacket(NetworkMessage& msg) {
 	if (!acceptPackets || g_game.getGameState() == GAME_STATE_SHUTDOWN || msg.isEmpty()) {
 		return;
@@ -1395,6 +1569,9 @@ void ProtocolGame::sendAddMarker(const Position& pos, uint8_t markType, const st
 }
 
 void ProtocolGame::sendReLoginWindow(uint8_t unfairFightReduction) {
+	// the death window goes after the final stats
+	flushPendingUpdates();
+
 	NetworkMessage msg;
 	msg.addByte(0x28);
 	msg.addByte(0x00);
@@ -1403,9 +1580,8 @@ void ProtocolGame::sendReLoginWindow(uint8_t unfairFightReduction) {
 }
 
 void ProtocolGame::sendStats() {
-	NetworkMessage msg;
-	AddPlayerStats(msg);
-	writeToOutputBuffer(msg);
+	++clientUpdateStats.statsQueued;
+	pendingUpdates |= PENDING_STATS;
 }
 
 void ProtocolGame::sendBasicData() {
@@ -1535,10 +1711,9 @@ void ProtocolGame::sendChannelMessage(const std::string& author, const std::stri
 }
 
 void ProtocolGame::sendIcons(uint16_t icons) {
-	NetworkMessage msg;
-	msg.addByte(0xA2);
-	msg.add<uint16_t>(icons);
-	writeToOutputBuffer(msg);
+	++clientUpdateStats.iconsQueued;
+	pendingUpdates |= PENDING_ICONS;
+	pendingIcons = icons;
 }
 
 void ProtocolGame::sendContainer(uint8_t cid, const Container* container, uint16_t firstIndex) {
@@ -2280,9 +2455,8 @@ void ProtocolGame::sendCancelWalk() {
 }
 
 void ProtocolGame::sendSkills() {
-	NetworkMessage msg;
-	AddPlayerSkills(msg);
-	writeToOutputBuffer(msg);
+	++clientUpdateStats.skillsQueued;
+	pendingUpdates |= PENDING_SKILLS;
 }
 
 void ProtocolGame::sendPing() {
@@ -2319,16 +2493,10 @@ void ProtocolGame::sendMagicEffect(const Position& pos, uint8_t type) {
 }
 
 void ProtocolGame::sendCreatureHealth(const Creature* creature) {
-	NetworkMessage msg;
-	msg.addByte(0x8C);
-	msg.add<uint32_t>(creature->getID());
-
-	if (creature->isHealthHidden()) {
-		msg.addByte(0x00);
-	} else {
-		msg.addByte(std::ceil((static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100));
+	++clientUpdateStats.healthQueued;
+	if (std::find(pendingHealth.begin(), pendingHealth.end(), creature->getID()) == pendingHealth.end()) {
+		pendingHealth.push_back(creature->getID());
 	}
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendFYIBox(const std::string& message) {
@@ -3041,6 +3209,17 @@ void ProtocolGame::AddPlayerSkills(NetworkMessage& msg) {
 	}
 }
 
+void ProtocolGame::AddCreatureHealth(NetworkMessage& msg, const Creature* creature) {
+	msg.addByte(0x8C);
+	msg.add<uint32_t>(creature->getID());
+
+	if (creature->isHealthHidden()) {
+		msg.addByte(0x00);
+	} else {
+		msg.addByte(std::ceil((static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100));
+	}
+}
+
 void ProtocolGame::AddOutfit(NetworkMessage& msg, const Outfit_t& outfit) {
 	msg.add<uint16_t>(outfit.lookType);
 
@@ -14,6 +14,7 @@ class Game;
 class NetworkMessage;
 class Player;
 class ProtocolGame;
+struct PlayerLoginData;
 class Quest;
 class Tile;
 class TrackedQuest;
@@ -36,6 +37,31 @@ struct TextMessage {
 	TextMessage(MessageClasses type, std::string text) : type(type), text(std::move(text)) {}
 };
 
+struct LoginStats {
+	uint64_t logins = 0;
+	// request to placement, over the most recent logins
+	uint32_t p50Millis = 0;
+	uint32_t p95Millis = 0;
+	uint32_t p99Millis = 0;
+	uint32_t maxMillis = 0;
+	// time spent on the dispatcher finishing a login
+	uint64_t totalDispatcherMicros = 0;
+	uint64_t maxDispatcherMicros = 0;
+};
+
+// stats, skills, icons and health bars asked for and actually sent; the
+// difference was folded into a later update in the same autosend cycle
+struct ClientUpdateStats {
+	uint64_t statsQueued = 0;
+	uint64_t statsSent = 0;
+	uint64_t skillsQueued = 0;
+	uint64_t skillsSent = 0;
+	uint64_t iconsQueued = 0;
+	uint64_t iconsSent = 0;
+	uint64_t healthQueued = 0;
+	uint64_t healthSent = 0;
+};
+
 class ProtocolGame final : public Protocol {
 	public:
 		// static protocol information
@@ -51,6 +77,9 @@ class ProtocolGame final : public Protocol {
 		void login(const std::string& name, uint32_t accountId, OperatingSystem_t operatingSystem);
 		void logout(bool displayEffect, bool forced);
 
+		static LoginStats getLoginStats();
+		static ClientUpdateStats getClientUpdateStats();
+
 		uint16_t getVersion() const {
 			return version;
 		}
@@ -60,6 +89,11 @@ class ProtocolGame final : public Protocol {
 			return std::static_pointer_cast<ProtocolGame>(shared_from_this());
 		}
 		void connect(uint32_t playerId, OperatingSystem_t operatingSystem);
+		// login runs in two database rounds: the preload, namelock and ban lookups, then the full character
+		void onLoginPreloaded(const std::string& name, OperatingSystem_t operatingSystem, const std::shared_ptr<PlayerLoginData>& data);
+		void onLoginDataLoaded(const std::string& name, OperatingSystem_t operatingSystem, const std::shared_ptr<PlayerLoginData>& data);
+		// game state and one-character-per-account checks; disconnects and returns false on failure
+		bool canPlacePlayer() const;
 		void disconnectClient(const std::string& message) const;
 		void writeToOutputBuffer(const NetworkMessage& msg);
 
@@ -75,6 +109,8 @@ class ProtocolGame final : public Protocol {
 		void parsePacket(NetworkMessage& msg) override;
 		void onRecvFirstMessage(NetworkMessage& msg) override;
 		void onConnect() override;
+		void onAutoSend() override;
+		void flushPendingUpdates();
 
 		//Parse methods
 		void parseAutoWalk(NetworkMessage& msg);
@@ -277,6 +313,7 @@ class ProtocolGame final : public Protocol {
 		void AddPlayerStats(NetworkMessage& msg);
 		void AddOutfit(NetworkMessage& msg, const Outfit_t& outfit);
 		void AddPlayerSkills(NetworkMessage& msg);
+		static void AddCreatureHealth(NetworkMessage& msg, const Creature* creature);
 		void AddWorldLight(NetworkMessage& msg, LightInfo lightInfo);
 		void AddCreatureLight(NetworkMessage& msg, const Creature* creature);
 
@@ -298,6 +335,17 @@ class ProtocolGame final : public Protocol {
 		std::unordered_set<uint32_t> knownCreatureSet;
 		Player* player = nullptr;
 
+		// stats, skills, icons and health bars only describe current state, so
+		// they are written once per autosend cycle instead of on every change
+		enum PendingUpdate : uint8_t {
+			PENDING_STATS = 1 << 0,
+			PENDING_SKILLS = 1 << 1,
+			PENDING_ICONS = 1 << 2,
+		};
+		uint8_t pendingUpdates = 0;
+		uint16_t pendingIcons = 0;
+		std::vector<uint32_t> pendingHealth; // creature ids
+
 		uint32_t eventConnect = 0;
 		uint32_t challengeTimestamp = 0;
 		uint16_t version = CLIENT_VERSION_MIN;
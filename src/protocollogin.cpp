@@ -14,38 +14,6 @@
 
 extern Game g_game;
 
-namespace {
-
-	std::string decodeSecret(std::string_view secret) {
-		// simple base32 decoding
-		std::string key;
-		key.reserve(10);
-
-		uint32_t buffer = 0, left = 0;
-		for (const auto& ch : secret) {
-			buffer <<= 5;
-			if (ch >= 'A' && ch <= 'Z') {
-				buffer |= (ch & 0x1F) - 1;
-			} else if (ch >= '2' && ch <= '7') {
-				buffer |= ch - 24;
-			} else {
-				// if a key is broken, return empty and the comparison will always be false since the token must not be
-				// empty
-				return {};
-			}
-
-			left += 5;
-			if (left >= 8) {
-				left -= 8;
-				key.push_back(static_cast<char>(buffer >> left));
-			}
-		}
-
-		return key;
-	}
-
-} // namespace
-
 void ProtocolLogin::disconnectClient(const std::string& message, uint16_t version) {
 	auto output = net::make_output_message();
 
@@ -57,30 +25,20 @@ void ProtocolLogin::disconnectClient(const std::string& message, uint16_t versio
 }
 
 void ProtocolLogin::getCharacterList(const std::string& accountName, const std::string& password, const std::string& token, uint16_t version) {
-	Database& db = Database::getInstance();
-
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id`, UNHEX(`password`) AS `password`, `secret`, `premium_ends_at` FROM `accounts` WHERE `name` = {:s}", db.escapeString(accountName)));
-	if (!result) {
+	auto account = IOLoginData::getLoginAccount(accountName);
+	if (!account) {
 		disconnectClient("Account name or password is not correct.", version);
 		return;
 	}
 
-	if (transformToSHA1(password) != result->getString("password")) {
+	if (transformToSHA1(password) != account->password) {
 		disconnectClient("Account name or password is not correct.", version);
 		return;
 	}
 
-	auto id = result->getNumber<uint32_t>("id");
-	auto key = decodeSecret(result->getString("secret"));
-	auto premiumEndsAt = result->getNumber<time_t>("premium_ends_at");
-
-	std::vector<std::string> characters = {};
-	result = db.storeQuery(fmt::format("SELECT `name` FROM `players` WHERE `account_id` = {:d} AND `deletion` = 0 ORDER BY `name` ASC", id));
-	if (result) {
-		do {
-			characters.emplace_back(result->getString("name"));
-		} while (result->next());
-	}
+	const std::string& key = account->secret;
+	const time_t premiumEndsAt = account->premiumEndsAt;
+	const std::vector<std::string>& characters = account->characters;
 
 	uint32_t ticks = time(nullptr) / AUTHENTICATOR_PERIOD;
 
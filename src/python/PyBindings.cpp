@@ -3,10 +3,203 @@
 #ifdef WITH_PYTHON
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
-#endif
+
+#include "python/PythonEngine.h"
+#include "python/WorldSnapshot.h"
+#include "utils/Logger.h"
+
+namespace {
+
+// Pins one published snapshot slot for as long as the object (or any memoryview
+// derived from it) is alive, and exports the slot bytes through the buffer protocol.
+struct PySnapshot {
+        PyObject_HEAD
+        const WorldSnapshotSlot* slot;
+};
+
+PyObject* snapshotType = nullptr;
+
+void snapshotDealloc(PyObject* self) {
+        auto snapshot = reinterpret_cast<PySnapshot*>(self);
+        WorldSnapshot::instance().release(snapshot->slot);
+        snapshot->slot = nullptr;
+
+        PyTypeObject* type = Py_TYPE(self);
+        type->tp_free(self);
+        Py_DECREF(type);
+}
+
+int snapshotGetBuffer(PyObject* self, Py_buffer* view, int flags) {
+        const WorldSnapshotSlot* slot = reinterpret_cast<PySnapshot*>(self)->slot;
+        void* data = const_cast<uint8_t*>(slot->data.data());
+        return PyBuffer_FillInfo(view, self, data, static_cast<Py_ssize_t>(slot->data.size()), 1, flags);
+}
+
+PyObject* snapshotColumns(PyObject* self, void*) {
+        const WorldSnapshotSlot* slot = reinterpret_cast<PySnapshot*>(self)->slot;
+
+        PyObject* whole = PyMemoryView_FromObject(self);
+        if (!whole) {
+                return nullptr;
+        }
+
+        PyObject* columns = PyDict_New();
+        if (!columns) {
+                Py_DECREF(whole);
+                return nullptr;
+        }
+
+        for (const WorldSnapshotColumn& column : slot->columns) {
+                const Py_ssize_t begin = column.offset;
+                const Py_ssize_t end = begin + static_cast<Py_ssize_t>(column.count) * column.itemSize;
+
+                PyObject* first = PyLong_FromSsize_t(begin);
+                PyObject* last = PyLong_FromSsize_t(end);
+                PyObject* range = first && last ? PySlice_New(first, last, nullptr) : nullptr;
+                PyObject* bytes = range ? PyObject_GetItem(whole, range) : nullptr;
+                PyObject* typed = bytes ? PyObject_CallMethod(bytes, "cast", "s", column.format) : nullptr;
+                Py_XDECREF(bytes);
+                Py_XDECREF(range);
+                Py_XDECREF(last);
+                Py_XDECREF(first);
+
+                if (!typed || PyDict_SetItemString(columns, column.name, typed) != 0) {
+                        Py_XDECREF(typed);
+                        Py_DECREF(columns);
+                        Py_DECREF(whole);
+                        return nullptr;
+                }
+                Py_DECREF(typed);
+        }
+
+        Py_DECREF(whole);
+        return columns;
+}
+
+PyObject* snapshotSequence(PyObject* self, void*) {
+        return PyLong_FromUnsignedLongLong(reinterpret_cast<PySnapshot*>(self)->slot->sequence);
+}
+
+PyObject* snapshotCapturedAt(PyObject* self, void*) {
+        return PyLong_FromLongLong(reinterpret_cast<PySnapshot*>(self)->slot->capturedAt);
+}
+
+PyObject* snapshotPlayers(PyObject* self, void*) {
+        return PyLong_FromUnsignedLong(reinterpret_cast<PySnapshot*>(self)->slot->players);
+}
+
+PyObject* snapshotMonsters(PyObject* self, void*) {
+        return PyLong_FromUnsignedLong(reinterpret_cast<PySnapshot*>(self)->slot->monsters);
+}
+
+PyGetSetDef snapshotGetSet[] = {
+        {"columns", snapshotColumns, nullptr, "dict of column name to typed memoryview", nullptr},
+        {"sequence", snapshotSequence, nullptr, "monotonic capture number", nullptr},
+        {"captured_at", snapshotCapturedAt, nullptr, "capture time in milliseconds (OTSYS_TIME)", nullptr},
+        {"players", snapshotPlayers, nullptr, "number of player rows", nullptr},
+        {"monsters", snapshotMonsters, nullptr, "number of monster rows", nullptr},
+        {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyType_Slot snapshotSlots[] = {
+        {Py_tp_dealloc, reinterpret_cast<void*>(snapshotDealloc)},
+        {Py_tp_getset, snapshotGetSet},
+        {Py_bf_getbuffer, reinterpret_cast<void*>(snapshotGetBuffer)},
+        {0, nullptr},
+};
+
+PyType_Spec snapshotSpec = {
+        "nexus.WorldSnapshot",
+        sizeof(PySnapshot),
+        0,
+        Py_TPFLAGS_DEFAULT,
+        snapshotSlots,
+};
+
+PyObject* pyWorldSnapshot(PyObject*, PyObject*) {
+        const WorldSnapshotSlot* slot = WorldSnapshot::instance().acquire();
+        if (!slot) {
+                Py_RETURN_NONE;
+        }
+
+        auto snapshot = PyObject_New(PySnapshot, reinterpret_cast<PyTypeObject*>(snapshotType));
+        if (!snapshot) {
+                WorldSnapshot::instance().release(slot);
+                return nullptr;
+        }
+        snapshot->slot = slot;
+        return reinterpret_cast<PyObject*>(snapshot);
+}
+
+PyObject* pySnapshotStats(PyObject*, PyObject*) {
+        const WorldSnapshotStats stats = WorldSnapshot::instance().getStats();
+        return Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:I,s:I}",
+                "captures", static_cast<unsigned long long>(stats.captures),
+                "skipped_busy", static_cast<unsigned long long>(stats.skippedBusy),
+                "last_us", static_cast<unsigned long long>(stats.lastCaptureMicros),
+                "max_us", static_cast<unsigned long long>(stats.maxCaptureMicros),
+                "total_us", static_cast<unsigned long long>(stats.totalCaptureMicros),
+                "interval_ms", stats.interval,
+                "bytes", stats.bytes);
+}
+
+PyObject* pyEventStats(PyObject*, PyObject*) {
+        const PythonEventStats stats = PythonEngine::instance().getEventStats();
+        return Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:I,s:I,s:I,s:K,s:K}",
+                "enqueued", static_cast<unsigned long long>(stats.enqueued),
+                "dropped", static_cast<unsigned long long>(stats.dropped),
+                "processed", static_cast<unsigned long long>(stats.processed),
+                "failed", static_cast<unsigned long long>(stats.failed),
+                "batches", static_cast<unsigned long long>(stats.batches),
+                "pending", stats.pending,
+                "high_water", stats.highWater,
+                "max_batch", stats.maxBatch,
+                "last_drain_us", static_cast<unsigned long long>(stats.lastDrainMicros),
+                "max_drain_us", static_cast<unsigned long long>(stats.maxDrainMicros));
+}
+
+PyMethodDef nexusMethods[] = {
+        {"world_snapshot", pyWorldSnapshot, METH_NOARGS, "Pin and return the latest world snapshot, or None."},
+        {"snapshot_stats", pySnapshotStats, METH_NOARGS, "Capture cost and skip counters of the world snapshot."},
+        {"event_stats", pyEventStats, METH_NOARGS, "Queue, drop and drain counters of the game event bus."},
+        {nullptr, nullptr, 0, nullptr},
+};
+
+PyModuleDef nexusModule = {
+        PyModuleDef_HEAD_INIT,
+        "nexus",
+        "Native bindings into the running server.",
+        -1,
+        nexusMethods,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+};
+
+} // namespace
 
 void RegisterPyBindings() {
-#ifdef WITH_PYTHON
-        // Placeholder for future native bindings.
-#endif
+        // The interpreter is already initialized here, so register through sys.modules rather than the inittab.
+        PyObject* module = PyModule_Create(&nexusModule);
+        if (!module) {
+                PyErr_Print();
+                Logger::instance().error("[Python] Failed to create 'nexus' module");
+                return;
+        }
+
+        snapshotType = PyType_FromSpec(&snapshotSpec);
+        if (!snapshotType || PyModule_AddObjectRef(module, "WorldSnapshot", snapshotType) != 0) {
+                PyErr_Print();
+                Logger::instance().error("[Python] Failed to register 'nexus.WorldSnapshot'");
+                Py_DECREF(module);
+                return;
+        }
+
+        if (PyDict_SetItemString(PyImport_GetModuleDict(), "nexus", module) != 0) {
+                PyErr_Print();
+                Logger::instance().error("[Python] Failed to register 'nexus' module");
+        }
+        Py_DECREF(module);
 }
+#endif
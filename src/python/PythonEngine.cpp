@@ -2,11 +2,14 @@
 
 #include "python/PythonEngine.h"
 
+#include "tools.h"
 #include "utils/Logger.h"
 
 #include <boost/algorithm/string.hpp>
 #include <fmt/format.h>
 
+#include <chrono>
+
 #ifdef WITH_PYTHON
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
@@ -48,6 +51,18 @@ wchar_t* toWide(void* value) {
 }
 #endif
 
+// Per-event handlers looked up once at import; `on_events` (if defined) receives
+// the whole drained batch as an iterator over (name, args) tuples in a single call.
+constexpr std::array<const char*, static_cast<size_t>(PythonEventType::Count)> eventHandlerNames = {
+        "on_server_start",
+        "on_server_stop",
+        "on_player_login",
+        "on_player_logout",
+        "on_creature_death",
+};
+
+constexpr const char* batchHandlerName = "on_events";
+
 } // namespace
 
 #ifdef WITH_PYTHON
@@ -145,6 +160,10 @@ bool PythonEngine::init(const std::string& home, const std::string& modulePath,
 
         mainThreadState_ = PyEval_SaveThread();
         ready_ = true;
+
+        eventThreadRunning_.store(true, std::memory_order_relaxed);
+        eventThread_ = std::thread(&PythonEngine::eventThreadMain, this);
+
         Logger::instance().info("[Python] Embedded runtime initialized");
         return true;
 #else
@@ -188,14 +207,68 @@ bool PythonEngine::importBootstrapLocked() {
 
         Py_XDECREF(toPyObject(bootstrapModule_));
         bootstrapModule_ = module;
+        cacheHandlersLocked();
         return true;
 #else
         return false;
 #endif
 }
 
+void PythonEngine::cacheHandlersLocked() {
+#ifdef WITH_PYTHON
+        releaseHandlersLocked();
+        if (!bootstrapModule_) {
+                return;
+        }
+
+        auto lookup = [this](const char* name) -> void* {
+                PyObject* module = toPyObject(bootstrapModule_);
+                if (!PyObject_HasAttrString(module, name)) {
+                        return nullptr;
+                }
+
+                PyObject* func = PyObject_GetAttrString(module, name);
+                if (!func) {
+                        PyErr_Clear();
+                        return nullptr;
+                }
+
+                if (!PyCallable_Check(func)) {
+                        Logger::instance().warn(fmt::format("[Python] Attribute '{}' is not callable; ignoring", name));
+                        Py_DECREF(func);
+                        return nullptr;
+                }
+                return func;
+        };
+
+        for (size_t i = 0; i < eventHandlers_.size(); ++i) {
+                eventHandlers_[i] = lookup(eventHandlerNames[i]);
+        }
+        batchHandler_ = lookup(batchHandlerName);
+#endif
+}
+
+void PythonEngine::releaseHandlersLocked() {
+#ifdef WITH_PYTHON
+        for (void*& handler : eventHandlers_) {
+                Py_XDECREF(toPyObject(handler));
+                handler = nullptr;
+        }
+        Py_XDECREF(toPyObject(batchHandler_));
+        batchHandler_ = nullptr;
+#endif
+}
+
 void PythonEngine::shutdown() {
 #ifdef WITH_PYTHON
+        // The event thread drains whatever is still queued before it exits.
+        if (eventThreadRunning_.exchange(false)) {
+                eventSignal_.notify_one();
+        }
+        if (eventThread_.joinable()) {
+                eventThread_.join();
+        }
+
         if (!Py_IsInitialized()) {
                 bootstrapModule_ = nullptr;
                 mainThreadState_ = nullptr;
@@ -209,6 +282,7 @@ void PythonEngine::shutdown() {
                 mainThreadState_ = nullptr;
         }
 
+        releaseHandlersLocked();
         Py_XDECREF(toPyObject(bootstrapModule_));
         bootstrapModule_ = nullptr;
 
@@ -238,6 +312,7 @@ bool PythonEngine::reload() {
                 } else {
                         Py_DECREF(toPyObject(bootstrapModule_));
                         bootstrapModule_ = reloaded;
+                        cacheHandlersLocked();
                         result = true;
                 }
         }
@@ -340,25 +415,207 @@ bool PythonEngine::call(const char* funcName, const std::vector<std::string>& ar
 }
 
 void PythonEngine::onServerStart() {
-        (void)call("on_server_start");
+        postEvent(PythonEventType::ServerStart, 0);
 }
 
 void PythonEngine::onServerStop() {
-        (void)call("on_server_stop");
+        postEvent(PythonEventType::ServerStop, 0);
 }
 
 void PythonEngine::onPlayerLogin(uint32_t guid, const std::string& name) {
-        (void)guid;
-        (void)call("on_player_login", {name});
+        postEvent(PythonEventType::PlayerLogin, guid, name);
 }
 
 void PythonEngine::onPlayerLogout(uint32_t guid, const std::string& name) {
-        (void)guid;
-        (void)call("on_player_logout", {name});
+        postEvent(PythonEventType::PlayerLogout, guid, name);
 }
 
 void PythonEngine::onCreatureDeath(const std::string& killer, const std::string& victim) {
-        (void)call("on_creature_death", {killer, victim});
+        postEvent(PythonEventType::CreatureDeath, 0, killer, victim);
+}
+
+PythonEventStats PythonEngine::getEventStats() const {
+        PythonEventStats stats;
+        stats.enqueued = eventsEnqueued_.load(std::memory_order_relaxed);
+        stats.dropped = eventsDropped_.load(std::memory_order_relaxed);
+        stats.processed = eventsProcessed_.load(std::memory_order_relaxed);
+        stats.failed = eventsFailed_.load(std::memory_order_relaxed);
+        stats.batches = eventBatches_.load(std::memory_order_relaxed);
+        stats.pending = eventsPending_.load(std::memory_order_relaxed);
+        stats.highWater = eventsHighWater_.load(std::memory_order_relaxed);
+        stats.maxBatch = eventMaxBatch_.load(std::memory_order_relaxed);
+        stats.lastDrainMicros = lastDrainMicros_.load(std::memory_order_relaxed);
+        stats.maxDrainMicros = maxDrainMicros_.load(std::memory_order_relaxed);
+        return stats;
+}
+
+void PythonEngine::postEvent(PythonEventType type, uint32_t guid, std::string first, std::string second) {
+        if (!eventThreadRunning_.load(std::memory_order_relaxed)) {
+                return;
+        }
+
+        // counted before the push: the event thread may pop and subtract it before
+        // bounded_push even returns, which would wrap the counter below zero
+        const uint32_t pending = eventsPending_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        auto event = new PythonEvent{type, guid, std::move(first), std::move(second)};
+        if (!eventQueue_.bounded_push(event)) {
+                delete event;
+                eventsPending_.fetch_sub(1, std::memory_order_relaxed);
+                const uint64_t dropped = eventsDropped_.fetch_add(1, std::memory_order_relaxed) + 1;
+                if (dropped == 1 || dropped % 1000 == 0) {
+                        Logger::instance().warn(fmt::format("[Python] Event queue full; {} events dropped so far", dropped));
+                }
+                return;
+        }
+
+        eventsEnqueued_.fetch_add(1, std::memory_order_relaxed);
+        raiseMax(eventsHighWater_, pending);
+        eventSignal_.notify_one();
+}
+
+void PythonEngine::eventThreadMain() {
+        std::vector<PythonEvent*> batch;
+        batch.reserve(EVENT_BATCH_LIMIT);
+
+        while (true) {
+                const bool running = eventThreadRunning_.load(std::memory_order_relaxed);
+                if (running && eventsPending_.load(std::memory_order_relaxed) == 0) {
+                        // producers notify without holding the lock, so wake up periodically in case a signal was missed
+                        std::unique_lock<std::mutex> eventLockUnique(eventLock_);
+                        eventSignal_.wait_for(eventLockUnique, std::chrono::milliseconds(50), [this] {
+                                return eventsPending_.load(std::memory_order_relaxed) != 0 || !eventThreadRunning_.load(std::memory_order_relaxed);
+                        });
+                }
+
+                PythonEvent* event;
+                while (batch.size() < EVENT_BATCH_LIMIT && eventQueue_.pop(event)) {
+                        batch.push_back(event);
+                }
+
+                if (batch.empty()) {
+                        if (!running) {
+                                break;
+                        }
+                        continue;
+                }
+
+                eventsPending_.fetch_sub(static_cast<uint32_t>(batch.size()), std::memory_order_relaxed);
+
+                const auto start = std::chrono::steady_clock::now();
+#ifdef WITH_PYTHON
+                PyGILState_STATE gil = PyGILState_Ensure();
+                dispatchEventsLocked(batch);
+                PyGILState_Release(gil);
+#endif
+                const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+                lastDrainMicros_.store(static_cast<uint64_t>(elapsed), std::memory_order_relaxed);
+                raiseMax(maxDrainMicros_, static_cast<uint64_t>(elapsed));
+                raiseMax(eventMaxBatch_, static_cast<uint32_t>(batch.size()));
+                eventBatches_.fetch_add(1, std::memory_order_relaxed);
+                eventsProcessed_.fetch_add(batch.size(), std::memory_order_relaxed);
+
+                for (PythonEvent* processed : batch) {
+                        delete processed;
+                }
+                batch.clear();
+        }
+}
+
+void PythonEngine::dispatchEventsLocked(const std::vector<PythonEvent*>& batch) {
+#ifdef WITH_PYTHON
+        auto buildArgs = [](const PythonEvent& event) -> PyObject* {
+                switch (event.type) {
+                        case PythonEventType::PlayerLogin:
+                        case PythonEventType::PlayerLogout:
+                                return Py_BuildValue("(s)", event.first.c_str());
+                        case PythonEventType::CreatureDeath:
+                                return Py_BuildValue("(ss)", event.first.c_str(), event.second.c_str());
+                        default:
+                                return PyTuple_New(0);
+                }
+        };
+
+        if (batchHandler_) {
+                PyObject* list = PyList_New(static_cast<Py_ssize_t>(batch.size()));
+                if (!list) {
+                        PyErr_Print();
+                        eventsFailed_.fetch_add(batch.size(), std::memory_order_relaxed);
+                        return;
+                }
+
+                for (size_t i = 0; i < batch.size(); ++i) {
+                        const PythonEvent& event = *batch[i];
+                        PyObject* args = buildArgs(event);
+                        PyObject* entry = args ? Py_BuildValue("(sN)", eventHandlerNames[static_cast<size_t>(event.type)], args) : nullptr;
+                        if (!entry) {
+                                PyErr_Print();
+                                Py_DECREF(list);
+                                eventsFailed_.fetch_add(batch.size(), std::memory_order_relaxed);
+                                return;
+                        }
+                        PyList_SetItem(list, static_cast<Py_ssize_t>(i), entry);
+                }
+
+                // the handler gets an iterator, so when it raises we know how far it got:
+                // the event it was on is dropped and the ones it never reached are handed over again
+                Py_ssize_t first = 0;
+                const Py_ssize_t size = PyList_GET_SIZE(list);
+                while (first < size) {
+                        PyObject* rest = PyList_GetSlice(list, first, size);
+                        PyObject* iterator = rest ? PyObject_GetIter(rest) : nullptr;
+                        Py_XDECREF(rest);
+                        PyObject* result = iterator ? PyObject_CallOneArg(toPyObject(batchHandler_), iterator) : nullptr;
+                        if (result) {
+                                Py_DECREF(result);
+                                Py_DECREF(iterator);
+                                break;
+                        }
+
+                        if (PyErr_Occurred()) {
+                                PyErr_Print();
+                        }
+
+                        const Py_ssize_t consumed = iterator ? (size - first) - PyObject_LengthHint(iterator, size - first) : 0;
+                        Py_XDECREF(iterator);
+                        if (consumed <= 0) {
+                                // failed before taking any event; retrying would fail the same way
+                                Logger::instance().error(fmt::format("[Python] Call to '{}' failed", batchHandlerName));
+                                eventsFailed_.fetch_add(static_cast<uint64_t>(size - first), std::memory_order_relaxed);
+                                break;
+                        }
+
+                        Logger::instance().error(fmt::format("[Python] Call to '{}' failed on event {} of {}", batchHandlerName, first + consumed, size));
+                        eventsFailed_.fetch_add(1, std::memory_order_relaxed);
+                        first += consumed;
+                }
+                Py_DECREF(list);
+                return;
+        }
+
+        for (const PythonEvent* event : batch) {
+                PyObject* handler = toPyObject(eventHandlers_[static_cast<size_t>(event->type)]);
+                if (!handler) {
+                        continue;
+                }
+
+                PyObject* args = buildArgs(*event);
+                PyObject* result = args ? PyObject_CallObject(handler, args) : nullptr;
+                Py_XDECREF(args);
+                if (!result) {
+                        if (PyErr_Occurred()) {
+                                PyErr_Print();
+                        }
+                        Logger::instance().error(fmt::format("[Python] Call to '{}' failed", eventHandlerNames[static_cast<size_t>(event->type)]));
+                        eventsFailed_.fetch_add(1, std::memory_order_relaxed);
+                        continue;
+                }
+                Py_DECREF(result);
+        }
+#else
+        (void)batch;
+#endif
 }
 
 void PythonEngine::releasePythonHome() {
@@ -1,11 +1,52 @@
 #pragma once
 
+#include <boost/lockfree/queue.hpp>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
+enum class PythonEventType : uint8_t {
+        ServerStart,
+        ServerStop,
+        PlayerLogin,
+        PlayerLogout,
+        CreatureDeath,
+
+        Count
+};
+
+struct PythonEvent {
+        PythonEventType type;
+        uint32_t guid = 0;
+        std::string first;
+        std::string second;
+};
+
+struct PythonEventStats {
+        uint64_t enqueued = 0;
+        uint64_t dropped = 0;
+        uint64_t processed = 0;
+        uint64_t failed = 0;
+        uint64_t batches = 0;
+        uint32_t pending = 0;
+        uint32_t highWater = 0;
+        uint32_t maxBatch = 0;
+        uint64_t lastDrainMicros = 0;
+        uint64_t maxDrainMicros = 0;
+};
+
 class PythonEngine {
 public:
+        // Events beyond this many pending are dropped instead of stalling the dispatcher.
+        static constexpr size_t EVENT_QUEUE_CAPACITY = 8192;
+        static constexpr size_t EVENT_BATCH_LIMIT = 512;
+
         static PythonEngine& instance();
 
         bool init(const std::string& home, const std::string& modulePath, const std::string& entryScript);
@@ -20,6 +61,8 @@ public:
         void onPlayerLogout(uint32_t guid, const std::string& name);
         void onCreatureDeath(const std::string& killer, const std::string& victim);
 
+        PythonEventStats getEventStats() const;
+
         bool isReady() const { return ready_; }
 
 private:
@@ -32,13 +75,38 @@ private:
         bool ensureInitialized() const;
         bool importBootstrap();
         bool importBootstrapLocked();
+        void cacheHandlersLocked();
+        void releaseHandlersLocked();
         void releasePythonHome();
 
+        void postEvent(PythonEventType type, uint32_t guid, std::string first = {}, std::string second = {});
+        void eventThreadMain();
+        void dispatchEventsLocked(const std::vector<PythonEvent*>& batch);
+
         void* mainThreadState_ = nullptr;
         void* bootstrapModule_ = nullptr;
         void* pythonHome_ = nullptr;
+        void* batchHandler_ = nullptr;
+        std::array<void*, static_cast<size_t>(PythonEventType::Count)> eventHandlers_{};
         std::string modulePath_;
         std::string entryScript_;
         std::string entryModule_;
         bool ready_ = false;
+
+        boost::lockfree::queue<PythonEvent*, boost::lockfree::capacity<EVENT_QUEUE_CAPACITY>> eventQueue_;
+        std::thread eventThread_;
+        std::mutex eventLock_;
+        std::condition_variable eventSignal_;
+        std::atomic<bool> eventThreadRunning_{false};
+
+        std::atomic<uint64_t> eventsEnqueued_{0};
+        std::atomic<uint64_t> eventsDropped_{0};
+        std::atomic<uint64_t> eventsProcessed_{0};
+        std::atomic<uint64_t> eventsFailed_{0};
+        std::atomic<uint64_t> eventBatches_{0};
+        std::atomic<uint32_t> eventsPending_{0};
+        std::atomic<uint32_t> eventsHighWater_{0};
+        std::atomic<uint32_t> eventMaxBatch_{0};
+        std::atomic<uint64_t> lastDrainMicros_{0};
+        std::atomic<uint64_t> maxDrainMicros_{0};
 };
@@ -0,0 +1,225 @@
+#include "otpch.h"
+
+#include "python/WorldSnapshot.h"
+
+#include "game.h"
+#include "monster.h"
+#include "player.h"
+#include "scheduler.h"
+#include "tools.h"
+#include "utils/Logger.h"
+#include "world/WorldPressureManager.hpp"
+
+#include <chrono>
+
+extern Game g_game;
+
+namespace {
+
+constexpr uint32_t MAX_INTERVAL_BACKOFF = 8;
+
+struct ColumnSpec {
+        const char* name;
+        const char* format;
+        uint8_t itemSize;
+        bool monster;
+};
+
+// Order here is the order of the columns in the shared region.
+constexpr std::array<ColumnSpec, 15> columnSpecs = {{
+        {"player_id", "I", 4, false},
+        {"player_x", "H", 2, false},
+        {"player_y", "H", 2, false},
+        {"player_z", "B", 1, false},
+        {"player_level", "I", 4, false},
+        {"player_health", "i", 4, false},
+        {"player_health_max", "i", 4, false},
+        {"monster_id", "I", 4, true},
+        {"monster_x", "H", 2, true},
+        {"monster_y", "H", 2, true},
+        {"monster_z", "B", 1, true},
+        {"monster_rank", "B", 1, true},
+        {"monster_health", "i", 4, true},
+        {"monster_health_max", "i", 4, true},
+        {"monster_pressure", "f", 4, true},
+}};
+
+template <typename T>
+T* column(WorldSnapshotSlot& slot, size_t index) {
+        return reinterpret_cast<T*>(slot.data.data() + slot.columns[index].offset);
+}
+
+} // namespace
+
+WorldSnapshot& WorldSnapshot::instance() {
+        static WorldSnapshot snapshot;
+        return snapshot;
+}
+
+void WorldSnapshot::start(uint32_t intervalMs, uint32_t budgetMicros) {
+        stop();
+
+        baseInterval = intervalMs;
+        currentInterval.store(intervalMs, std::memory_order_relaxed);
+        budget = budgetMicros;
+        if (baseInterval == 0) {
+                return;
+        }
+
+        scheduleNext();
+}
+
+void WorldSnapshot::stop() {
+        if (eventId != 0) {
+                g_scheduler.stopEvent(eventId);
+                eventId = 0;
+        }
+        baseInterval = 0;
+}
+
+void WorldSnapshot::scheduleNext() {
+        eventId = g_scheduler.addEvent(createSchedulerTask(currentInterval.load(std::memory_order_relaxed), [this]() {
+                eventId = 0;
+                if (baseInterval == 0) {
+                        return;
+                }
+                capture();
+                scheduleNext();
+        }));
+}
+
+void WorldSnapshot::capture() {
+        const auto start = std::chrono::steady_clock::now();
+
+        const int32_t current = front.load();
+        WorldSnapshotSlot& slot = slots[current == 0 ? 1 : 0];
+        if (slot.readers.load() != 0) {
+                skippedBusy.fetch_add(1, std::memory_order_relaxed);
+                return;
+        }
+
+        const auto& players = g_game.getPlayers();
+        const auto& monsters = g_game.getMonsters();
+        const uint32_t playerCount = static_cast<uint32_t>(players.size());
+        const uint32_t monsterCount = static_cast<uint32_t>(monsters.size());
+
+        slot.columns.clear();
+        uint32_t offset = 0;
+        for (const ColumnSpec& spec : columnSpecs) {
+                const uint32_t count = spec.monster ? monsterCount : playerCount;
+                slot.columns.push_back({spec.name, spec.format, offset, count, spec.itemSize});
+                // keep every column 8-byte aligned so Python can cast the views in place
+                offset += (count * spec.itemSize + 7) & ~7u;
+        }
+        if (slot.data.size() < offset) {
+                slot.data.resize(offset);
+        }
+
+        auto playerId = column<uint32_t>(slot, 0);
+        auto playerX = column<uint16_t>(slot, 1);
+        auto playerY = column<uint16_t>(slot, 2);
+        auto playerZ = column<uint8_t>(slot, 3);
+        auto playerLevel = column<uint32_t>(slot, 4);
+        auto playerHealth = column<int32_t>(slot, 5);
+        auto playerHealthMax = column<int32_t>(slot, 6);
+
+        size_t i = 0;
+        for (const auto& it : players) {
+                const Player* player = it.second;
+                const Position& pos = player->getPosition();
+                playerId[i] = player->getGUID();
+                playerX[i] = pos.x;
+                playerY[i] = pos.y;
+                playerZ[i] = pos.z;
+                playerLevel[i] = player->getLevel();
+                playerHealth[i] = player->getHealth();
+                playerHealthMax[i] = player->getMaxHealth();
+                ++i;
+        }
+
+        auto monsterId = column<uint32_t>(slot, 7);
+        auto monsterX = column<uint16_t>(slot, 8);
+        auto monsterY = column<uint16_t>(slot, 9);
+        auto monsterZ = column<uint8_t>(slot, 10);
+        auto monsterRank = column<uint8_t>(slot, 11);
+        auto monsterHealth = column<int32_t>(slot, 12);
+        auto monsterHealthMax = column<int32_t>(slot, 13);
+        auto monsterPressure = column<float>(slot, 14);
+
+        const WorldPressureManager& pressure = WorldPressureManager::get();
+        i = 0;
+        for (const auto& it : monsters) {
+                const Monster* monster = it.second;
+                const Position& pos = monster->getPosition();
+                monsterId[i] = monster->getID();
+                monsterX[i] = pos.x;
+                monsterY[i] = pos.y;
+                monsterZ[i] = pos.z;
+                monsterRank[i] = static_cast<uint8_t>(monster->getRankTier());
+                monsterHealth[i] = monster->getHealth();
+                monsterHealthMax[i] = monster->getMaxHealth();
+                monsterPressure[i] = static_cast<float>(pressure.getPressureBias(pos, 0));
+                ++i;
+        }
+
+        slot.sequence = nextSequence++;
+        slot.capturedAt = OTSYS_TIME();
+        slot.players = playerCount;
+        slot.monsters = monsterCount;
+        front.store(current == 0 ? 1 : 0);
+
+        const uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        captures.fetch_add(1, std::memory_order_relaxed);
+        lastCaptureMicros.store(elapsed, std::memory_order_relaxed);
+        totalCaptureMicros.fetch_add(elapsed, std::memory_order_relaxed);
+        raiseMax(maxCaptureMicros, elapsed);
+        bytes.store(offset, std::memory_order_relaxed);
+
+        if (budget == 0 || baseInterval == 0) {
+                return;
+        }
+
+        // Keep the amortized dispatcher cost bounded: back off while captures exceed the budget, recover once they fit again.
+        const uint32_t interval = currentInterval.load(std::memory_order_relaxed);
+        if (elapsed > budget && interval < baseInterval * MAX_INTERVAL_BACKOFF) {
+                currentInterval.store(std::min(interval * 2, baseInterval * MAX_INTERVAL_BACKOFF), std::memory_order_relaxed);
+                Logger::instance().warn(fmt::format("[Python] World snapshot took {}us (budget {}us); interval raised to {}ms", elapsed, budget, currentInterval.load(std::memory_order_relaxed)));
+        } else if (elapsed <= budget / 2 && interval > baseInterval) {
+                currentInterval.store(std::max(interval / 2, baseInterval), std::memory_order_relaxed);
+        }
+}
+
+const WorldSnapshotSlot* WorldSnapshot::acquire() {
+        while (true) {
+                const int32_t index = front.load();
+                if (index < 0) {
+                        return nullptr;
+                }
+
+                WorldSnapshotSlot& slot = slots[index];
+                slot.readers.fetch_add(1);
+                // the writer only touches the slot that is not in front, so re-check after pinning
+                if (front.load() == index) {
+                        return &slot;
+                }
+                slot.readers.fetch_sub(1);
+        }
+}
+
+void WorldSnapshot::release(const WorldSnapshotSlot* slot) {
+        if (slot) {
+                const_cast<WorldSnapshotSlot*>(slot)->readers.fetch_sub(1);
+        }
+}
+
+WorldSnapshotStats WorldSnapshot::getStats() const {
+        WorldSnapshotStats stats;
+        stats.captures = captures.load(std::memory_order_relaxed);
+        stats.skippedBusy = skippedBusy.load(std::memory_order_relaxed);
+        stats.lastCaptureMicros = lastCaptureMicros.load(std::memory_order_relaxed);
+        stats.maxCaptureMicros = maxCaptureMicros.load(std::memory_order_relaxed);
+        stats.totalCaptureMicros = totalCaptureMicros.load(std::memory_order_relaxed);
+        stats.interval = currentInterval.load(std::memory_order_relaxed);
+        stats.bytes = bytes.load(std::memory_order_relaxed);
+        return stats;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Periodic, columnar copy of live world state for embedded Python analytics.
+// The dispatcher fills the back slot and flips it to the front; Python pins the
+// front slot and reads the columns through the buffer protocol, so no per-object
+// conversion ever happens. A pinned slot is never overwritten: if Python still
+// holds the back slot when the next capture is due, that capture is skipped.
+struct WorldSnapshotColumn {
+        const char* name;
+        const char* format; // struct/memoryview format character
+        uint32_t offset;
+        uint32_t count;
+        uint8_t itemSize;
+};
+
+struct WorldSnapshotSlot {
+        std::vector<uint8_t> data;
+        std::vector<WorldSnapshotColumn> columns;
+        uint64_t sequence = 0;
+        int64_t capturedAt = 0;
+        uint32_t players = 0;
+        uint32_t monsters = 0;
+        std::atomic<uint32_t> readers{0};
+};
+
+struct WorldSnapshotStats {
+        uint64_t captures = 0;
+        uint64_t skippedBusy = 0;
+        uint64_t lastCaptureMicros = 0;
+        uint64_t maxCaptureMicros = 0;
+        uint64_t totalCaptureMicros = 0;
+        uint32_t interval = 0;
+        uint32_t bytes = 0;
+};
+
+class WorldSnapshot {
+public:
+        static WorldSnapshot& instance();
+
+        // intervalMs == 0 disables periodic capture; budgetMicros bounds dispatcher time by backing off the interval.
+        void start(uint32_t intervalMs, uint32_t budgetMicros);
+        void stop();
+
+        // Dispatcher thread only.
+        void capture();
+
+        // Any thread; returns nullptr until the first capture has been published.
+        const WorldSnapshotSlot* acquire();
+        void release(const WorldSnapshotSlot* slot);
+
+        WorldSnapshotStats getStats() const;
+
+private:
+        WorldSnapshot() = default;
+
+        WorldSnapshot(const WorldSnapshot&) = delete;
+        WorldSnapshot& operator=(const WorldSnapshot&) = delete;
+
+        void scheduleNext();
+
+        std::array<WorldSnapshotSlot, 2> slots;
+        std::atomic<int32_t> front{-1};
+        uint64_t nextSequence = 1;
+
+        uint32_t baseInterval = 0;
+        std::atomic<uint32_t> currentInterval{0};
+        uint32_t budget = 0;
+        uint32_t eventId = 0;
+
+        std::atomic<uint64_t> captures{0};
+        std::atomic<uint64_t> skippedBusy{0};
+        std::atomic<uint64_t> lastCaptureMicros{0};
+        std::atomic<uint64_t> maxCaptureMicros{0};
+        std::atomic<uint64_t> totalCaptureMicros{0};
+        std::atomic<uint32_t> bytes{0};
+};
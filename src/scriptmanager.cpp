@@ -10,6 +10,7 @@
 #include "events.h"
 #include "globalevent.h"
 #include "movement.h"
+#include "npc.h"
 #include "script.h"
 #include "spells.h"
 #include "talkaction.h"
@@ -25,6 +26,7 @@ TalkActions* g_talkActions = nullptr;
 MoveEvents* g_moveEvents = nullptr;
 Weapons* g_weapons = nullptr;
 Scripts* g_scripts = nullptr;
+Npcs* g_npcs = nullptr;
 
 extern LuaEnvironment g_luaEnvironment;
 
@@ -37,6 +39,7 @@ ScriptingManager::~ScriptingManager() {
 	delete g_chat;
 	delete g_creatureEvents;
 	delete g_globalEvents;
+	delete g_npcs;
 	delete g_scripts;
 }
 
@@ -98,6 +101,8 @@ bool ScriptingManager::loadScriptSystems() {
                 return false;
         }
 
+	g_npcs = new Npcs();
+
         if (!events::load()) {
                 Logger::instance().fatal("Unable to load events!");
                 return false;
@@ -38,6 +38,7 @@ extern Game g_game;
 extern CreatureEvents* g_creatureEvents;
 extern GlobalEvents* g_globalEvents;
 extern Chat* g_chat;
+extern Npcs* g_npcs;
 extern LuaEnvironment g_luaEnvironment;
 
 namespace {
@@ -66,7 +67,7 @@ namespace {
 		g_moveEvents->reload();
 		std::cout << "Reloaded movements." << std::endl;
 
-		Npcs::reload();
+		g_npcs->reload();
 		std::cout << "Reloaded npcs." << std::endl;
 
 		g_monsters.reload();
@@ -246,6 +246,10 @@ Spawn::~Spawn() {
 }
 
 bool Spawn::findPlayer(const Position& pos) {
+	if (!g_game.map.players.hasPlayerNear(pos, Map::maxViewportX, Map::maxViewportY)) {
+		return false;
+	}
+
 	SpectatorVec spectators;
 	g_game.map.getSpectators(spectators, pos, false, true);
 	for (Creature* spectator : spectators) {
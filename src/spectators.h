@@ -37,6 +37,11 @@ class SpectatorVec {
 			vec.pop_back();
 		}
 
+		template <typename Predicate>
+		void eraseIf(Predicate predicate) {
+			vec.erase(std::remove_if(vec.begin(), vec.end(), predicate), vec.end());
+		}
+
 		size_t size() const { return vec.size(); }
 		bool empty() const { return vec.empty(); }
 		Iterator begin() { return vec.begin(); }
@@ -88,6 +88,11 @@ void Spells::clearMaps(bool fromLua) {
 		}
 	}
 
+	instantWords.clear();
+	for (auto& it : instants) {
+		instantWords.insert(it.first, &it.second);
+	}
+
 	for (auto rune = runes.begin(); rune != runes.end();) {
 		if (fromLua == rune->second.fromLua) {
 			rune = runes.erase(rune);
@@ -122,6 +127,8 @@ bool Spells::registerEvent(Event_ptr event, const pugi::xml_node&) {
 		auto result = instants.emplace(instant->getWords(), std::move(*instant));
 		if (!result.second) {
 			std::cout << "[Warning - Spells::registerEvent] Duplicate registered instant spell with words: " << instant->getWords() << std::endl;
+		} else {
+			instantWords.insert(result.first->first, &result.first->second);
 		}
 		return result.second;
 	}
@@ -145,6 +152,8 @@ bool Spells::registerInstantLuaEvent(InstantSpell* event) {
 		auto result = instants.emplace(instant->getWords(), std::move(*instant));
 		if (!result.second) {
 			std::cout << "[Warning - Spells::registerInstantLuaEvent] Duplicate registered instant spell with words: " << words << std::endl;
+		} else {
+			instantWords.insert(result.first->first, &result.first->second);
 		}
 		return result.second;
 	}
@@ -197,21 +206,7 @@ RuneSpell* Spells::getRuneSpellByName(const std::string& name) {
 }
 
 InstantSpell* Spells::getInstantSpell(const std::string& words) {
-	InstantSpell* result = nullptr;
-
-	for (auto& it : instants) {
-		const std::string& instantSpellWords = it.second.getWords();
-		size_t spellLen = instantSpellWords.length();
-		if (caseInsensitiveStartsWith(words, instantSpellWords)) {
-			if (!result || spellLen > result->getWords().size()) {
-				result = &it.second;
-				if (words.length() == spellLen) {
-					break;
-				}
-			}
-		}
-	}
-
+	InstantSpell* result = instantWords.findLongest(words);
 	if (result) {
 		const std::string& resultWords = result->getWords();
 		if (words.length() > resultWords.length()) {
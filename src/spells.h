@@ -8,6 +8,7 @@
 #include "baseevents.h"
 #include "creature.h"
 #include "luascript.h"
+#include "prefixtrie.h"
 #include "talkaction.h"
 #include "vocation.h"
 
@@ -59,6 +60,7 @@ class Spells final : public BaseEvents {
 
 		std::map<uint16_t, RuneSpell> runes;
 		std::map<std::string, InstantSpell> instants;
+		PrefixTrie<InstantSpell> instantWords;
 
 		friend class CombatSpell;
 		LuaScriptInterface scriptInterface { "Spell Interface" };
@@ -0,0 +1,144 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_STORAGEMAP_H
+#define FS_STORAGEMAP_H
+
+// Storage values kept in a flat vector sorted by key. Next to the live value
+// every entry remembers what the database holds, so a save only writes keys
+// whose value changed and deletes keys that were removed since the last save.
+class StorageMap {
+	public:
+		std::optional<int32_t> get(uint32_t key) const {
+			auto it = find(key);
+			if (it == entries.end() || it->key != key || !it->live) {
+				return std::nullopt;
+			}
+			return it->value;
+		}
+
+		void set(uint32_t key, int32_t value) {
+			Entry& entry = getEntry(key);
+			const bool wasDirty = entry.isDirty();
+			entry.value = value;
+			entry.live = true;
+			updateDirty(entry, wasDirty);
+		}
+
+		void erase(uint32_t key) {
+			auto it = find(key);
+			if (it == entries.end() || it->key != key || !it->live) {
+				return;
+			}
+
+			const bool wasDirty = it->isDirty();
+			it->live = false;
+			if (!it->saved) {
+				// never reached the database, nothing to delete
+				dirty -= wasDirty;
+				entries.erase(it);
+				return;
+			}
+			updateDirty(*it, wasDirty);
+		}
+
+		// Records the value the database holds for key, e.g. while loading.
+		void setSaved(uint32_t key, int32_t value) {
+			Entry& entry = getEntry(key);
+			const bool wasDirty = entry.isDirty();
+			entry.savedValue = value;
+			entry.saved = true;
+			updateDirty(entry, wasDirty);
+		}
+
+		// Accepts the live values as saved; call once the save has been committed.
+		void markSaved() {
+			if (dirty == 0) {
+				return;
+			}
+
+			std::erase_if(entries, [](const Entry& entry) { return !entry.live; });
+			for (Entry& entry : entries) {
+				entry.savedValue = entry.value;
+				entry.saved = true;
+			}
+			dirty = 0;
+		}
+
+		bool isDirty() const {
+			return dirty != 0;
+		}
+
+		size_t size() const {
+			return entries.size();
+		}
+
+		// visit(key, value) for every live entry, in key order
+		template <typename Visitor>
+		void forEach(Visitor&& visit) const {
+			for (const Entry& entry : entries) {
+				if (entry.live) {
+					visit(entry.key, entry.value);
+				}
+			}
+		}
+
+		// visit(key, value) for every entry the database does not hold yet
+		template <typename Visitor>
+		void forEachChanged(Visitor&& visit) const {
+			for (const Entry& entry : entries) {
+				if (entry.live && entry.isDirty()) {
+					visit(entry.key, entry.value);
+				}
+			}
+		}
+
+		// visit(key) for every entry that has to be deleted from the database
+		template <typename Visitor>
+		void forEachRemoved(Visitor&& visit) const {
+			for (const Entry& entry : entries) {
+				if (!entry.live && entry.saved) {
+					visit(entry.key);
+				}
+			}
+		}
+
+	private:
+		struct Entry {
+			uint32_t key;
+			int32_t value = 0;
+			int32_t savedValue = 0;
+			bool live = false;
+			bool saved = false;
+
+			bool isDirty() const {
+				return live != saved || (live && value != savedValue);
+			}
+		};
+
+		std::vector<Entry>::iterator find(uint32_t key) {
+			return std::lower_bound(entries.begin(), entries.end(), key, [](const Entry& entry, uint32_t needle) { return entry.key < needle; });
+		}
+
+		std::vector<Entry>::const_iterator find(uint32_t key) const {
+			return std::lower_bound(entries.begin(), entries.end(), key, [](const Entry& entry, uint32_t needle) { return entry.key < needle; });
+		}
+
+		Entry& getEntry(uint32_t key) {
+			auto it = find(key);
+			if (it == entries.end() || it->key != key) {
+				it = entries.insert(it, Entry{key});
+			}
+			return *it;
+		}
+
+		void updateDirty(const Entry& entry, bool wasDirty) {
+			dirty += entry.isDirty();
+			dirty -= wasDirty;
+		}
+
+		std::vector<Entry> entries;
+		uint32_t dirty = 0;
+};
+
+#endif // FS_STORAGEMAP_H
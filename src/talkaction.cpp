@@ -9,6 +9,7 @@
 
 #ifdef WITH_PYTHON
 #include "python/PythonEngine.h"
+#include "python/WorldSnapshot.h"
 #endif
 
 TalkActions::TalkActions()
@@ -29,6 +30,11 @@ void TalkActions::clear(bool fromLua) {
 		}
 	}
 
+	talkActionWords.clear();
+	for (const auto& it : talkActions) {
+		talkActionWords.insert(it.first, &it.second);
+	}
+
 	reInitState(fromLua);
 }
 
@@ -49,9 +55,9 @@ bool TalkActions::registerEvent(Event_ptr event, const pugi::xml_node&) {
 
 	for (size_t i = 0; i < words.size(); i++) {
 		if (i == words.size() - 1) {
-			talkActions.emplace(words[i], std::move(*talkAction));
+			addTalkAction(words[i], std::move(*talkAction));
 		} else {
-			talkActions.emplace(words[i], *talkAction);
+			addTalkAction(words[i], TalkAction(*talkAction));
 		}
 	}
 
@@ -64,15 +70,22 @@ bool TalkActions::registerLuaEvent(TalkAction* event) {
 
 	for (size_t i = 0; i < words.size(); i++) {
 		if (i == words.size() - 1) {
-			talkActions.emplace(words[i], std::move(*talkAction));
+			addTalkAction(words[i], std::move(*talkAction));
 		} else {
-			talkActions.emplace(words[i], *talkAction);
+			addTalkAction(words[i], TalkAction(*talkAction));
 		}
 	}
 
 	return true;
 }
 
+void TalkActions::addTalkAction(const std::string& words, TalkAction&& talkAction) {
+	auto result = talkActions.emplace(words, std::move(talkAction));
+	if (result.second) {
+		talkActionWords.insert(result.first->first, &result.first->second);
+	}
+}
+
 TalkActionResult_t TalkActions::playerSaySpell(Player* player, SpeakClasses type, const std::string& words) const {
 #ifdef WITH_PYTHON
         if (caseInsensitiveStartsWith(words, "!py")) {
@@ -101,7 +114,7 @@ TalkActionResult_t TalkActions::playerSaySpell(Player* player, SpeakClasses type
                         }
 
                         if (command.empty()) {
-                                player->sendTextMessage(MESSAGE_INFO_DESCR, "Usage: !py reload | !py call <function> [args...]");
+                                player->sendTextMessage(MESSAGE_INFO_DESCR, "Usage: !py reload | !py stats | !py call <function> [args...]");
                                 return TALKACTION_BREAK;
                         }
 
@@ -115,6 +128,21 @@ TalkActionResult_t TalkActions::playerSaySpell(Player* player, SpeakClasses type
                                 return TALKACTION_BREAK;
                         }
 
+                        if (boost::iequals(subcommand, "stats")) {
+                                const PythonEventStats stats = PythonEngine::instance().getEventStats();
+                                player->sendTextMessage(MESSAGE_INFO_DESCR, fmt::format(
+                                        "Python events: {} queued, {} processed, {} failed, {} dropped, {} pending (peak {}), {} batches (max {}), drain {}us (max {}us).",
+                                        stats.enqueued, stats.processed, stats.failed, stats.dropped, stats.pending, stats.highWater,
+                                        stats.batches, stats.maxBatch, stats.lastDrainMicros, stats.maxDrainMicros));
+
+                                const WorldSnapshotStats snapshot = WorldSnapshot::instance().getStats();
+                                player->sendTextMessage(MESSAGE_INFO_DESCR, fmt::format(
+                                        "World snapshot: {} captures, {} skipped (pinned), last {}us, max {}us, every {}ms, {} bytes.",
+                                        snapshot.captures, snapshot.skippedBusy, snapshot.lastCaptureMicros, snapshot.maxCaptureMicros,
+                                        snapshot.interval, snapshot.bytes));
+                                return TALKACTION_BREAK;
+                        }
+
                         if (boost::iequals(subcommand, "call")) {
                                 std::string functionName;
                                 stream >> functionName;
@@ -134,35 +162,32 @@ TalkActionResult_t TalkActions::playerSaySpell(Player* player, SpeakClasses type
                                 return TALKACTION_BREAK;
                         }
 
-                        player->sendTextMessage(MESSAGE_INFO_DESCR, "Unknown subcommand. Usage: !py reload | !py call <function> [args...]");
+                        player->sendTextMessage(MESSAGE_INFO_DESCR, "Unknown subcommand. Usage: !py reload | !py stats | !py call <function> [args...]");
                         return TALKACTION_BREAK;
                 }
         }
 #endif
 
+        // Only talkactions whose words prefix the text can match; shorter words are tried first.
+        TalkActionResult_t result = TALKACTION_CONTINUE;
         size_t wordsLength = words.length();
-        for (auto it = talkActions.begin(); it != talkActions.end();) {
-                const std::string& talkactionWords = it->first;
-                if (!caseInsensitiveStartsWith(words, talkactionWords)) {
-                        ++it;
-			continue;
-		}
+	talkActionWords.findPrefix(words, [&](const auto& candidate) {
+		const std::string talkactionWords{candidate.first};
+		const TalkAction& talkAction = *candidate.second;
 
 		std::string param;
 		if (wordsLength != talkactionWords.size()) {
 			param = words.substr(talkactionWords.size());
 			if (param.front() != ' ') {
-				++it;
-				continue;
+				return false;
 			}
 			boost::algorithm::trim_left(param);
 
-			std::string separator = it->second.getSeparator();
+			std::string separator = talkAction.getSeparator();
 			if (separator != " ") {
 				if (!param.empty()) {
 					if (param != separator) {
-						++it;
-						continue;
+						return false;
 					} else {
 						param.erase(param.begin());
 					}
@@ -170,23 +195,22 @@ TalkActionResult_t TalkActions::playerSaySpell(Player* player, SpeakClasses type
 			}
 		}
 
-		if (it->second.fromLua) {
-			if (it->second.getNeedAccess() && !player->getGroup()->access) {
-				return TALKACTION_CONTINUE;
+		if (talkAction.fromLua) {
+			if (talkAction.getNeedAccess() && !player->getGroup()->access) {
+				return true;
 			}
 
-			if (player->getAccountType() < it->second.getRequiredAccountType()) {
-				return TALKACTION_CONTINUE;
+			if (player->getAccountType() < talkAction.getRequiredAccountType()) {
+				return true;
 			}
 		}
 
-		if (it->second.executeSay(player, talkactionWords, param, type)) {
-			return TALKACTION_CONTINUE;
-		} else {
-			return TALKACTION_BREAK;
+		if (!talkAction.executeSay(player, talkactionWords, param, type)) {
+			result = TALKACTION_BREAK;
 		}
-	}
-	return TALKACTION_CONTINUE;
+		return true;
+	});
+	return result;
 }
 
 bool TalkAction::configureEvent(const pugi::xml_node& node) {
@@ -7,6 +7,7 @@
 #include "baseevents.h"
 #include "const.h"
 #include "luascript.h"
+#include "prefixtrie.h"
 
 class TalkAction;
 
@@ -94,7 +95,10 @@ class TalkActions final : public BaseEvents {
 		Event_ptr getEvent(const std::string& nodeName) override;
 		bool registerEvent(Event_ptr event, const pugi::xml_node& node) override;
 
+		void addTalkAction(const std::string& words, TalkAction&& talkAction);
+
 		std::map<std::string, TalkAction> talkActions;
+		PrefixTrie<const TalkAction> talkActionWords;
 
 		LuaScriptInterface scriptInterface;
 };
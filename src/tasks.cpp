@@ -5,6 +5,7 @@
 
 #include "tasks.h"
 
+#include "dbstats.h"
 #include "enums.h"
 #include "game/game.h"
 
@@ -19,6 +20,8 @@ Task* createTask(uint32_t expiration, TaskFunc&& f) {
 }
 
 void Dispatcher::threadMain() {
+	DBQueryStats::setThreadRole(DBThreadRole::DISPATCHER);
+
 	std::vector<Task*> tmpTaskList;
 	// NOTE: second argument defer_lock is to prevent from immediate locking
 	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
@@ -1112,6 +1112,9 @@ bool Tile::hasCreature(Creature* creature) const
 
 void Tile::removeCreature(Creature* creature) {
 	g_game.map.getQTNode(tilePos.x, tilePos.y)->removeCreature(creature);
+	if (creature->getPlayer()) {
+		g_game.map.players.removePlayer(tilePos);
+	}
 	removeThing(creature, 0);
 }
 
@@ -1491,6 +1494,8 @@ void Tile::setTileFlags(const Item* item) {
 	if (item->hasProperty(CONST_PROP_SUPPORTHANGABLE)) {
 		setFlag(TILESTATE_SUPPORTS_HANGABLE);
 	}
+
+	g_game.map.updateTileBlocking(this);
 }
 
 void Tile::resetTileFlags(const Item* item) {
@@ -1551,6 +1556,8 @@ void Tile::resetTileFlags(const Item* item) {
 	if (item->hasProperty(CONST_PROP_SUPPORTHANGABLE)) {
 		resetFlag(TILESTATE_SUPPORTS_HANGABLE);
 	}
+
+	g_game.map.updateTileBlocking(this);
 }
 
 bool Tile::isMoveableBlocking() const {
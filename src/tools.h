@@ -75,4 +75,12 @@ SpellGroup_t stringToSpellGroup(const std::string& value);
 
 const std::vector<Direction>& getShuffleDirections();
 
+// Raises a maximum shared between threads; never lowers it.
+template <typename T>
+void raiseMax(std::atomic<T>& target, std::type_identity_t<T> value) {
+	T current = target.load(std::memory_order_relaxed);
+	while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+	}
+}
+
 #endif // FS_TOOLS_H
\ No newline at end of file